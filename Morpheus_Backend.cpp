@@ -0,0 +1,875 @@
+/**
+ * @file
+ * \brief Defines the compute backends that Matrix and Vector dispatch to
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Backend.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef MORPHEUS_HAVE_CBLAS
+#include <cblas.h>
+#endif
+
+namespace Morpheus {
+
+/*
+ * Reference backend: the simplest loops that compute the right answer
+ */
+
+static void refGemm(const int m, const int n, const int k, const double alpha,
+                    const double* A, const std::size_t lda,
+                    const double* B, const std::size_t ldb, const double beta,
+                    double* C, const std::size_t ldc)
+{
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      double sum = 0;
+      for(int p=0; p<k; p++)
+        sum = sum + A[r*lda + p] * B[p*ldb + c];
+      C[r*ldc + c] = (beta == 0) ? alpha*sum : alpha*sum + beta*C[r*ldc + c];
+    }
+  }
+}
+
+
+static void refGemv(const bool transpose, const int m, const int n,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double* x, const double beta, double* y)
+{
+  int nout = transpose ? n : m;
+  int nin = transpose ? m : n;
+  for(int i=0; i<nout; i++)
+  {
+    double sum = 0;
+    for(int j=0; j<nin; j++)
+      sum = sum + (transpose ? A[j*lda + i] : A[i*lda + j]) * x[j];
+    y[i] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[i];
+  }
+}
+
+
+static double refDot(const int n, const double* x, const double* y)
+{
+  double sum = 0;
+  for(int i=0; i<n; i++)
+    sum = sum + x[i]*y[i];
+  return sum;
+}
+
+
+static void refAxpy(const int n, const double alpha, const double* x, double* y)
+{
+  for(int i=0; i<n; i++)
+    y[i] = y[i] + alpha*x[i];
+}
+
+
+static double refNorm1(const int n, const double* x)
+{
+  double sum = 0;
+  for(int i=0; i<n; i++)
+    sum = sum + std::abs(x[i]);
+  return sum;
+}
+
+
+static double refNorm2(const int n, const double* x)
+{
+  double sum = 0;
+  for(int i=0; i<n; i++)
+    sum = sum + x[i]*x[i];
+  return std::sqrt(sum);
+}
+
+
+static double refNormInf(const int n, const double* x)
+{
+  double maxVal = 0;
+  for(int i=0; i<n; i++)
+  {
+    if(std::abs(x[i]) > maxVal)
+      maxVal = std::abs(x[i]);
+  }
+  return maxVal;
+}
+
+
+static void refGer(const int m, const int n, const double alpha,
+                   const double* x, const double* y, double* A,
+                   const std::size_t lda)
+{
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<n; c++)
+      A[r*lda + c] = A[r*lda + c] + alpha*x[r]*y[c];
+  }
+}
+
+
+static void refSyrk(const bool transpose, const int n, const int k,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double beta, double* C, const std::size_t ldc)
+{
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<=r; c++)
+    {
+      double sum = 0;
+      for(int p=0; p<k; p++)
+        sum = sum + (transpose ? A[p*lda + r]*A[p*lda + c]
+                               : A[r*lda + p]*A[c*lda + p]);
+      C[r*ldc + c] = (beta == 0) ? alpha*sum : alpha*sum + beta*C[r*ldc + c];
+    }
+  }
+
+  for(int r=0; r<n; r++)
+  {
+    for(int c=r+1; c<n; c++)
+      C[r*ldc + c] = C[c*ldc + r];
+  }
+}
+
+
+/*
+ * Optimized backend: cache blocking, SIMD and OpenMP threads.
+ * Every loop over rows or entries uses a static schedule, so each
+ * thread works on the pages it first touched (see Morpheus_Memory.h).
+ */
+
+// Block sizes for gemm: an MB x KB panel of A and a KB x NB panel
+// of B are reused from cache while they are swept
+static const int MB = 64;
+static const int KB = 128;
+static const int NB = 256;
+
+static void optGemm(const int m, const int n, const int k, const double alpha,
+                    const double* A, const std::size_t lda,
+                    const double* B, const std::size_t ldb, const double beta,
+                    double* C, const std::size_t ldc)
+{
+  const int nrowBlocks = (m + MB - 1) / MB;
+
+  #pragma omp parallel for schedule(static)
+  for(int ib=0; ib<nrowBlocks; ib++)
+  {
+    const int rbegin = ib*MB;
+    const int rend = (rbegin + MB < m) ? rbegin + MB : m;
+
+    for(int r=rbegin; r<rend; r++)
+    {
+      double* Crow = C + r*ldc;
+      #pragma omp simd
+      for(int c=0; c<n; c++)
+        Crow[c] = (beta == 0) ? 0 : beta*Crow[c];
+    }
+
+    for(int kb=0; kb<k; kb+=KB)
+    {
+      const int pend = (kb + KB < k) ? kb + KB : k;
+      for(int jb=0; jb<n; jb+=NB)
+      {
+        const int cend = (jb + NB < n) ? jb + NB : n;
+        for(int r=rbegin; r<rend; r++)
+        {
+          double* Crow = C + r*ldc;
+          for(int p=kb; p<pend; p++)
+          {
+            const double a = alpha * A[r*lda + p];
+            const double* Brow = B + p*ldb;
+            #pragma omp simd
+            for(int c=jb; c<cend; c++)
+              Crow[c] = Crow[c] + a*Brow[c];
+          }
+        }
+      }
+    }
+  }
+}
+
+
+static void optGemv(const bool transpose, const int m, const int n,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double* x, const double beta, double* y)
+{
+  if(!transpose)
+  {
+    #pragma omp parallel for schedule(static)
+    for(int r=0; r<m; r++)
+    {
+      const double* row = A + r*lda;
+      double sum = 0;
+      #pragma omp simd reduction(+:sum)
+      for(int c=0; c<n; c++)
+        sum = sum + row[c]*x[c];
+      y[r] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[r];
+    }
+    return;
+  }
+
+  // Each thread owns a contiguous range of y and sweeps the rows of
+  // A over that range, so no reduction is needed
+  #pragma omp parallel
+  {
+    int nthreads = 1, tid = 0;
+#ifdef _OPENMP
+    nthreads = omp_get_num_threads();
+    tid = omp_get_thread_num();
+#endif
+    const int cbegin = (int)((long)n*tid/nthreads);
+    const int cend = (int)((long)n*(tid+1)/nthreads);
+
+    for(int c=cbegin; c<cend; c++)
+      y[c] = (beta == 0) ? 0 : beta*y[c];
+
+    for(int r=0; r<m; r++)
+    {
+      const double* row = A + r*lda;
+      const double ax = alpha*x[r];
+      #pragma omp simd
+      for(int c=cbegin; c<cend; c++)
+        y[c] = y[c] + ax*row[c];
+    }
+  }
+}
+
+
+static double optDot(const int n, const double* x, const double* y)
+{
+  double sum = 0;
+  #pragma omp parallel for simd schedule(static) reduction(+:sum)
+  for(int i=0; i<n; i++)
+    sum = sum + x[i]*y[i];
+  return sum;
+}
+
+
+static void optAxpy(const int n, const double alpha, const double* x, double* y)
+{
+  #pragma omp parallel for simd schedule(static)
+  for(int i=0; i<n; i++)
+    y[i] = y[i] + alpha*x[i];
+}
+
+
+static double optNorm1(const int n, const double* x)
+{
+  double sum = 0;
+  #pragma omp parallel for simd schedule(static) reduction(+:sum)
+  for(int i=0; i<n; i++)
+    sum = sum + std::abs(x[i]);
+  return sum;
+}
+
+
+static double optNorm2(const int n, const double* x)
+{
+  double sum = 0;
+  #pragma omp parallel for simd schedule(static) reduction(+:sum)
+  for(int i=0; i<n; i++)
+    sum = sum + x[i]*x[i];
+  return std::sqrt(sum);
+}
+
+
+static double optNormInf(const int n, const double* x)
+{
+  double maxVal = 0;
+  #pragma omp parallel for simd schedule(static) reduction(max:maxVal)
+  for(int i=0; i<n; i++)
+    maxVal = (std::abs(x[i]) > maxVal) ? std::abs(x[i]) : maxVal;
+  return maxVal;
+}
+
+
+static void optGer(const int m, const int n, const double alpha,
+                   const double* x, const double* y, double* A,
+                   const std::size_t lda)
+{
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<m; r++)
+  {
+    double* row = A + r*lda;
+    const double ax = alpha*x[r];
+    #pragma omp simd
+    for(int c=0; c<n; c++)
+      row[c] = row[c] + ax*y[c];
+  }
+}
+
+
+// Copies the lower triangle of the n x n matrix C onto the upper one
+static void mirrorLower(const int n, double* C, const std::size_t ldc)
+{
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<n; r++)
+  {
+    for(int c=r+1; c<n; c++)
+      C[r*ldc + c] = C[c*ldc + r];
+  }
+}
+
+
+static void optSyrk(const bool transpose, const int n, const int k,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double beta, double* C, const std::size_t ldc)
+{
+  const int nrowBlocks = (n + MB - 1) / MB;
+
+  #pragma omp parallel for schedule(static)
+  for(int ib=0; ib<nrowBlocks; ib++)
+  {
+    const int rbegin = ib*MB;
+    const int rend = (rbegin + MB < n) ? rbegin + MB : n;
+
+    if(!transpose)
+    {
+      // Dot products of rows of A, one MB-wide panel of columns of C
+      // at a time so that panel of rows of A stays in cache
+      for(int cb=0; cb<rend; cb+=MB)
+      {
+        for(int r=rbegin; r<rend; r++)
+        {
+          const double* Ar = A + r*lda;
+          double* Crow = C + r*ldc;
+          const int cend = (cb + MB <= r) ? cb + MB : r + 1;
+          for(int c=cb; c<cend; c++)
+          {
+            const double* Ac = A + c*lda;
+            double sum = 0;
+            #pragma omp simd reduction(+:sum)
+            for(int p=0; p<k; p++)
+              sum = sum + Ar[p]*Ac[p];
+            Crow[c] = (beta == 0) ? alpha*sum : alpha*sum + beta*Crow[c];
+          }
+        }
+      }
+      continue;
+    }
+
+    // Rank-1 updates with the rows of A, KB of them at a time
+    for(int r=rbegin; r<rend; r++)
+    {
+      double* Crow = C + r*ldc;
+      #pragma omp simd
+      for(int c=0; c<=r; c++)
+        Crow[c] = (beta == 0) ? 0 : beta*Crow[c];
+    }
+
+    for(int kb=0; kb<k; kb+=KB)
+    {
+      const int pend = (kb + KB < k) ? kb + KB : k;
+      for(int r=rbegin; r<rend; r++)
+      {
+        double* Crow = C + r*ldc;
+        for(int p=kb; p<pend; p++)
+        {
+          const double* Ap = A + p*lda;
+          const double a = alpha * Ap[r];
+          #pragma omp simd
+          for(int c=0; c<=r; c++)
+            Crow[c] = Crow[c] + a*Ap[c];
+        }
+      }
+    }
+  }
+
+  mirrorLower(n, C, ldc);
+}
+
+
+/*
+ * BLAS backend: whatever CBLAS is installed on the system
+ */
+
+#ifdef MORPHEUS_HAVE_CBLAS
+static void blasGemm(const int m, const int n, const int k, const double alpha,
+                     const double* A, const std::size_t lda,
+                     const double* B, const std::size_t ldb, const double beta,
+                     double* C, const std::size_t ldc)
+{
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, alpha,
+              A, (int)lda, B, (int)ldb, beta, C, (int)ldc);
+}
+
+
+static void blasGemv(const bool transpose, const int m, const int n,
+                     const double alpha, const double* A, const std::size_t lda,
+                     const double* x, const double beta, double* y)
+{
+  cblas_dgemv(CblasRowMajor, transpose ? CblasTrans : CblasNoTrans, m, n,
+              alpha, A, (int)lda, x, 1, beta, y, 1);
+}
+
+
+static double blasDot(const int n, const double* x, const double* y)
+{
+  return cblas_ddot(n, x, 1, y, 1);
+}
+
+
+static void blasAxpy(const int n, const double alpha, const double* x, double* y)
+{
+  cblas_daxpy(n, alpha, x, 1, y, 1);
+}
+
+
+static double blasNorm1(const int n, const double* x)
+{
+  return cblas_dasum(n, x, 1);
+}
+
+
+static double blasNorm2(const int n, const double* x)
+{
+  return cblas_dnrm2(n, x, 1);
+}
+
+
+static double blasNormInf(const int n, const double* x)
+{
+  return std::abs(x[cblas_idamax(n, x, 1)]);
+}
+
+
+static void blasGer(const int m, const int n, const double alpha,
+                    const double* x, const double* y, double* A,
+                    const std::size_t lda)
+{
+  cblas_dger(CblasRowMajor, m, n, alpha, x, 1, y, 1, A, (int)lda);
+}
+
+
+static void blasSyrk(const bool transpose, const int n, const int k,
+                     const double alpha, const double* A, const std::size_t lda,
+                     const double beta, double* C, const std::size_t ldc)
+{
+  cblas_dsyrk(CblasRowMajor, CblasLower, transpose ? CblasTrans : CblasNoTrans,
+              n, k, alpha, A, (int)lda, beta, C, (int)ldc);
+  mirrorLower(n, C, ldc);
+}
+#endif
+
+
+/*
+ * Registry
+ */
+
+static const Backend referenceBackend = { "reference", refGemm, refGemv,
+  refDot, refAxpy, refNorm1, refNorm2, refNormInf, refGer, refSyrk };
+
+static const Backend optimizedBackend = { "optimized", optGemm, optGemv,
+  optDot, optAxpy, optNorm1, optNorm2, optNormInf, optGer, optSyrk };
+
+#ifdef MORPHEUS_HAVE_CBLAS
+static const Backend blasBackend = { "blas", blasGemm, blasGemv,
+  blasDot, blasAxpy, blasNorm1, blasNorm2, blasNormInf, blasGer, blasSyrk };
+#endif
+
+// The backends that are always available
+static std::deque<Backend> builtinBackends()
+{
+  std::deque<Backend> backends;
+  backends.push_back(referenceBackend);
+  backends.push_back(optimizedBackend);
+#ifdef MORPHEUS_HAVE_CBLAS
+  backends.push_back(blasBackend);
+#endif
+  return backends;
+}
+
+// A deque, so registering a backend never moves the existing ones
+static std::deque<Backend>& registry()
+{
+  static std::deque<Backend> backends = builtinBackends();
+  return backends;
+}
+
+// Set by initializeBackend, which runs exactly once, before either is
+// first read
+static const Backend* activeBackend = NULL;
+static bool checkMode = false;
+static std::once_flag backendFlag;
+static double checkTol = 1e-12;
+static std::atomic<long> checkFailures(0);
+
+static const Backend* findBackend(const std::string& name)
+{
+  std::deque<Backend>& backends = registry();
+  for(std::size_t i=0; i<backends.size(); i++)
+  {
+    if(name == backends[i].name)
+      return &backends[i];
+  }
+  return NULL;
+}
+
+
+/*
+ * Check mode: run the active and reference kernels side by side
+ */
+
+// Returns max |a-b| / max(max |b|, scale) over an m x n block
+static double blockDifference(const int m, const int n, const double* a,
+                              const std::size_t lda, const double* b,
+                              const std::size_t ldb, double scale)
+{
+  double maxDiff = 0;
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      double diff = std::abs(a[r*lda + c] - b[r*ldb + c]);
+      if(diff > maxDiff)
+        maxDiff = diff;
+      if(std::abs(b[r*ldb + c]) > scale)
+        scale = std::abs(b[r*ldb + c]);
+    }
+  }
+  return (scale > 0) ? maxDiff / scale : maxDiff;
+}
+
+static void reportMismatch(const char* kernel, const double diff)
+{
+  if(diff > checkTol)
+  {
+    checkFailures++;
+    std::cerr << "Morpheus: backend " << activeBackend->name << " " << kernel
+              << " differs from reference by " << diff << "\n";
+  }
+}
+
+static void chkGemm(const int m, const int n, const int k, const double alpha,
+                    const double* A, const std::size_t lda,
+                    const double* B, const std::size_t ldb, const double beta,
+                    double* C, const std::size_t ldc)
+{
+  std::vector<double> Cref((std::size_t)m*n);
+  for(int r=0; r<m; r++)
+    for(int c=0; c<n; c++)
+      Cref[(std::size_t)r*n + c] = C[r*ldc + c];
+
+  referenceBackend.gemm(m, n, k, alpha, A, lda, B, ldb, beta, &Cref[0], n);
+  activeBackend->gemm(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+  reportMismatch("gemm", blockDifference(m, n, C, ldc, &Cref[0], n, 0));
+}
+
+static void chkGemv(const bool transpose, const int m, const int n,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double* x, const double beta, double* y)
+{
+  int nout = transpose ? n : m;
+  std::vector<double> yref(y, y + nout);
+
+  referenceBackend.gemv(transpose, m, n, alpha, A, lda, x, beta, &yref[0]);
+  activeBackend->gemv(transpose, m, n, alpha, A, lda, x, beta, y);
+  reportMismatch("gemv", blockDifference(1, nout, y, nout, &yref[0], nout, 0));
+}
+
+static double chkDot(const int n, const double* x, const double* y)
+{
+  // Scale by sum |x_i y_i|, so cancellation is not reported as an error
+  double scale = 0;
+  for(int i=0; i<n; i++)
+    scale = scale + std::abs(x[i]*y[i]);
+
+  double ref = referenceBackend.dot(n, x, y);
+  double result = activeBackend->dot(n, x, y);
+  reportMismatch("dot", blockDifference(1, 1, &result, 1, &ref, 1, scale));
+  return result;
+}
+
+static void chkAxpy(const int n, const double alpha, const double* x, double* y)
+{
+  std::vector<double> yref(y, y + n);
+
+  referenceBackend.axpy(n, alpha, x, &yref[0]);
+  activeBackend->axpy(n, alpha, x, y);
+  reportMismatch("axpy", blockDifference(1, n, y, n, &yref[0], n, 0));
+}
+
+static double chkNorm1(const int n, const double* x)
+{
+  double ref = referenceBackend.norm1(n, x);
+  double result = activeBackend->norm1(n, x);
+  reportMismatch("norm1", blockDifference(1, 1, &result, 1, &ref, 1, 0));
+  return result;
+}
+
+static double chkNorm2(const int n, const double* x)
+{
+  double ref = referenceBackend.norm2(n, x);
+  double result = activeBackend->norm2(n, x);
+  reportMismatch("norm2", blockDifference(1, 1, &result, 1, &ref, 1, 0));
+  return result;
+}
+
+static double chkNormInf(const int n, const double* x)
+{
+  double ref = referenceBackend.normInf(n, x);
+  double result = activeBackend->normInf(n, x);
+  reportMismatch("normInf", blockDifference(1, 1, &result, 1, &ref, 1, 0));
+  return result;
+}
+
+static void chkGer(const int m, const int n, const double alpha,
+                   const double* x, const double* y, double* A,
+                   const std::size_t lda)
+{
+  std::vector<double> Aref((std::size_t)m*n);
+  for(int r=0; r<m; r++)
+    for(int c=0; c<n; c++)
+      Aref[(std::size_t)r*n + c] = A[r*lda + c];
+
+  referenceBackend.ger(m, n, alpha, x, y, &Aref[0], n);
+  activeBackend->ger(m, n, alpha, x, y, A, lda);
+  reportMismatch("ger", blockDifference(m, n, A, lda, &Aref[0], n, 0));
+}
+
+static void chkSyrk(const bool transpose, const int n, const int k,
+                    const double alpha, const double* A, const std::size_t lda,
+                    const double beta, double* C, const std::size_t ldc)
+{
+  std::vector<double> Cref((std::size_t)n*n);
+  for(int r=0; r<n; r++)
+    for(int c=0; c<n; c++)
+      Cref[(std::size_t)r*n + c] = C[r*ldc + c];
+
+  referenceBackend.syrk(transpose, n, k, alpha, A, lda, beta, &Cref[0], n);
+  activeBackend->syrk(transpose, n, k, alpha, A, lda, beta, C, ldc);
+  reportMismatch("syrk", blockDifference(n, n, C, ldc, &Cref[0], n, 0));
+}
+
+static const Backend checkBackendTable = { "check", chkGemm, chkGemv,
+  chkDot, chkAxpy, chkNorm1, chkNorm2, chkNormInf, chkGer, chkSyrk };
+
+
+/*
+ * Public interface
+ */
+
+// Applies MORPHEUS_BACKEND and MORPHEUS_BACKEND_CHECK.  The first call
+// often comes from inside a parallel region, so this runs under
+// std::call_once, and activeBackend is only set once the environment
+// has been read.
+static void initializeBackend()
+{
+  const Backend* backend = findBackend("optimized");
+
+  const char* name = std::getenv("MORPHEUS_BACKEND");
+  if(name != NULL && *name != '\0')
+  {
+    const Backend* chosen = findBackend(name);
+    if(chosen != NULL)
+      backend = chosen;
+    else
+      std::cerr << "Morpheus: unknown backend " << name
+                << "; using " << backend->name << "\n";
+  }
+
+  const char* check = std::getenv("MORPHEUS_BACKEND_CHECK");
+  if(check != NULL && std::atoi(check) != 0)
+    checkMode = true;
+
+  activeBackend = backend;
+}
+
+
+const Backend& getBackend()
+{
+  std::call_once(backendFlag, initializeBackend);
+  return checkMode ? checkBackendTable : *activeBackend;
+}
+
+
+bool setBackend(const std::string& name)
+{
+  // The environment must not override this later
+  std::call_once(backendFlag, initializeBackend);
+
+  const Backend* backend = findBackend(name);
+  if(backend == NULL)
+    return false;
+
+  activeBackend = backend;
+  return true;
+}
+
+
+void registerBackend(const Backend& backend)
+{
+  Backend filled = backend;
+  if(filled.gemm == NULL) filled.gemm = referenceBackend.gemm;
+  if(filled.gemv == NULL) filled.gemv = referenceBackend.gemv;
+  if(filled.dot == NULL) filled.dot = referenceBackend.dot;
+  if(filled.axpy == NULL) filled.axpy = referenceBackend.axpy;
+  if(filled.norm1 == NULL) filled.norm1 = referenceBackend.norm1;
+  if(filled.norm2 == NULL) filled.norm2 = referenceBackend.norm2;
+  if(filled.normInf == NULL) filled.normInf = referenceBackend.normInf;
+  if(filled.ger == NULL) filled.ger = referenceBackend.ger;
+  if(filled.syrk == NULL) filled.syrk = referenceBackend.syrk;
+
+  std::deque<Backend>& backends = registry();
+  for(std::size_t i=0; i<backends.size(); i++)
+  {
+    if(std::string(filled.name) == backends[i].name)
+    {
+      backends[i] = filled;
+      return;
+    }
+  }
+  backends.push_back(filled);
+}
+
+
+int getNumBackends()
+{
+  return (int)registry().size();
+}
+
+
+const Backend& getBackend(const int i)
+{
+  return registry().at(i);
+}
+
+
+bool checkBackend(const Backend& backend, const double tol)
+{
+  // Sizes that are not multiples of any block or vector width
+  const int m = 67, n = 131, k = 139;
+
+  // Deterministic pseudo-random data in [-1,1]
+  std::vector<double> A((std::size_t)m*k), B((std::size_t)k*n), C((std::size_t)m*n);
+  // y is the output of gemv with either orientation, and the n-vector
+  // of axpy and ger
+  std::vector<double> x(k > m ? k : m), y(std::max(std::max(m, n), k));
+  unsigned long seed = 12345;
+  std::vector<double>* arrays[5] = { &A, &B, &C, &x, &y };
+  for(int a=0; a<5; a++)
+  {
+    for(std::size_t i=0; i<arrays[a]->size(); i++)
+    {
+      seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+      (*arrays[a])[i] = (double)(seed >> 11) / (double)(1UL << 53) * 2 - 1;
+    }
+  }
+
+  bool passed = true;
+  double diff;
+  std::vector<double> out, ref;
+
+  // gemm with beta = 0 and beta != 0
+  for(int b=0; b<2; b++)
+  {
+    double beta = (b == 0) ? 0 : 0.5;
+    out = C; ref = C;
+    backend.gemm(m, n, k, 1.5, &A[0], k, &B[0], n, beta, &out[0], n);
+    referenceBackend.gemm(m, n, k, 1.5, &A[0], k, &B[0], n, beta, &ref[0], n);
+    diff = blockDifference(m, n, &out[0], n, &ref[0], n, 0);
+    std::cout << backend.name << " gemm (beta=" << beta << "): " << diff
+              << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+    passed = passed && (diff <= tol);
+  }
+
+  // gemv with and without the transpose
+  for(int t=0; t<2; t++)
+  {
+    bool transpose = (t == 1);
+    int nout = transpose ? k : m;
+    out = y; ref = y;
+    backend.gemv(transpose, m, k, -0.5, &A[0], k, &x[0], 2, &out[0]);
+    referenceBackend.gemv(transpose, m, k, -0.5, &A[0], k, &x[0], 2, &ref[0]);
+    diff = blockDifference(1, nout, &out[0], nout, &ref[0], nout, 0);
+    std::cout << backend.name << " gemv (transpose=" << transpose << "): "
+              << diff << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+    passed = passed && (diff <= tol);
+  }
+
+  // axpy
+  out = y; ref = y;
+  backend.axpy(n, 0.75, &x[0], &out[0]);
+  referenceBackend.axpy(n, 0.75, &x[0], &ref[0]);
+  diff = blockDifference(1, n, &out[0], n, &ref[0], n, 0);
+  std::cout << backend.name << " axpy: " << diff
+            << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+  passed = passed && (diff <= tol);
+
+  // ger
+  out = C; ref = C;
+  backend.ger(m, n, -1.25, &x[0], &y[0], &out[0], n);
+  referenceBackend.ger(m, n, -1.25, &x[0], &y[0], &ref[0], n);
+  diff = blockDifference(m, n, &out[0], n, &ref[0], n, 0);
+  std::cout << backend.name << " ger: " << diff
+            << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+  passed = passed && (diff <= tol);
+
+  // syrk with A (m x k) and with the transpose of B (k x n), so the
+  // output is m x m or n x n; the first n*n entries of B serve as C
+  for(int t=0; t<2; t++)
+  {
+    bool transpose = (t == 1);
+    int nout = transpose ? n : m;
+    out.assign(B.begin(), B.begin() + (std::size_t)nout*nout);
+    ref = out;
+    backend.syrk(transpose, nout, k, 0.5, transpose ? &B[0] : &A[0],
+                 transpose ? n : k, -2, &out[0], nout);
+    referenceBackend.syrk(transpose, nout, k, 0.5, transpose ? &B[0] : &A[0],
+                          transpose ? n : k, -2, &ref[0], nout);
+    diff = blockDifference(nout, nout, &out[0], nout, &ref[0], nout, 0);
+    std::cout << backend.name << " syrk (transpose=" << transpose << "): "
+              << diff << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+    passed = passed && (diff <= tol);
+  }
+
+  // Reductions
+  double scale = 0;
+  for(int i=0; i<n; i++)
+    scale = scale + std::abs(x[i]*y[i]);
+  double results[4] = { backend.dot(n, &x[0], &y[0]), backend.norm1(n, &y[0]),
+                        backend.norm2(n, &y[0]), backend.normInf(n, &y[0]) };
+  double refs[4] = { referenceBackend.dot(n, &x[0], &y[0]),
+                     referenceBackend.norm1(n, &y[0]),
+                     referenceBackend.norm2(n, &y[0]),
+                     referenceBackend.normInf(n, &y[0]) };
+  const char* names[4] = { "dot", "norm1", "norm2", "normInf" };
+  for(int i=0; i<4; i++)
+  {
+    diff = blockDifference(1, 1, &results[i], 1, &refs[i], 1, (i == 0) ? scale : 0);
+    std::cout << backend.name << " " << names[i] << ": " << diff
+              << ((diff <= tol) ? " ok\n" : " MISMATCH\n");
+    passed = passed && (diff <= tol);
+  }
+
+  return passed;
+}
+
+
+void setBackendCheck(const bool enable, const double tol)
+{
+  std::call_once(backendFlag, initializeBackend);
+  checkMode = enable;
+  checkTol = tol;
+}
+
+
+long getBackendCheckFailures()
+{
+  return checkFailures;
+}
+
+} /* namespace Morpheus */
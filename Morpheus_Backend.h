@@ -0,0 +1,141 @@
+/**
+ * @file
+ * \brief Defines the compute backends that Matrix and Vector dispatch to
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_BACKEND_H_
+#define MORPHEUS_BACKEND_H_
+
+#include <cstddef>
+#include <string>
+
+namespace Morpheus {
+
+/** \brief Table of the low-level kernels used by Matrix and Vector
+ *
+ * Every dense kernel in Morpheus goes through the active backend, so
+ * a new implementation (blocked, SIMD, threaded, a vendor BLAS...)
+ * only has to fill in this table and call registerBackend.
+ *
+ * All matrices are stored row by row; \a lda is the distance between
+ * the starts of consecutive rows.  As in the BLAS, when \a beta is 0
+ * the output is not read, so it does not need to be initialized.
+ *
+ * The following backends are built in:
+ * - \c reference: plain serial loops.  Slow, but easy to trust.
+ * - \c optimized: cache-blocked, SIMD and OpenMP-threaded loops.
+ *   This is the default.
+ * - \c blas: the CBLAS library installed on the system.  Only
+ *   available when built with <tt>make BLAS=1</tt>.
+ */
+struct Backend {
+  //! Name used to select the backend
+  const char* name;
+
+  //! C = alpha*A*B + beta*C, where A is m x k, B is k x n and C is m x n
+  void (*gemm)(const int m, const int n, const int k, const double alpha,
+               const double* A, const std::size_t lda,
+               const double* B, const std::size_t ldb, const double beta,
+               double* C, const std::size_t ldc);
+
+  /** y = alpha*op(A)*x + beta*y, where A is m x n and op(A) is A or,
+   * if \a transpose is true, its transpose */
+  void (*gemv)(const bool transpose, const int m, const int n,
+               const double alpha, const double* A, const std::size_t lda,
+               const double* x, const double beta, double* y);
+
+  //! Returns x dot y, for vectors of length n
+  double (*dot)(const int n, const double* x, const double* y);
+
+  //! y = alpha*x + y, for vectors of length n
+  void (*axpy)(const int n, const double alpha, const double* x, double* y);
+
+  //! Returns the sum of the magnitudes of the entries of x
+  double (*norm1)(const int n, const double* x);
+
+  //! Returns the 2-norm of x
+  double (*norm2)(const int n, const double* x);
+
+  //! Returns the largest magnitude of the entries of x
+  double (*normInf)(const int n, const double* x);
+
+  //! A = alpha*x*y^T + A, where A is m x n (BLAS GER)
+  void (*ger)(const int m, const int n, const double alpha, const double* x,
+              const double* y, double* A, const std::size_t lda);
+
+  /** C = alpha*op(A)*op(A)^T + beta*C, where C is n x n and op(A) is
+   * the n x k matrix A or, if \a transpose is true, the transpose of
+   * the k x n matrix A (BLAS SYRK).  Only the lower triangle of C is
+   * read; the upper triangle is overwritten with its mirror image, so
+   * C is exactly symmetric afterwards. */
+  void (*syrk)(const bool transpose, const int n, const int k,
+               const double alpha, const double* A, const std::size_t lda,
+               const double beta, double* C, const std::size_t ldc);
+};
+
+//! \name Backend selection
+///@{
+/** \brief Returns the active backend
+ *
+ * The first call selects the backend named by the environment
+ * variable <tt>MORPHEUS_BACKEND</tt>, or \c optimized if it is not
+ * set.  If <tt>MORPHEUS_BACKEND_CHECK</tt> is set to a nonzero value,
+ * check mode is enabled too (see setBackendCheck).
+ */
+const Backend& getBackend();
+
+/** \brief Makes the backend called \a name the active one
+ *
+ * Returns false, leaving the active backend unchanged, if no backend
+ * with that name has been registered.
+ *
+ * \warning This is not thread safe; call it before starting any
+ * threads that use Matrix or Vector.
+ */
+bool setBackend(const std::string& name);
+
+/** \brief Adds a backend to the list that setBackend chooses from
+ *
+ * A backend with the same name as an existing one replaces it.
+ * Missing kernels (null function pointers) are taken from the
+ * reference backend.
+ */
+void registerBackend(const Backend& backend);
+
+//! Returns the number of registered backends
+int getNumBackends();
+
+//! Returns registered backend number \a i
+const Backend& getBackend(const int i);
+///@}
+
+//! \name Validation
+///@{
+/** \brief Compares every kernel of \a backend against the reference
+ *
+ * Runs each kernel on the same random data with both backends,
+ * using sizes that are not multiples of any block size, and prints
+ * one line per kernel to standard output.  Returns true if every
+ * result agrees with the reference to a relative tolerance of
+ * \a tol.  Use this to validate an optimized backend on new hardware
+ * before rolling it out.
+ */
+bool checkBackend(const Backend& backend, const double tol=1e-12);
+
+/** \brief Enables or disables check mode
+ *
+ * In check mode every kernel call made by Matrix and Vector runs on
+ * both the active backend and the reference backend, and any result
+ * that differs by more than \a tol (relative) is reported on standard
+ * error.  This roughly doubles the cost of every call.
+ */
+void setBackendCheck(const bool enable, const double tol=1e-12);
+
+//! Returns the number of mismatches found in check mode so far
+long getBackendCheckFailures();
+///@}
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_BACKEND_H_ */
@@ -0,0 +1,480 @@
+/**
+ * @file
+ * \brief Defines a BandedMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_BandedMatrix.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace Morpheus {
+
+// Returned by the const accessor for entries outside the band
+static const double zero = 0;
+
+BandedMatrix::BandedMatrix(const int n, const int kl, const int ku)
+{
+  allocateBand(n, kl, ku);
+}
+
+
+BandedMatrix::BandedMatrix(const Matrix& A, const double tol)
+{
+  // Make sure the matrix is square
+  assert(A.getNumRows() == A.getNumCols());
+
+  int kl, ku;
+  detectBandwidth(A, tol, kl, ku);
+  allocateBand(A.getNumRows(), kl, ku);
+
+  #pragma omp parallel for schedule(static)
+  for(int c=0; c<n_; c++)
+  {
+    int rbegin = (c - ku_ > 0) ? c - ku_ : 0;
+    int rend = (c + kl_ < n_-1) ? c + kl_ : n_-1;
+    for(int r=rbegin; r<=rend; r++)
+    {
+      if(std::abs(A(r,c)) > tol)
+        at(r,c) = A(r,c);
+    }
+  }
+}
+
+
+BandedMatrix::~BandedMatrix()
+{
+  deallocate(ab_, (std::size_t)ldab_*n_, ALLOC_FIRST_TOUCH);
+  delete[] ipiv_;
+}
+
+
+void BandedMatrix::allocateBand(const int n, const int kl, const int ku)
+{
+  n_ = n;
+  kl_ = kl;
+  ku_ = ku;
+
+  // Make sure the dimensions make sense
+  assert(n_ > 0);
+  assert(kl_ >= 0 && kl_ < n_);
+  assert(ku_ >= 0 && ku_ < n_);
+
+  // One block per column, zeroed by the thread that will use it
+  ldab_ = 2*kl_ + ku_ + 1;
+  ab_ = allocate(n_, ldab_, ALLOC_FIRST_TOUCH);
+  ipiv_ = new int[n_];
+  factored_ = NONE;
+}
+
+
+double& BandedMatrix::at(const int row, const int col) const
+{
+  return ab_[kl_ + ku_ + row - col + (std::size_t)col*ldab_];
+}
+
+
+double& BandedMatrix::operator()(const int row, const int col)
+{
+  // Make sure the entry is inside the band
+  assert(row >= 0 && row < n_ && col >= 0 && col < n_);
+  assert(row - col <= kl_ && col - row <= ku_);
+
+  return at(row, col);
+}
+
+
+const double& BandedMatrix::operator()(const int row, const int col) const
+{
+  assert(row >= 0 && row < n_ && col >= 0 && col < n_);
+
+  if(row - col > kl_ || col - row > ku_)
+    return zero;
+  return at(row, col);
+}
+
+
+int BandedMatrix::getNumRows() const
+{
+  return n_;
+}
+
+
+int BandedMatrix::getNumCols() const
+{
+  return n_;
+}
+
+
+int BandedMatrix::getLowerBandwidth() const
+{
+  return kl_;
+}
+
+
+int BandedMatrix::getUpperBandwidth() const
+{
+  return ku_;
+}
+
+
+void BandedMatrix::detectBandwidth(const Matrix& A, const double tol,
+                                   int& kl, int& ku)
+{
+  int nrows = A.getNumRows();
+  int ncols = A.getNumCols();
+  int lower = 0, upper = 0;
+
+  #pragma omp parallel
+  {
+    int myLower = 0, myUpper = 0;
+
+    #pragma omp for schedule(static)
+    for(int r=0; r<nrows; r++)
+    {
+      // Only look outside the band found so far
+      for(int c=0; c<r-myLower; c++)
+      {
+        if(std::abs(A(r,c)) > tol)
+        {
+          myLower = r-c;
+          break;
+        }
+      }
+      for(int c=ncols-1; c>r+myUpper; c--)
+      {
+        if(std::abs(A(r,c)) > tol)
+        {
+          myUpper = c-r;
+          break;
+        }
+      }
+    }
+
+    #pragma omp critical
+    {
+      if(myLower > lower) lower = myLower;
+      if(myUpper > upper) upper = myUpper;
+    }
+  }
+
+  kl = lower;
+  ku = upper;
+}
+
+
+void BandedMatrix::copyTo(Matrix& A) const
+{
+  assert(A.getNumRows() == n_);
+  assert(A.getNumCols() == n_);
+
+  // Detach A once, before the threads write to it
+  double* a = &A(0,0);
+
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<n_; r++)
+  {
+    for(int c=0; c<n_; c++)
+      a[(std::size_t)r*n_ + c] = (*this)(r,c);
+  }
+}
+
+
+void BandedMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void BandedMatrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void BandedMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void BandedMatrix::gemv(const double alpha, const Vector& X, const double beta,
+                        Vector& Y, const bool transpose) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == n_);
+  assert(Y.getNumElements() == n_);
+  assert(factored_ == NONE);
+
+  const double* x = &X[0];
+  double* y = &Y[0];
+
+  // Row i of the matrix is a strided diagonal walk through the band;
+  // column i is a contiguous stretch of it
+  const int before = transpose ? ku_ : kl_;
+  const int after = transpose ? kl_ : ku_;
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<n_; i++)
+  {
+    int jbegin = (i - before > 0) ? i - before : 0;
+    int jend = (i + after < n_-1) ? i + after : n_-1;
+    double sum = 0;
+    for(int j=jbegin; j<=jend; j++)
+      sum = sum + (transpose ? at(j,i) : at(i,j)) * x[j];
+    y[i] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[i];
+  }
+}
+
+
+bool BandedMatrix::factorLU()
+{
+  assert(factored_ == NONE);
+
+  bool nonsingular = true;
+
+  // Clear the rows that receive fill-in from row interchanges
+  for(int c=0; c<n_; c++)
+  {
+    for(int b=0; b<kl_; b++)
+      ab_[b + (std::size_t)c*ldab_] = 0;
+  }
+
+  // ju is the last column touched by any earlier row interchange
+  int ju = 0;
+  for(int j=0; j<n_; j++)
+  {
+    int km = (kl_ < n_-1-j) ? kl_ : n_-1-j;
+
+    // Find the pivot in column j
+    int jp = 0;
+    double maxVal = std::abs(at(j,j));
+    for(int p=1; p<=km; p++)
+    {
+      if(std::abs(at(j+p,j)) > maxVal)
+      {
+        maxVal = std::abs(at(j+p,j));
+        jp = p;
+      }
+    }
+    ipiv_[j] = j + jp;
+
+    if(at(j+jp,j) == 0)
+    {
+      nonsingular = false;
+      continue;
+    }
+
+    int last = (j + ku_ + jp < n_-1) ? j + ku_ + jp : n_-1;
+    if(last > ju)
+      ju = last;
+
+    // Swap rows j and j+jp in columns j through ju
+    if(jp != 0)
+    {
+      for(int c=j; c<=ju; c++)
+      {
+        double tmp = at(j,c);
+        at(j,c) = at(j+jp,c);
+        at(j+jp,c) = tmp;
+      }
+    }
+
+    // Compute the multipliers and update the trailing band
+    double pivot = at(j,j);
+    for(int r=j+1; r<=j+km; r++)
+      at(r,j) = at(r,j) / pivot;
+
+    for(int c=j+1; c<=ju; c++)
+    {
+      double ujc = at(j,c);
+      if(ujc == 0)
+        continue;
+      for(int r=j+1; r<=j+km; r++)
+        at(r,c) = at(r,c) - at(r,j)*ujc;
+    }
+  }
+
+  factored_ = LU;
+  return nonsingular;
+}
+
+
+bool BandedMatrix::factorCholesky()
+{
+  assert(factored_ == NONE);
+  assert(kl_ == ku_);
+
+  for(int j=0; j<n_; j++)
+  {
+    double ajj = at(j,j);
+    if(ajj <= 0)
+      return false;
+    ajj = std::sqrt(ajj);
+    at(j,j) = ajj;
+
+    // Scale column j below the diagonal, then update the trailing
+    // lower triangle of the band
+    int kn = (kl_ < n_-1-j) ? kl_ : n_-1-j;
+    for(int r=j+1; r<=j+kn; r++)
+      at(r,j) = at(r,j) / ajj;
+
+    for(int c=j+1; c<=j+kn; c++)
+    {
+      double lcj = at(c,j);
+      for(int r=c; r<=j+kn; r++)
+        at(r,c) = at(r,c) - at(r,j)*lcj;
+    }
+  }
+
+  factored_ = CHOLESKY;
+  return true;
+}
+
+
+void BandedMatrix::solve(const Vector& B, Vector& X) const
+{
+  assert(factored_ != NONE);
+  assert(B.getNumElements() == n_);
+  assert(X.getNumElements() == n_);
+
+  double* x = &X[0];
+  if(&B != &X)
+  {
+    for(int i=0; i<n_; i++)
+      x[i] = B[i];
+  }
+
+  if(factored_ == LU)
+  {
+    const int kv = kl_ + ku_;
+
+    // Apply the row interchanges and L
+    for(int j=0; j<n_-1; j++)
+    {
+      int lm = (kl_ < n_-1-j) ? kl_ : n_-1-j;
+      int l = ipiv_[j];
+      if(l != j)
+      {
+        double tmp = x[l];
+        x[l] = x[j];
+        x[j] = tmp;
+      }
+      for(int i=j+1; i<=j+lm; i++)
+        x[i] = x[i] - at(i,j)*x[j];
+    }
+
+    // Back substitution with U, which has kl+ku superdiagonals
+    for(int j=n_-1; j>=0; j--)
+    {
+      x[j] = x[j] / at(j,j);
+      int ibegin = (j - kv > 0) ? j - kv : 0;
+      for(int i=ibegin; i<j; i++)
+        x[i] = x[i] - at(i,j)*x[j];
+    }
+    return;
+  }
+
+  // Forward substitution with L
+  for(int j=0; j<n_; j++)
+  {
+    x[j] = x[j] / at(j,j);
+    int kn = (kl_ < n_-1-j) ? kl_ : n_-1-j;
+    for(int i=j+1; i<=j+kn; i++)
+      x[i] = x[i] - at(i,j)*x[j];
+  }
+
+  // Back substitution with L^T
+  for(int j=n_-1; j>=0; j--)
+  {
+    int kn = (kl_ < n_-1-j) ? kl_ : n_-1-j;
+    double sum = x[j];
+    for(int i=j+1; i<=j+kn; i++)
+      sum = sum - at(i,j)*x[i];
+    x[j] = sum / at(j,j);
+  }
+}
+
+
+bool BandedMatrix::isSymmetric() const
+{
+  if(kl_ != ku_)
+    return false;
+
+  for(int c=0; c<n_; c++)
+  {
+    int rend = (c + kl_ < n_-1) ? c + kl_ : n_-1;
+    for(int r=c+1; r<=rend; r++)
+    {
+      if(at(r,c) != at(c,r))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+
+// Maximum absolute column sum
+double BandedMatrix::norm1() const
+{
+  double maxColSum = 0;
+
+  #pragma omp parallel for schedule(static) reduction(max:maxColSum)
+  for(int c=0; c<n_; c++)
+  {
+    int rbegin = (c - ku_ > 0) ? c - ku_ : 0;
+    int rend = (c + kl_ < n_-1) ? c + kl_ : n_-1;
+    double curColSum = 0;
+    for(int r=rbegin; r<=rend; r++)
+      curColSum = curColSum + std::abs(at(r,c));
+    if(curColSum > maxColSum)
+      maxColSum = curColSum;
+  }
+  return maxColSum;
+}
+
+
+// Maximum absolute row sum
+double BandedMatrix::normInf() const
+{
+  double maxRowSum = 0;
+
+  #pragma omp parallel for schedule(static) reduction(max:maxRowSum)
+  for(int r=0; r<n_; r++)
+  {
+    int cbegin = (r - kl_ > 0) ? r - kl_ : 0;
+    int cend = (r + ku_ < n_-1) ? r + ku_ : n_-1;
+    double curRowSum = 0;
+    for(int c=cbegin; c<=cend; c++)
+      curRowSum = curRowSum + std::abs(at(r,c));
+    if(curRowSum > maxRowSum)
+      maxRowSum = curRowSum;
+  }
+  return maxRowSum;
+}
+
+
+void BandedMatrix::print() const
+{
+  // Formatted in one buffer, with std::cout's settings, and written
+  // and flushed once
+  std::ostringstream out;
+  out.copyfmt(std::cout);
+  out << n_ << "x" << n_ << " BandedMatrix with " << kl_
+      << " subdiagonals and " << ku_ << " superdiagonals\n";
+  for(int r=0; r<n_; r++)
+  {
+    for(int c=0; c<n_; c++)
+    {
+      out << (*this)(r,c) << " ";
+    }
+    out << '\n';
+  }
+  std::cout << out.str() << std::flush;
+}
+
+} /* namespace Morpheus */
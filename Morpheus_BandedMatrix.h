@@ -0,0 +1,228 @@
+/**
+ * @file
+ * \brief Defines a BandedMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_BANDEDMATRIX_H_
+#define MORPHEUS_BANDEDMATRIX_H_
+
+#include "Morpheus_Matrix.h"
+
+namespace Morpheus {
+
+/** \class BandedMatrix
+ * \brief Stores a square banded matrix
+ *
+ * Only the entries with \a -kl <= \a col - \a row <= \a ku are stored,
+ * so storage, multiplication and norms are all O(n * bandwidth)
+ * instead of O(n^2).
+ *
+ * The entries are kept in LAPACK band storage (as used by DGBTRF):
+ * column \a j is stored contiguously, and entry (\a i, \a j) lives in
+ * row \a kl + \a ku + \a i - \a j of a (2*\a kl + \a ku + 1) x \a n
+ * column-major array.  The top \a kl rows are only used to hold the
+ * fill-in created by pivoting in factorLU.
+ *
+ * \example Morpheus_BandedMatrix_Tests.cpp
+ * Demonstrates the usage of the banded matrix class
+ */
+class BandedMatrix : public LinearOperator {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Constructor
+   *
+   * Allocates memory for an \a n x \a n matrix with \a kl
+   * subdiagonals and \a ku superdiagonals, all set to 0.
+   * If \a n is not positive, or \a kl or \a ku is negative, the
+   * program terminates.
+   * \param[in] n Number of rows and columns
+   * \param[in] kl Number of subdiagonals
+   * \param[in] ku Number of superdiagonals
+   */
+  BandedMatrix(const int n, const int kl, const int ku);
+
+  /** \brief Converts a dense matrix
+   *
+   * The bandwidth is detected automatically (see detectBandwidth).
+   * If \a A is not square, the program terminates.
+   * \param[in] A Dense matrix to convert
+   * \param[in] tol Entries with magnitude at most \a tol are treated
+   * as zero when detecting the bandwidth, and dropped
+   */
+  BandedMatrix(const Matrix& A, const double tol=0);
+
+  /** \brief Destructor
+   *
+   * Deallocates memory allocated in the constructor
+   */
+  ~BandedMatrix();
+  ///@}
+
+  //! \name Accessor functions
+  ///@{
+  /** \brief Accesses a single entry within the band
+   *
+   * \param[in] row Row
+   * \param[in] col Column
+   *
+   * \note This is 0-based indexing.  If (\a row, \a col) is outside
+   * the band, the program terminates.
+   */
+  double& operator()(const int row, const int col);
+
+  /** \brief Reads a single entry
+   *
+   * Entries outside the band are 0.
+   * \param[in] row Row
+   * \param[in] col Column
+   */
+  const double& operator()(const int row, const int col) const;
+
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+
+  //! Returns the number of subdiagonals
+  int getLowerBandwidth() const;
+
+  //! Returns the number of superdiagonals
+  int getUpperBandwidth() const;
+
+  /** \brief Finds the bandwidth of a dense matrix
+   *
+   * \param[in] A Dense matrix
+   * \param[in] tol Entries with magnitude at most \a tol are treated
+   * as zero
+   * \param[out] kl Largest \a row - \a col of a nonzero entry
+   * \param[out] ku Largest \a col - \a row of a nonzero entry
+   */
+  static void detectBandwidth(const Matrix& A, const double tol,
+                              int& kl, int& ku);
+
+  /** \brief Copies the matrix into a dense matrix
+   *
+   * \param[out] A An \a n x \a n matrix
+   */
+  void copyTo(Matrix& A) const;
+  ///@}
+
+  //! \name Multiplication routines
+  ///@{
+  /** \brief Computes a matrix-vector multiplication
+   *
+   * \param[in] X vector to be multiplied
+   * \param[out] Y result of multiplication
+   *
+   * \note \a X and \a Y must have \a n entries.  This may not be
+   * called after the matrix has been factored.
+   */
+  void multiply(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes \a Y = \a alpha * op(\a this) * \a X + \a beta * \a Y
+   *
+   * Works exactly like Matrix::gemv.
+   */
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  ///@}
+
+  //! \name Factorizations and solves
+  ///@{
+  /** \brief Computes the LU factorization with partial pivoting in place
+   *
+   * This is the banded algorithm of LAPACK's DGBTF2; it takes
+   * O(n * kl * (kl+ku)) operations.  The factors overwrite the
+   * matrix, so multiply may no longer be called.
+   *
+   * Returns false if the matrix is exactly singular.
+   */
+  bool factorLU();
+
+  /** \brief Computes the Cholesky factorization A = L*L^T in place
+   *
+   * The matrix must be symmetric positive definite, with \a kl equal
+   * to \a ku; only the lower band is read.  This takes
+   * O(n * kl^2) operations.  The factor overwrites the lower band, so
+   * multiply may no longer be called.
+   *
+   * Returns false if the matrix is not positive definite; the lower
+   * band has then been partly overwritten.
+   */
+  bool factorCholesky();
+
+  /** \brief Solves \a this * \a X = \a B using the stored factorization
+   *
+   * Either factorLU or factorCholesky must have been called first.
+   * This takes O(n * bandwidth) operations.
+   * \param[in] B right-hand side
+   * \param[out] X solution.  May be the same vector as \a B.
+   */
+  void solve(const Vector& B, Vector& X) const;
+  ///@}
+
+  //! \name Matrix property query methods
+  ///@{
+  //! Determines whether the matrix is symmetric
+  bool isSymmetric() const;
+  ///@}
+
+  //! \name Norms
+  ///@{
+
+  //! Maximum absolute column sum
+  double norm1() const;
+
+  //! Maximum absolute row sum
+  double normInf() const;
+  ///@}
+
+  //! \name I/O functions
+  ///@{
+  //! Prints the matrix to console in dense form
+  void print() const;
+  ///@}
+
+private:
+  //! Which factorization, if any, has overwritten the entries
+  enum Factorization { NONE, LU, CHOLESKY };
+
+  //! Copying is not supported
+  BandedMatrix(const BandedMatrix&);
+  //! Copying is not supported
+  BandedMatrix& operator=(const BandedMatrix&);
+
+  //! Allocates and zeroes the band storage
+  void allocateBand(const int n, const int kl, const int ku);
+
+  //! Returns the band storage entry that holds (\a row, \a col)
+  double& at(const int row, const int col) const;
+
+  //! Number of rows and columns
+  int n_;
+  //! Number of subdiagonals
+  int kl_;
+  //! Number of superdiagonals
+  int ku_;
+  //! Leading dimension of the band storage, 2*kl+ku+1
+  int ldab_;
+  //! Band storage, column by column
+  double* ab_;
+  //! Row interchanges from factorLU
+  int* ipiv_;
+  //! Current factorization
+  Factorization factored_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_BANDEDMATRIX_H_ */
@@ -0,0 +1,340 @@
+/**
+ * @file
+ * \brief Defines a CsrMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_CsrMatrix.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace Morpheus {
+
+CsrMatrix::CsrMatrix(const int nrows, const int ncols)
+{
+  nrows_ = nrows;
+  ncols_ = ncols;
+
+  // Make sure the dimensions make sense
+  assert(nrows_ > 0);
+  assert(ncols_ > 0);
+
+  rowPtr_.assign(nrows_+1, 0);
+}
+
+
+CsrMatrix::CsrMatrix(const int nrows, const int ncols, const int nnz,
+                     const int* rowInd, const int* colInd, const double* vals)
+{
+  nrows_ = nrows;
+  ncols_ = ncols;
+
+  // Make sure the dimensions make sense
+  assert(nrows_ > 0);
+  assert(ncols_ > 0);
+  assert(nnz >= 0);
+
+  // Count the entries in each row, then bucket them
+  rowPtr_.assign(nrows_+1, 0);
+  for(int k=0; k<nnz; k++)
+  {
+    assert(rowInd[k] >= 0 && rowInd[k] < nrows_);
+    assert(colInd[k] >= 0 && colInd[k] < ncols_);
+    rowPtr_[rowInd[k]+1]++;
+  }
+  for(int r=0; r<nrows_; r++)
+    rowPtr_[r+1] += rowPtr_[r];
+
+  colInd_.resize(nnz);
+  vals_.resize(nnz);
+  std::vector<int> next(rowPtr_.begin(), rowPtr_.end()-1);
+  for(int k=0; k<nnz; k++)
+  {
+    int pos = next[rowInd[k]]++;
+    colInd_[pos] = colInd[k];
+    vals_[pos] = vals[k];
+  }
+
+  sortRows();
+}
+
+
+CsrMatrix::CsrMatrix(const int nrows, const int ncols, const int* rowPtr,
+                     const int* colInd, const double* vals)
+{
+  nrows_ = nrows;
+  ncols_ = ncols;
+
+  // Make sure the dimensions make sense
+  assert(nrows_ > 0);
+  assert(ncols_ > 0);
+  assert(rowPtr[0] == 0);
+
+  int nnz = rowPtr[nrows_];
+  rowPtr_.assign(rowPtr, rowPtr + nrows_ + 1);
+  colInd_.assign(colInd, colInd + nnz);
+  vals_.assign(vals, vals + nnz);
+
+  sortRows();
+}
+
+
+void CsrMatrix::sortRows()
+{
+  // Sort each row by column
+  #pragma omp parallel for schedule(dynamic,256)
+  for(int r=0; r<nrows_; r++)
+  {
+    int begin = rowPtr_[r], end = rowPtr_[r+1];
+    bool sorted = true;
+    for(int k=begin+1; k<end; k++)
+    {
+      if(colInd_[k] <= colInd_[k-1])
+      {
+        sorted = false;
+        break;
+      }
+    }
+    if(sorted)
+      continue;
+
+    std::vector<std::pair<int,double> > row(end - begin);
+    for(int k=begin; k<end; k++)
+      row[k-begin] = std::make_pair(colInd_[k], vals_[k]);
+    std::sort(row.begin(), row.end());
+    for(int k=begin; k<end; k++)
+    {
+      colInd_[k] = row[k-begin].first;
+      vals_[k] = row[k-begin].second;
+    }
+  }
+
+  // Sum duplicates and compact the arrays
+  int pos = 0;
+  int begin = 0;
+  for(int r=0; r<nrows_; r++)
+  {
+    int end = rowPtr_[r+1];
+    rowPtr_[r] = pos;
+    for(int k=begin; k<end; k++)
+    {
+      if(pos > rowPtr_[r] && colInd_[pos-1] == colInd_[k])
+      {
+        vals_[pos-1] += vals_[k];
+      }
+      else
+      {
+        colInd_[pos] = colInd_[k];
+        vals_[pos] = vals_[k];
+        pos++;
+      }
+    }
+    begin = end;
+  }
+  rowPtr_[nrows_] = pos;
+  colInd_.resize(pos);
+  vals_.resize(pos);
+}
+
+
+int CsrMatrix::getNumRows() const
+{
+  return nrows_;
+}
+
+
+int CsrMatrix::getNumCols() const
+{
+  return ncols_;
+}
+
+
+int CsrMatrix::getNumEntries() const
+{
+  return rowPtr_[nrows_];
+}
+
+
+int CsrMatrix::getRowLength(const int row) const
+{
+  return rowPtr_[row+1] - rowPtr_[row];
+}
+
+
+const int* CsrMatrix::getRowPtr() const
+{
+  return &rowPtr_[0];
+}
+
+
+const int* CsrMatrix::getColIndices() const
+{
+  return colInd_.empty() ? NULL : &colInd_[0];
+}
+
+
+const double* CsrMatrix::getValues() const
+{
+  return vals_.empty() ? NULL : &vals_[0];
+}
+
+
+double* CsrMatrix::getValues()
+{
+  return vals_.empty() ? NULL : &vals_[0];
+}
+
+
+void CsrMatrix::permute(const int* perm)
+{
+  // Make sure the matrix is square
+  assert(nrows_ == ncols_);
+
+  std::vector<int> inverse(nrows_);
+  for(int i=0; i<nrows_; i++)
+    inverse[perm[i]] = i;
+
+  // New row i is old row perm[i], with its columns renumbered
+  std::vector<int> rowPtr(nrows_+1);
+  rowPtr[0] = 0;
+  for(int i=0; i<nrows_; i++)
+    rowPtr[i+1] = rowPtr[i] + getRowLength(perm[i]);
+
+  std::vector<int> colInd(colInd_.size());
+  std::vector<double> vals(vals_.size());
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<nrows_; i++)
+  {
+    int pos = rowPtr[i];
+    for(int k=rowPtr_[perm[i]]; k<rowPtr_[perm[i]+1]; k++)
+    {
+      colInd[pos] = inverse[colInd_[k]];
+      vals[pos] = vals_[k];
+      pos++;
+    }
+  }
+
+  rowPtr_.swap(rowPtr);
+  colInd_.swap(colInd);
+  vals_.swap(vals);
+  sortRows();
+}
+
+
+int CsrMatrix::getBandwidth() const
+{
+  int bandwidth = 0;
+
+  #pragma omp parallel for schedule(static) reduction(max:bandwidth)
+  for(int r=0; r<nrows_; r++)
+  {
+    // The columns are sorted, so only the ends of the row matter
+    if(rowPtr_[r] == rowPtr_[r+1])
+      continue;
+    int lower = r - colInd_[rowPtr_[r]];
+    int upper = colInd_[rowPtr_[r+1]-1] - r;
+    if(lower > bandwidth) bandwidth = lower;
+    if(upper > bandwidth) bandwidth = upper;
+  }
+  return bandwidth;
+}
+
+
+long CsrMatrix::getProfile() const
+{
+  long profile = 0;
+
+  #pragma omp parallel for schedule(static) reduction(+:profile)
+  for(int r=0; r<nrows_; r++)
+  {
+    if(rowPtr_[r] < rowPtr_[r+1] && colInd_[rowPtr_[r]] < r)
+      profile += r - colInd_[rowPtr_[r]];
+  }
+  return profile;
+}
+
+
+void CsrMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void CsrMatrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void CsrMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void CsrMatrix::gemv(const double alpha, const Vector& X, const double beta,
+                     Vector& Y, const bool transpose) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == (transpose ? nrows_ : ncols_));
+  assert(Y.getNumElements() == (transpose ? ncols_ : nrows_));
+
+  const double* x = &X[0];
+  double* y = &Y[0];
+  const int* rowPtr = &rowPtr_[0];
+  const int* colInd = getColIndices();
+  const double* vals = getValues();
+
+  if(!transpose)
+  {
+    #pragma omp parallel for schedule(static)
+    for(int r=0; r<nrows_; r++)
+    {
+      double sum = 0;
+      for(int k=rowPtr[r]; k<rowPtr[r+1]; k++)
+        sum = sum + vals[k]*x[colInd[k]];
+      y[r] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[r];
+    }
+    return;
+  }
+
+  // Row r of the matrix scatters into y
+  #pragma omp parallel for schedule(static)
+  for(int c=0; c<ncols_; c++)
+    y[c] = (beta == 0) ? 0 : beta*y[c];
+
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<nrows_; r++)
+  {
+    double ax = alpha*x[r];
+    for(int k=rowPtr[r]; k<rowPtr[r+1]; k++)
+    {
+      #pragma omp atomic
+      y[colInd[k]] += vals[k]*ax;
+    }
+  }
+}
+
+
+void CsrMatrix::print() const
+{
+  // Formatted in one buffer, as in BandedMatrix::print
+  std::ostringstream out;
+  out.copyfmt(std::cout);
+  out << nrows_ << "x" << ncols_ << " CsrMatrix with "
+      << getNumEntries() << " nonzeros\n";
+  for(int r=0; r<nrows_; r++)
+  {
+    for(int k=rowPtr_[r]; k<rowPtr_[r+1]; k++)
+    {
+      out << "(" << r << "," << colInd_[k] << ") = " << vals_[k] << '\n';
+    }
+  }
+  std::cout << out.str() << std::flush;
+}
+
+} /* namespace Morpheus */
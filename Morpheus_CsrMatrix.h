@@ -0,0 +1,184 @@
+/**
+ * @file
+ * \brief Defines a CsrMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_CSRMATRIX_H_
+#define MORPHEUS_CSRMATRIX_H_
+
+#include "Morpheus_LinearOperator.h"
+#include "Morpheus_Vector.h"
+#include <vector>
+
+namespace Morpheus {
+
+/** \class CsrMatrix
+ * \brief Stores a sparse matrix in compressed sparse row format
+ *
+ * The nonzeros of row \a r are stored in positions
+ * getRowPtr()[r] through getRowPtr()[r+1]-1 of getColIndices() and
+ * getValues(), sorted by column.
+ *
+ * \example Morpheus_SellMatrix_Tests.cpp
+ * Demonstrates how to build a sparse matrix from coordinate lists
+ */
+class CsrMatrix : public LinearOperator {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Creates an empty (all zero) matrix
+   *
+   * If either nrows or ncols is not positive, the program terminates.
+   * \param[in] nrows Number of rows
+   * \param[in] ncols Number of columns
+   */
+  CsrMatrix(const int nrows, const int ncols);
+
+  /** \brief Converts a matrix in coordinate (COO) format
+   *
+   * Entry \a k of the matrix is (\a rowInd[k], \a colInd[k]) =
+   * \a vals[k].  The entries may be in any order; duplicates are
+   * summed.
+   * \param[in] nrows Number of rows
+   * \param[in] ncols Number of columns
+   * \param[in] nnz Number of coordinate entries
+   * \param[in] rowInd Row of each entry (0-based)
+   * \param[in] colInd Column of each entry (0-based)
+   * \param[in] vals Value of each entry
+   */
+  CsrMatrix(const int nrows, const int ncols, const int nnz,
+            const int* rowInd, const int* colInd, const double* vals);
+
+  /** \brief Copies a matrix that is already in CSR format
+   *
+   * The columns within each row are sorted if they are not already.
+   * \param[in] nrows Number of rows
+   * \param[in] ncols Number of columns
+   * \param[in] rowPtr Start of each row, with \a nrows + 1 entries
+   * \param[in] colInd Column of each nonzero (0-based)
+   * \param[in] vals Value of each nonzero
+   */
+  CsrMatrix(const int nrows, const int ncols, const int* rowPtr,
+            const int* colInd, const double* vals);
+  ///@}
+
+  //! \name Accessor functions
+  ///@{
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+
+  //! Returns the number of stored nonzeros
+  int getNumEntries() const;
+
+  //! Returns the number of nonzeros in row \a row
+  int getRowLength(const int row) const;
+
+  //! Returns the start of each row (\a nrows + 1 entries)
+  const int* getRowPtr() const;
+
+  //! Returns the column of each nonzero
+  const int* getColIndices() const;
+
+  //! Returns the value of each nonzero
+  const double* getValues() const;
+
+  /** \brief Returns the value of each nonzero, for modification
+   *
+   * Changing the values does not change the sparsity pattern.
+   */
+  double* getValues();
+  ///@}
+
+  //! \name Reordering
+  ///@{
+  /** \brief Applies a symmetric permutation in place
+   *
+   * Replaces the matrix by P * A * P^T, where row \a i of P is row
+   * \a perm[i] of the identity: entry (\a i, \a j) becomes the old
+   * entry (\a perm[i], \a perm[j]).  Vectors multiplied by the
+   * permuted matrix must be permuted the same way (Vector::permute).
+   * If the matrix is not square, the program terminates.
+   * \param[in] perm A permutation of 0, ..., getNumRows()-1
+   */
+  void permute(const int* perm);
+
+  /** \brief Returns the bandwidth
+   *
+   * This is the largest |\a row - \a col| of any stored entry.
+   */
+  int getBandwidth() const;
+
+  /** \brief Returns the profile (envelope size) of the lower triangle
+   *
+   * This is the sum over the rows of the distance from the first
+   * stored entry to the diagonal.  Orderings that keep each row's
+   * neighbours close give a small profile.
+   */
+  long getProfile() const;
+  ///@}
+
+  //! \name Multiplication routines
+  ///@{
+  /** \brief Computes a matrix-vector multiplication
+   *
+   * \param[in] X vector to be multiplied
+   * \param[out] Y result of multiplication
+   *
+   * \note The number of rows of the matrix must equal the number of
+   * entries in \a Y, and the number of columns must equal the number
+   * of entries in \a X.  Otherwise, the program will terminate.
+   */
+  void multiply(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes \a Y = \a alpha * op(\a this) * \a X + \a beta * \a Y
+   *
+   * Works exactly like Matrix::gemv.  The transposed product scatters
+   * into \a Y and is much slower than the plain one.
+   */
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  ///@}
+
+  //! \name I/O functions
+  ///@{
+  /** \brief Prints the nonzeros to console
+   *
+   * Example:
+   * <tt>\n
+   * 3x3 CsrMatrix with 2 nonzeros\n
+   * (0,0) = 1\n
+   * (2,1) = 5\n
+   * </tt>
+   */
+  void print() const;
+  ///@}
+
+private:
+  //! Sorts the columns within each row and sums duplicates
+  void sortRows();
+
+  //! Number of rows
+  int nrows_;
+  //! Number of columns
+  int ncols_;
+  //! Start of each row
+  std::vector<int> rowPtr_;
+  //! Column of each nonzero
+  std::vector<int> colInd_;
+  //! Value of each nonzero
+  std::vector<double> vals_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_CSRMATRIX_H_ */
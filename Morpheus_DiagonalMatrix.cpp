@@ -0,0 +1,140 @@
+/**
+ * @file
+ * \brief Defines a DiagonalMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_DiagonalMatrix.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+namespace Morpheus {
+
+DiagonalMatrix::DiagonalMatrix(const int n) :
+  diag_(n)
+{
+}
+
+
+DiagonalMatrix::DiagonalMatrix(const Matrix& A) :
+  diag_(A.getNumRows())
+{
+  // Make sure the matrix is square
+  assert(A.getNumRows() == A.getNumCols());
+
+  for(int i=0; i<diag_.getNumElements(); i++)
+    diag_[i] = A(i,i);
+}
+
+
+double& DiagonalMatrix::operator()(const int i)
+{
+  return diag_[i];
+}
+
+
+const double& DiagonalMatrix::operator()(const int i) const
+{
+  return diag_[i];
+}
+
+
+int DiagonalMatrix::getNumRows() const
+{
+  return diag_.getNumElements();
+}
+
+
+int DiagonalMatrix::getNumCols() const
+{
+  return diag_.getNumElements();
+}
+
+
+void DiagonalMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void DiagonalMatrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void DiagonalMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void DiagonalMatrix::gemv(const double alpha, const Vector& X,
+                          const double beta, Vector& Y,
+                          const bool transpose) const
+{
+  const int n = diag_.getNumElements();
+
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == n);
+  assert(Y.getNumElements() == n);
+  (void)transpose;
+
+  const double* d = &diag_[0];
+  const double* x = &X[0];
+  double* y = &Y[0];
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<n; i++)
+    y[i] = (beta == 0) ? alpha*d[i]*x[i] : alpha*d[i]*x[i] + beta*y[i];
+}
+
+
+void DiagonalMatrix::solve(const Vector& B, Vector& X) const
+{
+  const int n = diag_.getNumElements();
+
+  // Make sure the dimensions are consistent
+  assert(B.getNumElements() == n);
+  assert(X.getNumElements() == n);
+
+  const double* d = &diag_[0];
+  const double* b = &B[0];
+  double* x = &X[0];
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<n; i++)
+    x[i] = b[i] / d[i];
+}
+
+
+// Maximum absolute column sum
+double DiagonalMatrix::norm1() const
+{
+  return diag_.normInf();
+}
+
+
+// Maximum absolute row sum
+double DiagonalMatrix::normInf() const
+{
+  return diag_.normInf();
+}
+
+
+void DiagonalMatrix::print() const
+{
+  // Formatted in one buffer, as in BandedMatrix::print
+  std::ostringstream out;
+  out.copyfmt(std::cout);
+  out << getNumRows() << "x" << getNumCols() << " DiagonalMatrix\n";
+  for(int i=0; i<diag_.getNumElements(); i++)
+  {
+    out << "(" << i << "," << i << ") = " << diag_[i] << '\n';
+  }
+  std::cout << out.str() << std::flush;
+}
+
+} /* namespace Morpheus */
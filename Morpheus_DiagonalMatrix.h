@@ -0,0 +1,119 @@
+/**
+ * @file
+ * \brief Defines a DiagonalMatrix class
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_DIAGONALMATRIX_H_
+#define MORPHEUS_DIAGONALMATRIX_H_
+
+#include "Morpheus_Matrix.h"
+
+namespace Morpheus {
+
+/** \class DiagonalMatrix
+ * \brief Stores a square diagonal matrix
+ *
+ * Only the diagonal is stored, so every operation is O(n).
+ *
+ * \example Morpheus_DiagonalMatrix_Tests.cpp
+ * Demonstrates the usage of the diagonal matrix class
+ */
+class DiagonalMatrix : public LinearOperator {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Constructor
+   *
+   * Allocates memory for an \a n x \a n diagonal matrix.
+   * If \a n is not positive, the program terminates.
+   * \param[in] n Number of rows and columns
+   */
+  DiagonalMatrix(const int n);
+
+  /** \brief Converts a dense matrix
+   *
+   * Copies the diagonal of \a A; the rest of \a A is ignored.  Use
+   * BandedMatrix::detectBandwidth to check that \a A really is
+   * diagonal.  If \a A is not square, the program terminates.
+   * \param[in] A Dense matrix to convert
+   */
+  DiagonalMatrix(const Matrix& A);
+  ///@}
+
+  //! \name Accessor functions
+  ///@{
+  /** \brief Accesses a diagonal entry
+   *
+   * \param[in] i Row and column of the entry (0-based)
+   */
+  double& operator()(const int i);
+
+  /** \brief Reads a diagonal entry
+   *
+   * \param[in] i Row and column of the entry (0-based)
+   */
+  const double& operator()(const int i) const;
+
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+  ///@}
+
+  //! \name Multiplication routines
+  ///@{
+  /** \brief Computes a matrix-vector multiplication
+   *
+   * \param[in] X vector to be multiplied
+   * \param[out] Y result of multiplication
+   */
+  void multiply(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes \a Y = \a alpha * \a this * \a X + \a beta * \a Y
+   *
+   * Works exactly like Matrix::gemv; a diagonal matrix is its own
+   * transpose, so \a transpose has no effect.
+   */
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+
+  /** \brief Solves \a this * \a X = \a B
+   *
+   * \param[in] B right-hand side
+   * \param[out] X solution.  May be the same vector as \a B.
+   */
+  void solve(const Vector& B, Vector& X) const;
+  ///@}
+
+  //! \name Norms
+  ///@{
+
+  //! Maximum absolute column sum, which is the largest magnitude entry
+  double norm1() const;
+
+  //! Maximum absolute row sum, which is the largest magnitude entry
+  double normInf() const;
+  ///@}
+
+  //! \name I/O functions
+  ///@{
+  //! Prints the diagonal to console
+  void print() const;
+  ///@}
+
+private:
+  //! The diagonal entries
+  Vector diag_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_DIAGONALMATRIX_H_ */
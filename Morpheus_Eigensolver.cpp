@@ -0,0 +1,729 @@
+/**
+ * @file
+ * \brief Defines a Krylov eigensolver
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Eigensolver.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace Morpheus {
+
+typedef std::complex<double> Complex;
+
+// Computes all eigenpairs of a small symmetric matrix A (m x m,
+// column-major) with the cyclic Jacobi method.  Column i of Y is the
+// eigenvector of theta[i].  T and V are m x m workspace.
+static void symmetricEigen(const int m, const std::vector<double>& A,
+                           std::vector<Complex>& theta,
+                           std::vector<Complex>& Y,
+                           std::vector<double>& T, std::vector<double>& V)
+{
+  for(int k=0; k<m*m; k++)
+  {
+    T[k] = A[k];
+    V[k] = 0;
+  }
+  for(int i=0; i<m; i++)
+    V[i+i*m] = 1;
+
+  // Sweep until no off-diagonal entry is significant
+  bool rotated = true;
+  for(int sweep=0; sweep<100 && rotated; sweep++)
+  {
+    rotated = false;
+    for(int p=0; p<m-1; p++)
+    {
+      for(int q=p+1; q<m; q++)
+      {
+        double apq = T[p+q*m];
+        if(std::abs(apq) <= DBL_EPSILON*std::sqrt(std::abs(T[p+p*m]*T[q+q*m])) ||
+           apq == 0)
+        {
+          T[p+q*m] = T[q+p*m] = 0;
+          continue;
+        }
+        rotated = true;
+
+        // Rotation that zeroes T(p,q)
+        double tau = (T[q+q*m] - T[p+p*m]) / (2*apq);
+        double t = (tau >= 0 ? 1 : -1) / (std::abs(tau) + std::sqrt(1 + tau*tau));
+        double c = 1 / std::sqrt(1 + t*t);
+        double s = t*c;
+
+        for(int k=0; k<m; k++)
+        {
+          double tkp = T[k+p*m], tkq = T[k+q*m];
+          T[k+p*m] = c*tkp - s*tkq;
+          T[k+q*m] = s*tkp + c*tkq;
+        }
+        for(int k=0; k<m; k++)
+        {
+          double tpk = T[p+k*m], tqk = T[q+k*m];
+          T[p+k*m] = c*tpk - s*tqk;
+          T[q+k*m] = s*tpk + c*tqk;
+        }
+        for(int k=0; k<m; k++)
+        {
+          double vkp = V[k+p*m], vkq = V[k+q*m];
+          V[k+p*m] = c*vkp - s*vkq;
+          V[k+q*m] = s*vkp + c*vkq;
+        }
+      }
+    }
+  }
+
+  for(int i=0; i<m; i++)
+  {
+    theta[i] = T[i+i*m];
+    for(int k=0; k<m; k++)
+      Y[k+i*m] = V[k+i*m];
+  }
+}
+
+
+// Computes all eigenpairs of a small upper Hessenberg matrix H (m x m,
+// column-major) with the shifted complex QR algorithm.  The Schur form
+// T = Z^H * H * Z is upper triangular, and its eigenvectors are found
+// by back substitution.  Column i of Y is the unit eigenvector of
+// theta[i].  T and Z are m x m workspace, and work has 3*m entries.
+static void hessenbergEigen(const int m, const std::vector<double>& H,
+                            std::vector<Complex>& theta,
+                            std::vector<Complex>& Y,
+                            std::vector<Complex>& T, std::vector<Complex>& Z,
+                            std::vector<Complex>& work)
+{
+  double hnorm = 0;
+  for(int k=0; k<m*m; k++)
+  {
+    T[k] = H[k];
+    Z[k] = 0;
+    hnorm = std::max(hnorm, std::abs(H[k]));
+  }
+  for(int i=0; i<m; i++)
+    Z[i+i*m] = 1;
+
+  // Givens rotations of one QR step, and an eigenvector of T
+  Complex* cs = &work[0];
+  Complex* sn = cs + m;
+  Complex* y = sn + m;
+  int hi = m-1, iter = 0;
+  while(hi > 0 && iter < 100*m)
+  {
+    // Look for a negligible subdiagonal entry
+    int l = hi;
+    while(l > 0 && std::abs(T[l+(l-1)*m]) >
+          DBL_EPSILON*(std::abs(T[l-1+(l-1)*m]) + std::abs(T[l+l*m]) + DBL_MIN))
+      l--;
+    if(l > 0)
+      T[l+(l-1)*m] = 0;
+    if(l == hi)
+    {
+      hi--;
+      iter = 0;
+      continue;
+    }
+
+    // Wilkinson shift from the trailing 2x2 block, with an occasional
+    // exceptional shift to break cycles
+    Complex a = T[hi-1+(hi-1)*m], b = T[hi-1+hi*m];
+    Complex c = T[hi+(hi-1)*m], d = T[hi+hi*m];
+    Complex half = 0.5*(a + d);
+    Complex disc = std::sqrt(0.25*(a - d)*(a - d) + b*c);
+    Complex mu = (std::abs(half + disc - d) < std::abs(half - disc - d)) ?
+                 half + disc : half - disc;
+    if(iter % 11 == 10)
+      mu = d + std::abs(c);
+    iter++;
+
+    // One QR step on rows and columns l..hi, applied to all of T so
+    // that T stays similar to H
+    for(int k=l; k<=hi; k++)
+      T[k+k*m] -= mu;
+    for(int k=l; k<hi; k++)
+    {
+      Complex x = T[k+k*m], y = T[k+1+k*m];
+      double r = std::sqrt(std::norm(x) + std::norm(y));
+      Complex cr = (r == 0) ? 1.0 : x / r;
+      Complex sr = (r == 0) ? 0.0 : y / r;
+      cs[k-l] = cr;
+      sn[k-l] = sr;
+      for(int j=k; j<m; j++)
+      {
+        Complex tk = T[k+j*m], tk1 = T[k+1+j*m];
+        T[k+j*m] = std::conj(cr)*tk + std::conj(sr)*tk1;
+        T[k+1+j*m] = -sr*tk + cr*tk1;
+      }
+    }
+    for(int k=l; k<hi; k++)
+    {
+      Complex cr = cs[k-l], sr = sn[k-l];
+      int last = std::min(k+2, hi);
+      for(int i=0; i<=last; i++)
+      {
+        Complex tk = T[i+k*m], tk1 = T[i+(k+1)*m];
+        T[i+k*m] = tk*cr + tk1*sr;
+        T[i+(k+1)*m] = -tk*std::conj(sr) + tk1*std::conj(cr);
+      }
+      for(int i=0; i<m; i++)
+      {
+        Complex zk = Z[i+k*m], zk1 = Z[i+(k+1)*m];
+        Z[i+k*m] = zk*cr + zk1*sr;
+        Z[i+(k+1)*m] = -zk*std::conj(sr) + zk1*std::conj(cr);
+      }
+    }
+    for(int k=l; k<=hi; k++)
+      T[k+k*m] += mu;
+  }
+
+  // Eigenvectors of T, then of H
+  double small = DBL_EPSILON*(hnorm + DBL_MIN);
+  for(int i=0; i<m; i++)
+  {
+    theta[i] = T[i+i*m];
+    for(int j=0; j<m; j++)
+      y[j] = 0;
+    y[i] = 1;
+    for(int j=i-1; j>=0; j--)
+    {
+      Complex sum = 0;
+      for(int k=j+1; k<=i; k++)
+        sum += T[j+k*m]*y[k];
+      Complex denom = T[j+j*m] - theta[i];
+      if(std::abs(denom) < small)
+        denom = small;
+      y[j] = -sum / denom;
+    }
+
+    double norm = 0;
+    for(int r=0; r<m; r++)
+    {
+      Complex sum = 0;
+      for(int k=0; k<=i; k++)
+        sum += Z[r+k*m]*y[k];
+      Y[r+i*m] = sum;
+      norm += std::norm(sum);
+    }
+    norm = std::sqrt(norm);
+    for(int r=0; r<m; r++)
+      Y[r+i*m] /= norm;
+  }
+}
+
+
+// Applies the shifted QR step H <- Q^T H Q for the polynomial whose
+// roots are mu (and conj(mu) if pair is true), and accumulates Q.
+// H is upper Hessenberg, so H - mu*I has one subdiagonal and the
+// double shift polynomial two; each Householder reflector then only
+// spans that many rows and the step costs O(m^2) rather than O(m^3).
+// M and v are workspace.
+static void applyShift(const int m, std::vector<double>& H,
+                       std::vector<double>& Q, const Complex mu,
+                       const bool pair, std::vector<double>& M,
+                       std::vector<double>& v)
+{
+  const int width = pair ? 2 : 1;
+
+  // M = H - mu*I, or (H - mu*I)(H - conj(mu)*I), which is real
+  for(int j=0; j<m; j++)
+  {
+    for(int i=0; i<m; i++)
+    {
+      if(i > j+width)
+      {
+        M[i+j*m] = 0;
+      }
+      else if(pair)
+      {
+        double sum = 0;
+        int kbegin = (i > 0) ? i-1 : 0;
+        int kend = (j+1 < m) ? j+1 : m-1;
+        for(int k=kbegin; k<=kend; k++)
+          sum += H[i+k*m]*H[k+j*m];
+        M[i+j*m] = sum - 2*mu.real()*H[i+j*m];
+        if(i == j) M[i+j*m] += std::norm(mu);
+      }
+      else
+      {
+        M[i+j*m] = H[i+j*m] - ((i == j) ? mu.real() : 0);
+      }
+    }
+  }
+
+  // Householder QR of M; every reflector is applied to H on both sides
+  for(int c=0; c<m-1; c++)
+  {
+    const int last = (c+width < m) ? c+width : m-1;
+    double xnorm = 0;
+    for(int i=c; i<=last; i++)
+      xnorm += M[i+c*m]*M[i+c*m];
+    xnorm = std::sqrt(xnorm);
+    if(xnorm == 0)
+      continue;
+
+    double alpha = (M[c+c*m] > 0) ? -xnorm : xnorm;
+    double vnorm2 = 0;
+    for(int i=c; i<=last; i++)
+    {
+      v[i] = M[i+c*m] - ((i == c) ? alpha : 0);
+      vnorm2 += v[i]*v[i];
+    }
+    if(vnorm2 == 0)
+      continue;
+
+    // Rows c..last of M and H
+    for(int j=0; j<m; j++)
+    {
+      double dotM = 0, dotH = 0;
+      for(int i=c; i<=last; i++)
+      {
+        dotM += v[i]*M[i+j*m];
+        dotH += v[i]*H[i+j*m];
+      }
+      dotM *= 2/vnorm2;
+      dotH *= 2/vnorm2;
+      for(int i=c; i<=last; i++)
+      {
+        M[i+j*m] -= dotM*v[i];
+        H[i+j*m] -= dotH*v[i];
+      }
+    }
+
+    // Columns c..last of H and Q
+    for(int i=0; i<m; i++)
+    {
+      double dotH = 0, dotQ = 0;
+      for(int j=c; j<=last; j++)
+      {
+        dotH += H[i+j*m]*v[j];
+        dotQ += Q[i+j*m]*v[j];
+      }
+      dotH *= 2/vnorm2;
+      dotQ *= 2/vnorm2;
+      for(int j=c; j<=last; j++)
+      {
+        H[i+j*m] -= dotH*v[j];
+        Q[i+j*m] -= dotQ*v[j];
+      }
+    }
+  }
+}
+
+
+// Orders Ritz values, best first
+struct RitzOrder {
+  const std::vector<Complex>* theta;
+  EigenTarget target;
+  bool operator()(const int a, const int b) const
+  {
+    const Complex& ta = (*theta)[a];
+    const Complex& tb = (*theta)[b];
+    if(target == EIG_LARGEST_MAGNITUDE)
+      return std::abs(ta) > std::abs(tb);
+    if(target == EIG_LARGEST_REAL)
+      return ta.real() > tb.real();
+    return ta.real() < tb.real();
+  }
+};
+
+
+Eigensolver::Eigensolver(const LinearOperator& A, const bool symmetric,
+                         const int nev, const int ncv)
+  : A_(A)
+{
+  assert(A_.getNumRows() == A_.getNumCols());
+
+  const int n = A_.getNumRows();
+  n_ = n;
+  symmetric_ = symmetric;
+  nev_ = nev;
+  ncv_ = (ncv > 0) ? ncv : std::min(std::max(2*nev+1, 20), n);
+
+  // Make sure the sizes make sense
+  assert(n_ > 0);
+  assert(nev_ > 0 && nev_ <= ncv_ && ncv_ <= n_);
+  assert(nev_ < ncv_ || ncv_ == n_);
+
+  basis_ = new Vector*[ncv_+1];
+  for(int j=0; j<=ncv_; j++)
+    basis_[j] = new Vector(n_);
+
+  H_.assign(ncv_*ncv_, 0);
+  basisData_.assign(ncv_+1, NULL);
+  coef_.assign(ncv_+1, 0);
+  ritzValues_.assign(nev_, 0.0);
+  ritzVectors_.assign(ncv_*nev_, 0.0);
+  residuals_.assign(nev_, 0);
+  fnorm_ = 0;
+  numApplies_ = 0;
+  numRestarts_ = 0;
+  seed_ = 1;
+}
+
+
+Eigensolver::~Eigensolver()
+{
+  for(int j=0; j<=ncv_; j++)
+    delete basis_[j];
+  delete[] basis_;
+}
+
+
+void Eigensolver::randomize(const int j)
+{
+  double* v = &(*basis_[j])[0];
+  unsigned seed = seed_++;
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<n_; i++)
+  {
+    unsigned x = (unsigned)i*2654435761u + seed*40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    v[i] = (double)(x % 2000001) / 1000000 - 1;
+  }
+}
+
+
+double Eigensolver::orthogonalize(Vector& w, const int count, double* h)
+{
+  // Detach w once, before the threads start; the basis is only read
+  double* x = &w[0];
+  const double** v = &basisData_[0];
+  double* coef = &coef_[0];
+  for(int j=0; j<count; j++)
+    v[j] = &static_cast<const Vector&>(*basis_[j])[0];
+
+  double inputNorm2 = 0;
+  for(int pass=0; pass<2; pass++)
+  {
+    // coef = V^T * w, and ||w||^2, in one sweep over the basis...
+    for(int j=0; j<count; j++)
+      coef[j] = 0;
+    inputNorm2 = 0;
+    #pragma omp parallel for schedule(static) reduction(+:coef[:count]) \
+                                             reduction(+:inputNorm2)
+    for(int i=0; i<n_; i++)
+    {
+      double xi = x[i];
+      inputNorm2 += xi*xi;
+      for(int j=0; j<count; j++)
+        coef[j] += v[j][i]*xi;
+    }
+
+    // ...and w -= V * coef in another
+    #pragma omp parallel for schedule(static)
+    for(int i=0; i<n_; i++)
+    {
+      double sum = 0;
+      for(int j=0; j<count; j++)
+        sum += v[j][i]*coef[j];
+      x[i] -= sum;
+    }
+
+    if(h)
+    {
+      for(int j=0; j<count; j++)
+        h[j] += coef[j];
+    }
+  }
+
+  // If the second pass still removed most of w, what is left is
+  // rounding error and need not be orthogonal to the basis; w is in
+  // its span to working precision (Kahan and Parlett's "twice is
+  // enough")
+  double norm = w.norm2();
+  if(norm*norm < 0.5*inputNorm2)
+  {
+    w.scale(0);
+    norm = 0;
+  }
+  return norm;
+}
+
+
+void Eigensolver::extend(const int k)
+{
+  const int m = ncv_;
+
+  for(int j=k; j<m; j++)
+  {
+    if(j > 0)
+    {
+      // The residual becomes the next basis vector.  If it vanished,
+      // the basis spans an invariant subspace; continue with a fresh
+      // direction, which decouples from what came before.
+      double colNorm = fnorm_*fnorm_;
+      for(int i=0; i<j; i++)
+        colNorm += H_[i+(j-1)*m]*H_[i+(j-1)*m];
+      colNorm = std::sqrt(colNorm);
+
+      std::swap(basis_[j], basis_[m]);
+      double norm = fnorm_;
+      H_[j+(j-1)*m] = fnorm_;
+      if(fnorm_ <= 1e-12*colNorm)
+      {
+        H_[j+(j-1)*m] = 0;
+        randomize(j);
+        norm = orthogonalize(*basis_[j], j, NULL);
+      }
+      basis_[j]->scale(1 / norm);
+    }
+
+    // w = A * v_j, orthogonalized against the basis
+    A_.apply(*basis_[j], *basis_[m]);
+    numApplies_++;
+    for(int i=0; i<=j; i++)
+      H_[i+j*m] = 0;
+    fnorm_ = orthogonalize(*basis_[m], j+1, &H_[j*m]);
+
+    // In exact arithmetic a symmetric H is tridiagonal; the other
+    // coefficients are only rounding errors
+    if(symmetric_)
+    {
+      for(int i=0; i<j-1; i++)
+        H_[i+j*m] = 0;
+      if(j > 0)
+        H_[j-1+j*m] = H_[j+(j-1)*m];
+    }
+  }
+}
+
+
+void Eigensolver::rotateBasis(const std::vector<double>& Q, const int k)
+{
+  const int m = ncv_;
+
+  // Detach the k vectors that are written before the threads start;
+  // the rest are only read
+  std::vector<double*> out(k);
+  std::vector<const double*> in(m);
+  for(int j=0; j<k; j++)
+    out[j] = &(*basis_[j])[0];
+  for(int l=0; l<m; l++)
+    in[l] = &static_cast<const Vector&>(*basis_[l])[0];
+
+  #pragma omp parallel
+  {
+    std::vector<double> row(m);
+
+    #pragma omp for schedule(static)
+    for(int i=0; i<n_; i++)
+    {
+      for(int l=0; l<m; l++)
+        row[l] = in[l][i];
+      for(int j=0; j<k; j++)
+      {
+        double sum = 0;
+        for(int l=0; l<m; l++)
+          sum += row[l]*Q[l+j*m];
+        out[j][i] = sum;
+      }
+    }
+  }
+}
+
+
+int Eigensolver::solve(const EigenTarget target, const double tol,
+                       const int maxRestarts)
+{
+  const int m = ncv_;
+  const double eps23 = std::pow(DBL_EPSILON, 2.0/3);
+
+  // Workspace for the small problems, allocated once
+  std::vector<Complex> theta(m), Y(m*m);
+  std::vector<double> Q(m*m), M(m*m), v(m);
+  std::vector<int> order(m);
+  std::vector<bool> used(m);
+  std::vector<Complex> T(symmetric_ ? 0 : m*m), Z(symmetric_ ? 0 : m*m);
+  std::vector<Complex> work(symmetric_ ? 0 : 3*m);
+
+  // Start from a pseudo-random unit vector
+  randomize(0);
+  basis_[0]->scale(1 / basis_[0]->norm2());
+  H_.assign(m*m, 0);
+  extend(0);
+
+  int nconv = 0;
+  for(numRestarts_=0; ; numRestarts_++)
+  {
+    // Ritz pairs and their residuals ||A*x - theta*x|| = fnorm*|y(m-1)|
+    if(symmetric_)
+      symmetricEigen(m, H_, theta, Y, M, Q);
+    else
+      hessenbergEigen(m, H_, theta, Y, T, Z, work);
+
+    for(int i=0; i<m; i++)
+      order[i] = i;
+    RitzOrder better = { &theta, target };
+    std::stable_sort(order.begin(), order.end(), better);
+
+    nconv = 0;
+    for(int i=0; i<nev_; i++)
+    {
+      int idx = order[i];
+      ritzValues_[i] = theta[idx];
+      residuals_[i] = fnorm_ * std::abs(Y[m-1+idx*m]);
+      for(int r=0; r<m; r++)
+        ritzVectors_[r+i*m] = Y[r+idx*m];
+      if(residuals_[i] <= tol * std::max(std::abs(theta[idx]), eps23))
+        nconv++;
+    }
+    if(nconv == nev_ || numRestarts_ == maxRestarts || m == n_)
+      break;
+
+    // Keep nev vectors plus some of the converged ones, which speeds up
+    // convergence of the rest (as ARPACK does), without splitting a
+    // complex conjugate pair
+    int k = nev_ + std::min(nconv, (m - nev_) / 2);
+    if(k >= m)
+      k = m-1;
+    if(!symmetric_ && k < m-1)
+    {
+      Complex last = theta[order[k-1]];
+      if(std::abs(last.imag()) > eps23*std::abs(last) &&
+         std::abs(theta[order[k]] - std::conj(last)) <= eps23*std::abs(last))
+        k++;
+    }
+
+    // Filter out the unwanted Ritz values with implicit shifts
+    for(int i=0; i<m*m; i++)
+      Q[i] = 0;
+    for(int i=0; i<m; i++)
+      Q[i+i*m] = 1;
+    std::fill(used.begin(), used.end(), false);
+    for(int s=k; s<m; s++)
+    {
+      if(used[s])
+        continue;
+      Complex mu = theta[order[s]];
+      bool pair = false;
+      if(!symmetric_ && std::abs(mu.imag()) > eps23*std::abs(mu))
+      {
+        // Use the conjugate as well, so the arithmetic stays real
+        for(int t=s+1; t<m; t++)
+        {
+          if(!used[t] && std::abs(theta[order[t]] - std::conj(mu)) <=
+             1e-6*std::abs(mu))
+          {
+            used[t] = true;
+            pair = true;
+            break;
+          }
+        }
+      }
+      applyShift(m, H_, Q, mu, pair, M, v);
+    }
+
+    // Clean up the rounding errors below the subdiagonal, and above the
+    // superdiagonal if symmetric
+    for(int j=0; j<m; j++)
+    {
+      for(int i=j+2; i<m; i++)
+        H_[i+j*m] = 0;
+      if(symmetric_)
+      {
+        for(int i=0; i<j-1; i++)
+          H_[i+j*m] = 0;
+        if(j > 0)
+          H_[j-1+j*m] = H_[j+(j-1)*m] = 0.5*(H_[j-1+j*m] + H_[j+(j-1)*m]);
+      }
+    }
+
+    // The new residual is v_k * H(k,k-1) + f * Q(m-1,k-1)
+    rotateBasis(Q, k+1);
+    basis_[m]->axpby(H_[k+(k-1)*m], *basis_[k], Q[m-1+(k-1)*m]);
+    fnorm_ = basis_[m]->norm2();
+
+    for(int j=0; j<m; j++)
+    {
+      for(int i=0; i<m; i++)
+      {
+        if(i >= k || j >= k)
+          H_[i+j*m] = 0;
+      }
+    }
+    extend(k);
+  }
+
+  return nconv;
+}
+
+
+double Eigensolver::getEigenvalue(const int i) const
+{
+  assert(i >= 0 && i < nev_);
+  return ritzValues_[i].real();
+}
+
+
+double Eigensolver::getEigenvalueImag(const int i) const
+{
+  assert(i >= 0 && i < nev_);
+  return ritzValues_[i].imag();
+}
+
+
+void Eigensolver::getEigenvector(const int i, Vector& re) const
+{
+  assert(i >= 0 && i < nev_);
+  assert(re.getNumElements() == n_);
+
+  re.setValue(0);
+  for(int l=0; l<ncv_; l++)
+    re.axpy(ritzVectors_[l+i*ncv_].real(), *basis_[l]);
+}
+
+
+void Eigensolver::getEigenvector(const int i, Vector& re, Vector& im) const
+{
+  getEigenvector(i, re);
+
+  assert(im.getNumElements() == n_);
+  im.setValue(0);
+  for(int l=0; l<ncv_; l++)
+    im.axpy(ritzVectors_[l+i*ncv_].imag(), *basis_[l]);
+}
+
+
+double Eigensolver::getResidual(const int i) const
+{
+  assert(i >= 0 && i < nev_);
+  return residuals_[i];
+}
+
+
+int Eigensolver::getNumApplies() const
+{
+  return numApplies_;
+}
+
+
+int Eigensolver::getNumRestarts() const
+{
+  return numRestarts_;
+}
+
+
+
+// Square root of the largest eigenvalue of A^T*A
+double estimateNorm2(const LinearOperator& A, const double tol)
+{
+  TransposeOperator At(A);
+  ProductOperator AtA(At, A);
+
+  // A relative error of tol in the eigenvalue is only tol/2 in its
+  // square root
+  Eigensolver solver(AtA, true, 1);
+  solver.solve(EIG_LARGEST_REAL, tol);
+
+  double lambda = solver.getEigenvalue(0);
+  return (lambda > 0) ? std::sqrt(lambda) : 0;
+}
+
+} /* namespace Morpheus */
@@ -0,0 +1,190 @@
+/**
+ * @file
+ * \brief Defines a Krylov eigensolver
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_EIGENSOLVER_H_
+#define MORPHEUS_EIGENSOLVER_H_
+
+#include "Morpheus_LinearOperator.h"
+#include <complex>
+#include <vector>
+
+namespace Morpheus {
+
+/** \brief Which eigenvalues Eigensolver looks for */
+enum EigenTarget {
+  //! Largest |lambda|
+  EIG_LARGEST_MAGNITUDE,
+  //! Largest real part
+  EIG_LARGEST_REAL,
+  //! Smallest real part
+  EIG_SMALLEST_REAL
+};
+
+/** \class Eigensolver
+ * \brief Computes a few extremal eigenpairs of a square operator
+ *
+ * The operator is only ever applied to vectors, so it can be any
+ * LinearOperator: a stored matrix of any format, a matrix-free
+ * stencil, or a composition such as a ShiftedOperator.
+ *
+ * Symmetric operators use the Lanczos process with full
+ * reorthogonalization; other operators use the Arnoldi process.
+ * Either way the Krylov basis is kept to at most \a ncv vectors by
+ * implicit restarts with the unwanted Ritz values as shifts (as in
+ * ARPACK), so \a ncv + 1 vectors of length \a n are all the memory the
+ * solver needs.  They are allocated in the constructor; solve only
+ * allocates O(\a ncv^2) workspace for the projected problem.
+ *
+ * Eigenvalues of a nonsymmetric operator may be complex.  They are
+ * returned with their real and imaginary parts, and eigenvectors with
+ * their real and imaginary parts.
+ *
+ * \example Morpheus_Eigensolver_Tests.cpp
+ * Demonstrates the usage of the eigensolver
+ */
+class Eigensolver {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Sets up a solver for an operator
+   *
+   * \param[in] A The operator.  It must stay alive until the solver is
+   * done with it.  If it is not square, the program terminates.
+   * \param[in] symmetric Whether the operator is symmetric
+   * \param[in] nev Number of eigenpairs wanted
+   * \param[in] ncv Largest Krylov basis.  0 chooses max(2*\a nev+1, 20),
+   * capped at n.  Otherwise \a nev < \a ncv <= n, or the program
+   * terminates.
+   */
+  Eigensolver(const LinearOperator& A, const bool symmetric, const int nev,
+              const int ncv=0);
+
+  /** \brief Destructor
+   *
+   * Deallocates memory allocated in the constructor
+   */
+  ~Eigensolver();
+  ///@}
+
+  //! \name Solution
+  ///@{
+  /** \brief Computes the wanted eigenpairs
+   *
+   * \param[in] target Which eigenvalues are wanted
+   * \param[in] tol An eigenpair (\a lambda, \a x) with unit \a x has
+   * converged once ||A*\a x - \a lambda*\a x|| <= \a tol * |\a lambda|
+   * \param[in] maxRestarts Largest number of restarts
+   *
+   * Returns the number of wanted eigenpairs that converged.  The
+   * others are still returned, as the best approximations found.
+   */
+  int solve(const EigenTarget target=EIG_LARGEST_MAGNITUDE,
+            const double tol=1e-8, const int maxRestarts=300);
+
+  //! Returns the real part of eigenvalue \a i, 0 <= \a i < \a nev
+  double getEigenvalue(const int i) const;
+
+  //! Returns the imaginary part of eigenvalue \a i (0 if symmetric)
+  double getEigenvalueImag(const int i) const;
+
+  /** \brief Returns eigenvector \a i, scaled to unit length
+   *
+   * \param[in] i Which eigenvector
+   * \param[out] re Its real part
+   */
+  void getEigenvector(const int i, Vector& re) const;
+
+  /** \brief Returns eigenvector \a i of a nonsymmetric operator
+   *
+   * \param[in] i Which eigenvector
+   * \param[out] re Its real part
+   * \param[out] im Its imaginary part
+   */
+  void getEigenvector(const int i, Vector& re, Vector& im) const;
+
+  //! Returns the residual norm estimate of eigenpair \a i
+  double getResidual(const int i) const;
+
+  //! Returns the number of times the operator was applied
+  int getNumApplies() const;
+
+  //! Returns the number of restarts used by the last solve
+  int getNumRestarts() const;
+  ///@}
+
+private:
+  //! Copying is not supported
+  Eigensolver(const Eigensolver&);
+  //! Copying is not supported
+  Eigensolver& operator=(const Eigensolver&);
+
+  //! Fills basis vector \a j with a pseudo-random vector
+  void randomize(const int j);
+
+  /** \brief Orthogonalizes \a w against basis vectors 0..\a count-1
+   *
+   * Uses two passes of classical Gram-Schmidt.  Each pass computes all
+   * the coefficients V^T * \a w in one sweep over the basis and
+   * subtracts V times them in another, instead of one sweep per basis
+   * vector.  If the second pass still shrinks \a w by more than a
+   * factor of sqrt(2), \a w lies in the span of the basis to working
+   * precision and is set to 0.  The coefficients are added to \a h
+   * (if not NULL), and the final norm of \a w is returned.
+   */
+  double orthogonalize(Vector& w, const int count, double* h);
+
+  //! Extends the Krylov factorization from \a k to \a ncv vectors
+  void extend(const int k);
+
+  //! Replaces basis vectors 0..\a k-1 by \a V * \a Q(:,0..\a k-1)
+  void rotateBasis(const std::vector<double>& Q, const int k);
+
+  //! Operator
+  const LinearOperator& A_;
+  //! Dimension of the operator
+  int n_;
+  //! Whether the operator is symmetric
+  bool symmetric_;
+  //! Number of wanted eigenpairs
+  int nev_;
+  //! Largest Krylov basis
+  int ncv_;
+  //! Krylov basis (ncv_ vectors) and the residual vector (last)
+  Vector** basis_;
+  //! Norm of the residual vector
+  double fnorm_;
+  //! Projected matrix, ncv_ x ncv_, column-major
+  std::vector<double> H_;
+  //! Entries of each basis vector, filled in by orthogonalize
+  std::vector<const double*> basisData_;
+  //! Gram-Schmidt coefficients of one pass
+  std::vector<double> coef_;
+  //! Ritz values, best first
+  std::vector<std::complex<double> > ritzValues_;
+  //! Coordinates of the Ritz vectors in the basis, ncv_ x nev_
+  std::vector<std::complex<double> > ritzVectors_;
+  //! Residual estimate of each Ritz pair
+  std::vector<double> residuals_;
+  //! Number of applies so far
+  int numApplies_;
+  //! Number of restarts in the last solve
+  int numRestarts_;
+  //! Seed for the next pseudo-random vector
+  unsigned seed_;
+};
+
+/** \brief Estimates the 2-norm of an operator
+ *
+ * Runs Lanczos on A^T*A, which only needs products with A and A^T, so
+ * it works for any LinearOperator, including matrix-free ones.
+ * \param[in] A The operator
+ * \param[in] tol Relative accuracy of the result
+ */
+double estimateNorm2(const LinearOperator& A, const double tol=1e-8);
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_EIGENSOLVER_H_ */
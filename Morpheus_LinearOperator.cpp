@@ -0,0 +1,258 @@
+/**
+ * @file
+ * \brief Defines an abstract linear operator and ways to combine them
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_LinearOperator.h"
+#include <cassert>
+
+namespace Morpheus {
+
+LinearOperator::~LinearOperator()
+{
+
+}
+
+
+void LinearOperator::gemv(const double alpha, const Vector& X,
+                          const double beta, Vector& Y,
+                          const bool transpose) const
+{
+  if(beta == 0)
+  {
+    if(transpose)
+      applyTranspose(X, Y);
+    else
+      apply(X, Y);
+    if(alpha != 1)
+      Y.scale(alpha);
+    return;
+  }
+
+  Vector AX(Y.getNumElements(), ALLOC_UNTOUCHED);
+  if(transpose)
+    applyTranspose(X, AX);
+  else
+    apply(X, AX);
+  Y.axpby(alpha, AX, beta);
+}
+
+
+ScaledOperator::ScaledOperator(const LinearOperator& A, const double alpha)
+  : A_(A), alpha_(alpha)
+{
+
+}
+
+
+int ScaledOperator::getNumRows() const
+{
+  return A_.getNumRows();
+}
+
+
+int ScaledOperator::getNumCols() const
+{
+  return A_.getNumCols();
+}
+
+
+void ScaledOperator::apply(const Vector& X, Vector& Y) const
+{
+  A_.gemv(alpha_, X, 0, Y);
+}
+
+
+void ScaledOperator::applyTranspose(const Vector& X, Vector& Y) const
+{
+  A_.gemv(alpha_, X, 0, Y, true);
+}
+
+
+void ScaledOperator::gemv(const double alpha, const Vector& X,
+                          const double beta, Vector& Y,
+                          const bool transpose) const
+{
+  A_.gemv(alpha*alpha_, X, beta, Y, transpose);
+}
+
+
+ShiftedOperator::ShiftedOperator(const LinearOperator& A, const double sigma)
+  : A_(A), sigma_(sigma)
+{
+  assert(A_.getNumRows() == A_.getNumCols());
+}
+
+
+int ShiftedOperator::getNumRows() const
+{
+  return A_.getNumRows();
+}
+
+
+int ShiftedOperator::getNumCols() const
+{
+  return A_.getNumCols();
+}
+
+
+void ShiftedOperator::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void ShiftedOperator::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void ShiftedOperator::gemv(const double alpha, const Vector& X,
+                           const double beta, Vector& Y,
+                           const bool transpose) const
+{
+  A_.gemv(alpha, X, beta, Y, transpose);
+  Y.axpy(alpha*sigma_, X);
+}
+
+
+SumOperator::SumOperator(const LinearOperator& A, const LinearOperator& B)
+  : A_(A), B_(B), work_(B.getNumRows(), ALLOC_UNTOUCHED),
+    workTranspose_(B.getNumCols(), ALLOC_UNTOUCHED)
+{
+  assert(A_.getNumRows() == B_.getNumRows());
+  assert(A_.getNumCols() == B_.getNumCols());
+}
+
+
+int SumOperator::getNumRows() const
+{
+  return A_.getNumRows();
+}
+
+
+int SumOperator::getNumCols() const
+{
+  return A_.getNumCols();
+}
+
+
+void SumOperator::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void SumOperator::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void SumOperator::gemv(const double alpha, const Vector& X,
+                       const double beta, Vector& Y,
+                       const bool transpose) const
+{
+  // B_.gemv with beta = 1 would allocate in the default gemv
+  Vector& BX = transpose ? workTranspose_ : work_;
+  if(transpose)
+    B_.applyTranspose(X, BX);
+  else
+    B_.apply(X, BX);
+  A_.gemv(alpha, X, beta, Y, transpose);
+  Y.axpy(alpha, BX);
+}
+
+
+ProductOperator::ProductOperator(const LinearOperator& A,
+                                 const LinearOperator& B)
+  : A_(A), B_(B), work_(B.getNumRows())
+{
+  assert(A_.getNumCols() == B_.getNumRows());
+}
+
+
+int ProductOperator::getNumRows() const
+{
+  return A_.getNumRows();
+}
+
+
+int ProductOperator::getNumCols() const
+{
+  return B_.getNumCols();
+}
+
+
+void ProductOperator::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void ProductOperator::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void ProductOperator::gemv(const double alpha, const Vector& X,
+                           const double beta, Vector& Y,
+                           const bool transpose) const
+{
+  // (A*B)^T = B^T*A^T
+  if(transpose)
+  {
+    A_.applyTranspose(X, work_);
+    B_.gemv(alpha, work_, beta, Y, true);
+  }
+  else
+  {
+    B_.apply(X, work_);
+    A_.gemv(alpha, work_, beta, Y);
+  }
+}
+
+
+TransposeOperator::TransposeOperator(const LinearOperator& A)
+  : A_(A)
+{
+
+}
+
+
+int TransposeOperator::getNumRows() const
+{
+  return A_.getNumCols();
+}
+
+
+int TransposeOperator::getNumCols() const
+{
+  return A_.getNumRows();
+}
+
+
+void TransposeOperator::apply(const Vector& X, Vector& Y) const
+{
+  A_.applyTranspose(X, Y);
+}
+
+
+void TransposeOperator::applyTranspose(const Vector& X, Vector& Y) const
+{
+  A_.apply(X, Y);
+}
+
+
+void TransposeOperator::gemv(const double alpha, const Vector& X,
+                             const double beta, Vector& Y,
+                             const bool transpose) const
+{
+  A_.gemv(alpha, X, beta, Y, !transpose);
+}
+
+} /* namespace Morpheus */
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * \brief Defines an abstract linear operator and ways to combine them
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_LINEAROPERATOR_H_
+#define MORPHEUS_LINEAROPERATOR_H_
+
+#include "Morpheus_Vector.h"
+
+namespace Morpheus {
+
+/** \class LinearOperator
+ * \brief Anything that can be applied to a vector, with or without its
+ * entries stored
+ *
+ * Code that only needs products with an operator, such as Eigensolver
+ * and estimateNorm2, takes a LinearOperator, so it works unchanged on
+ * every matrix class in the library and on operators that never form
+ * their matrix at all.  A stencil, for instance, only has to say how
+ * many rows and columns it has and how to apply itself and its
+ * transpose:
+ * \code
+ * class Laplacian1D : public Morpheus::LinearOperator {
+ * public:
+ *   Laplacian1D(int n) : n_(n) { }
+ *   int getNumRows() const { return n_; }
+ *   int getNumCols() const { return n_; }
+ *   void apply(const Morpheus::Vector& X, Morpheus::Vector& Y) const
+ *   {
+ *     for(int i=0; i<n_; i++)
+ *       Y[i] = 2*X[i] - (i > 0 ? X[i-1] : 0) - (i < n_-1 ? X[i+1] : 0);
+ *   }
+ *   void applyTranspose(const Morpheus::Vector& X, Morpheus::Vector& Y) const
+ *   {
+ *     apply(X, Y);
+ *   }
+ * private:
+ *   int n_;
+ * };
+ * \endcode
+ *
+ * The classes below build new operators out of existing ones without
+ * storing anything but references to them.
+ *
+ * \example Morpheus_LinearOperator_Tests.cpp
+ * Demonstrates a matrix-free operator and the composed operators
+ */
+class LinearOperator {
+public:
+  //! Destructor
+  virtual ~LinearOperator();
+
+  //! Returns the number of rows
+  virtual int getNumRows() const = 0;
+
+  //! Returns the number of columns
+  virtual int getNumCols() const = 0;
+
+  /** \brief Computes \a Y = A * \a X
+   *
+   * \param[in] X One entry per column
+   * \param[out] Y One entry per row
+   */
+  virtual void apply(const Vector& X, Vector& Y) const = 0;
+
+  /** \brief Computes \a Y = A^T * \a X
+   *
+   * \param[in] X One entry per row
+   * \param[out] Y One entry per column
+   */
+  virtual void applyTranspose(const Vector& X, Vector& Y) const = 0;
+
+  /** \brief Computes \a Y = \a alpha * op(A) * \a X + \a beta * \a Y
+   *
+   * op(A) is A, or A^T if \a transpose is true.  If \a beta is 0, \a Y
+   * is not read.  The default implementation calls apply or
+   * applyTranspose, using a temporary vector unless \a beta is 0;
+   * the matrix classes override it with a single fused sweep.
+   */
+  virtual void gemv(const double alpha, const Vector& X, const double beta,
+                    Vector& Y, const bool transpose=false) const;
+};
+
+/** \class ScaledOperator
+ * \brief The operator \a alpha * A
+ *
+ * \a A must stay alive as long as the ScaledOperator.
+ */
+class ScaledOperator : public LinearOperator {
+public:
+  //! Constructor
+  ScaledOperator(const LinearOperator& A, const double alpha);
+
+  int getNumRows() const;
+  int getNumCols() const;
+  void apply(const Vector& X, Vector& Y) const;
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+private:
+  //! Operator being scaled
+  const LinearOperator& A_;
+  //! Scale factor
+  double alpha_;
+};
+
+/** \class ShiftedOperator
+ * \brief The operator A + \a sigma * I
+ *
+ * \a A must be square and stay alive as long as the ShiftedOperator.
+ */
+class ShiftedOperator : public LinearOperator {
+public:
+  //! Constructor
+  ShiftedOperator(const LinearOperator& A, const double sigma);
+
+  int getNumRows() const;
+  int getNumCols() const;
+  void apply(const Vector& X, Vector& Y) const;
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+private:
+  //! Operator being shifted
+  const LinearOperator& A_;
+  //! Shift
+  double sigma_;
+};
+
+/** \class SumOperator
+ * \brief The operator A + B
+ *
+ * \a A and \a B must have the same dimensions and stay alive as long
+ * as the SumOperator.  Applying it costs one product with each.  The
+ * product with \a B goes to a work vector allocated once, in the
+ * constructor, so operators without a fused gemv do not allocate one
+ * per application; one SumOperator must not be applied by several
+ * threads at once.
+ */
+class SumOperator : public LinearOperator {
+public:
+  //! Constructor
+  SumOperator(const LinearOperator& A, const LinearOperator& B);
+
+  int getNumRows() const;
+  int getNumCols() const;
+  void apply(const Vector& X, Vector& Y) const;
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+private:
+  //! Copying is not supported
+  SumOperator(const SumOperator&);
+  //! Copying is not supported
+  SumOperator& operator=(const SumOperator&);
+
+  //! First term
+  const LinearOperator& A_;
+  //! Second term
+  const LinearOperator& B_;
+  //! B*X
+  mutable Vector work_;
+  //! B^T*X
+  mutable Vector workTranspose_;
+};
+
+/** \class ProductOperator
+ * \brief The operator A * B
+ *
+ * The number of columns of \a A must equal the number of rows of \a B.
+ * Both must stay alive as long as the ProductOperator.  The
+ * intermediate vector is allocated once, in the constructor, so one
+ * ProductOperator must not be applied by several threads at once.
+ */
+class ProductOperator : public LinearOperator {
+public:
+  //! Constructor
+  ProductOperator(const LinearOperator& A, const LinearOperator& B);
+
+  int getNumRows() const;
+  int getNumCols() const;
+  void apply(const Vector& X, Vector& Y) const;
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+private:
+  //! Copying is not supported
+  ProductOperator(const ProductOperator&);
+  //! Copying is not supported
+  ProductOperator& operator=(const ProductOperator&);
+
+  //! Left factor
+  const LinearOperator& A_;
+  //! Right factor
+  const LinearOperator& B_;
+  //! B*X, or A^T*X for the transpose
+  mutable Vector work_;
+};
+
+/** \class TransposeOperator
+ * \brief The operator A^T
+ *
+ * \a A must stay alive as long as the TransposeOperator.
+ */
+class TransposeOperator : public LinearOperator {
+public:
+  //! Constructor
+  TransposeOperator(const LinearOperator& A);
+
+  int getNumRows() const;
+  int getNumCols() const;
+  void apply(const Vector& X, Vector& Y) const;
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+private:
+  //! Operator being transposed
+  const LinearOperator& A_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_LINEAROPERATOR_H_ */
@@ -6,13 +6,19 @@
  */
 
 #include "Morpheus_Matrix.h"
+#include "Morpheus_Backend.h"
+#include "Morpheus_Eigensolver.h"
+#include "Morpheus_Writer.h"
+#include <algorithm>
 #include <cassert>
+#include <atomic>
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 namespace Morpheus {
 
-Matrix::Matrix(const int nrows, const int ncols)
+Matrix::Matrix(const int nrows, const int ncols, const AllocPolicy policy)
 {
   nrows_ = nrows;
   ncols_ = ncols;
@@ -21,46 +27,194 @@ Matrix::Matrix(const int nrows, const int ncols)
   assert(nrows_ > 0);
   assert(ncols_ > 0);
 
-  // Allocate memory for the data
-  data_ = new double*[nrows_];
-  for(int r=0; r<nrows_; r++)
-    data_[r] = new double[ncols_];
+  // Allocate one block for all the entries; each row is touched
+  // by the thread that owns it in the kernels below
+  buffer_ = new SharedBuffer(nrows_, ncols_, policy);
+  values_ = buffer_->getData();
+}
+
+
+Matrix::Matrix(const Matrix& A)
+  : LinearOperator()
+{
+  nrows_ = A.nrows_;
+  ncols_ = A.ncols_;
+
+  // Share the entries until one of us writes them
+  buffer_ = A.buffer_->acquire();
+  values_ = A.values_;
+}
+
+
+Matrix& Matrix::operator=(const Matrix& A)
+{
+  // Acquire first, in case A shares our buffer
+  SharedBuffer* buffer = A.buffer_->acquire();
+  buffer_->release();
+
+  nrows_ = A.nrows_;
+  ncols_ = A.ncols_;
+  buffer_ = buffer;
+  values_ = A.values_;
+  return *this;
 }
 
 
 Matrix::~Matrix()
 {
-  // Free all the memory we allocated
-  for(int r=0; r<nrows_; r++)
-    delete[] data_[r];
+  // Free all the memory we allocated, if no copy still uses it
+  buffer_->release();
+}
 
-  delete[] data_;
+
+void Matrix::detach(const bool keepValues)
+{
+  buffer_ = buffer_->detach(keepValues);
+  values_ = buffer_->getData();
 }
 
 
 double& Matrix::operator()(const int row, const int col)
 {
-  return data_[row][col];
+  // The reference may be kept and written after a property is cached
+  detach();
+  buffer_->expose();
+  return values_[(std::size_t)row*ncols_ + col];
+}
+
+
+const double& Matrix::operator()(const int row, const int col) const
+{
+  return values_[(std::size_t)row*ncols_ + col];
 }
 
 
 void Matrix::multiply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void Matrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void Matrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+void Matrix::gemv(const double alpha, const Vector& X, const double beta,
+                  Vector& Y, const bool transpose) const
 {
   // Make sure the dimensions are consistent
-  assert(X.getNumElements() == ncols_);
-  assert(Y.getNumElements() == nrows_);
+  assert(X.getNumElements() == (transpose ? nrows_ : ncols_));
+  assert(Y.getNumElements() == (transpose ? ncols_ : nrows_));
 
-  for(int r=0; r<nrows_; r++)
+  getBackend().gemv(transpose, nrows_, ncols_, alpha, values_, ncols_,
+                    &X[0], beta, &Y[0]);
+}
+
+
+// Crossover size for Strassen-Winograd; 0 disables it
+std::atomic<int> Matrix::strassenCrossover_(0);
+
+
+// Conventional kernel: C = A*B, where A is m x k, B is k x n and
+// C is m x n, each stored row by row with the given leading dimension
+static void gemmKernel(const int m, const int n, const int k,
+                       const double* A, const std::size_t lda,
+                       const double* B, const std::size_t ldb,
+                       double* C, const std::size_t ldc)
+{
+  getBackend().gemm(m, n, k, 1, A, lda, B, ldb, 0, C, ldc);
+}
+
+
+// C = A + sign*B for h x h blocks
+static void addBlocks(const int h, const double* A, const std::size_t lda,
+                      const double* B, const std::size_t ldb, const double sign,
+                      double* C, const std::size_t ldc)
+{
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<h; r++)
   {
-    Y[r] = 0;
-    for(int c=0; c<ncols_; c++)
-    {
-      Y[r] = Y[r] + data_[r][c]*X[c];
-    }
+    for(int c=0; c<h; c++)
+      C[r*ldc + c] = A[r*lda + c] + sign * B[r*ldb + c];
   }
 }
 
 
+// C = A*B for n x n blocks using the Strassen-Winograd variant
+// (7 multiplications, 15 additions per level).  Each level uses three
+// h x h temporaries from the front of work and hands the rest of
+// work to the level below, so one buffer of about n^2 doubles serves
+// the whole recursion.
+static void strassenWinograd(const int n, const double* A, const std::size_t lda,
+                             const double* B, const std::size_t ldb,
+                             double* C, const std::size_t ldc,
+                             const int crossover, double* work)
+{
+  if(n <= crossover || n % 2 != 0)
+  {
+    gemmKernel(n, n, n, A, lda, B, ldb, C, ldc);
+    return;
+  }
+
+  const int h = n/2;
+  const double *A11 = A, *A12 = A + h, *A21 = A + h*lda, *A22 = A21 + h;
+  const double *B11 = B, *B12 = B + h, *B21 = B + h*ldb, *B22 = B21 + h;
+  double *C11 = C, *C12 = C + h, *C21 = C + h*ldc, *C22 = C21 + h;
+
+  double* X = work;
+  double* Y = X + (std::size_t)h*h;
+  double* Z = Y + (std::size_t)h*h;
+  double* next = Z + (std::size_t)h*h;
+
+  // C21 = P7 = (A11 - A21)*(B22 - B12)
+  addBlocks(h, A11, lda, A21, lda, -1, X, h);
+  addBlocks(h, B22, ldb, B12, ldb, -1, Y, h);
+  strassenWinograd(h, X, h, Y, h, C21, ldc, crossover, next);
+
+  // C22 = P5 = S1*T1, with S1 = A21 + A22 and T1 = B12 - B11
+  addBlocks(h, A21, lda, A22, lda, 1, X, h);
+  addBlocks(h, B12, ldb, B11, ldb, -1, Y, h);
+  strassenWinograd(h, X, h, Y, h, C22, ldc, crossover, next);
+
+  // C12 = P6 = S2*T2, with S2 = S1 - A11 and T2 = B22 - T1
+  addBlocks(h, X, h, A11, lda, -1, X, h);
+  addBlocks(h, B22, ldb, Y, h, -1, Y, h);
+  strassenWinograd(h, X, h, Y, h, C12, ldc, crossover, next);
+
+  // Z = P1 = A11*B11
+  strassenWinograd(h, A11, lda, B11, ldb, Z, h, crossover, next);
+
+  // C12 = U2 = P1 + P6; C21 = U3 = U2 + P7;
+  // C12 = U4 = U2 + P5; C22 = U7 = U3 + P5
+  addBlocks(h, C12, ldc, Z, h, 1, C12, ldc);
+  addBlocks(h, C21, ldc, C12, ldc, 1, C21, ldc);
+  addBlocks(h, C12, ldc, C22, ldc, 1, C12, ldc);
+  addBlocks(h, C22, ldc, C21, ldc, 1, C22, ldc);
+
+  // C11 = P3 = S4*B22, with S4 = A12 - S2; then C12 = U5 = U4 + P3
+  addBlocks(h, A12, lda, X, h, -1, X, h);
+  strassenWinograd(h, X, h, B22, ldb, C11, ldc, crossover, next);
+  addBlocks(h, C12, ldc, C11, ldc, 1, C12, ldc);
+
+  // C11 = P4 = A22*T4, with T4 = T2 - B21; then C21 = U6 = U3 - P4
+  addBlocks(h, Y, h, B21, ldb, -1, Y, h);
+  strassenWinograd(h, A22, lda, Y, h, C11, ldc, crossover, next);
+  addBlocks(h, C21, ldc, C11, ldc, -1, C21, ldc);
+
+  // C11 = U1 = P1 + P2, with P2 = A12*B21
+  strassenWinograd(h, A12, lda, B21, ldb, C11, ldc, crossover, next);
+  addBlocks(h, C11, ldc, Z, h, 1, C11, ldc);
+}
+
+
 void Matrix::multiply(const Matrix& X, Matrix& Y) const
 {
   // Make sure the dimensions are consistent
@@ -68,35 +222,417 @@ void Matrix::multiply(const Matrix& X, Matrix& Y) const
   assert(ncols_ == X.nrows_);
   assert(X.ncols_ == Y.ncols_);
 
-  for(int r=0; r<Y.nrows_; r++)
+  // Every entry of Y is overwritten, so a shared Y is not copied
+  Y.detach(false);
+
+  // Read once: another thread may change it, and the workspace is
+  // sized for this value
+  const int crossover = strassenCrossover_;
+  const int n = nrows_;
+  if(crossover <= 0 || n <= crossover ||
+     ncols_ != n || X.ncols_ != n)
+  {
+    gemmKernel(nrows_, X.ncols_, ncols_, values_, ncols_,
+               X.values_, X.ncols_, Y.values_, Y.ncols_);
+    return;
+  }
+
+  // Pick the number of levels so the leaves are no larger than the
+  // crossover, then pad n to a multiple of 2^levels
+  int levels = 0;
+  int leaf = n;
+  while(leaf > crossover)
+  {
+    leaf = (leaf+1)/2;
+    levels++;
+  }
+  const int npad = leaf << levels;
+
+  // Workspace for all levels of the recursion: 3*(h^2) per level
+  std::size_t workSize = 0;
+  for(int h=npad/2; h>=leaf; h/=2)
+    workSize += 3*(std::size_t)h*h;
+
+  if(npad == n)
+  {
+    double* work = allocate(1, workSize, ALLOC_FIRST_TOUCH);
+    strassenWinograd(n, values_, n, X.values_, n, Y.values_, n,
+                     crossover, work);
+    deallocate(work, workSize, ALLOC_FIRST_TOUCH);
+    return;
+  }
+
+  // Embed A and B in zero-padded copies; C is copied back at the end
+  const std::size_t padSize = (std::size_t)npad*npad;
+  double* work = allocate(1, workSize + 3*padSize, ALLOC_FIRST_TOUCH);
+  double* Apad = work + workSize;
+  double* Bpad = Apad + padSize;
+  double* Cpad = Bpad + padSize;
+
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      Apad[(std::size_t)r*npad + c] = values_[(std::size_t)r*n + c];
+      Bpad[(std::size_t)r*npad + c] = X.values_[(std::size_t)r*n + c];
+    }
+  }
+
+  strassenWinograd(npad, Apad, npad, Bpad, npad, Cpad, npad,
+                   crossover, work);
+
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      Y.values_[(std::size_t)r*n + c] = Cpad[(std::size_t)r*npad + c];
+  }
+
+  deallocate(work, workSize + 3*padSize, ALLOC_FIRST_TOUCH);
+}
+
+
+void Matrix::setStrassenCrossover(const int n)
+{
+  strassenCrossover_ = n;
+}
+
+
+int Matrix::getStrassenCrossover()
+{
+  return strassenCrossover_;
+}
+
+
+void Matrix::ger(const double alpha, const Vector& x, const Vector& y)
+{
+  // Make sure the dimensions are consistent
+  assert(x.getNumElements() == nrows_);
+  assert(y.getNumElements() == ncols_);
+
+  detach();
+  getBackend().ger(nrows_, ncols_, alpha, &x[0], &y[0], values_, ncols_);
+}
+
+
+void Matrix::syr(const double alpha, const Vector& x)
+{
+  // Make sure the dimensions are consistent
+  assert(nrows_ == ncols_);
+  assert(x.getNumElements() == nrows_);
+
+  // x x^T is the transpose form of SYRK with x as a 1 x n matrix
+  detach();
+  getBackend().syrk(true, nrows_, 1, alpha, &x[0], nrows_, 1, values_, ncols_);
+}
+
+
+void Matrix::syrk(const double alpha, const Matrix& X, const double beta,
+                  const bool transpose)
+{
+  // Make sure the dimensions are consistent
+  assert(nrows_ == ncols_);
+  assert((transpose ? X.ncols_ : X.nrows_) == nrows_);
+  assert(&X != this);
+
+  detach(beta != 0);
+  getBackend().syrk(transpose, nrows_, transpose ? X.nrows_ : X.ncols_,
+                    alpha, X.values_, X.ncols_, beta, values_, ncols_);
+}
+
+
+// Number of columns the Cholesky routines handle sequentially before
+// handing the rest of the matrix to the threads
+static const int choleskyBlockSize = 64;
+
+
+bool Matrix::factorCholesky()
+{
+  assert(nrows_ == ncols_);
+
+  detach();
+  const int n = nrows_;
+  const int nb = choleskyBlockSize;
+  for(int b=0; b<n; b+=nb)
+  {
+    const int bend = (b + nb < n) ? b + nb : n;
+
+    // Rows b..bend-1 of R, updating only the rows of this block
+    for(int k=b; k<bend; k++)
+    {
+      double* Rk = values_ + (std::size_t)k*n;
+      if(Rk[k] <= 0)
+        return false;
+      const double rkk = std::sqrt(Rk[k]);
+      Rk[k] = rkk;
+      #pragma omp simd
+      for(int j=k+1; j<n; j++)
+        Rk[j] = Rk[j] / rkk;
+
+      for(int i=k+1; i<bend; i++)
+      {
+        double* Ri = values_ + (std::size_t)i*n;
+        const double rki = Rk[i];
+        #pragma omp simd
+        for(int j=i; j<n; j++)
+          Ri[j] = Ri[j] - rki*Rk[j];
+      }
+    }
+
+    // Trailing matrix: A22 = A22 - R12^T * R12
+    if(bend < n)
+    {
+      getBackend().syrk(true, n-bend, bend-b, -1,
+                        values_ + (std::size_t)b*n + bend, n, 1,
+                        values_ + (std::size_t)bend*n + bend, n);
+    }
+  }
+
+  #pragma omp parallel for schedule(static)
+  for(int r=1; r<n; r++)
+  {
+    double* row = values_ + (std::size_t)r*n;
+    for(int c=0; c<r; c++)
+      row[c] = 0;
+  }
+
+  return true;
+}
+
+
+void Matrix::updateCholesky(const Vector& x)
+{
+  assert(nrows_ == ncols_);
+  assert(x.getNumElements() == nrows_);
+
+  detach();
+  const int n = nrows_;
+  const int nb = choleskyBlockSize;
+  std::vector<double> w(&x[0], &x[0] + n), cs(n), sn(n);
+
+  for(int b=0; b<n; b+=nb)
+  {
+    const int bend = (b + nb < n) ? b + nb : n;
+
+    // The columns of this block have seen every earlier rotation, so
+    // their rotations can be computed now
+    for(int k=b; k<bend; k++)
+    {
+      double* Rk = values_ + (std::size_t)k*n;
+      const double r = std::sqrt(Rk[k]*Rk[k] + w[k]*w[k]);
+      cs[k] = r / Rk[k];
+      sn[k] = w[k] / Rk[k];
+      Rk[k] = r;
+      for(int j=k+1; j<bend; j++)
+      {
+        Rk[j] = (Rk[j] + sn[k]*w[j]) / cs[k];
+        w[j] = cs[k]*w[j] - sn[k]*Rk[j];
+      }
+    }
+
+    // Apply them to the columns on the right, one block per thread
+    const int ntrailing = (n - bend + nb - 1) / nb;
+    #pragma omp parallel for schedule(static)
+    for(int t=0; t<ntrailing; t++)
+    {
+      const int jbegin = bend + t*nb;
+      const int jend = (jbegin + nb < n) ? jbegin + nb : n;
+      for(int k=b; k<bend; k++)
+      {
+        double* Rk = values_ + (std::size_t)k*n;
+        const double c = cs[k], s = sn[k];
+        #pragma omp simd
+        for(int j=jbegin; j<jend; j++)
+        {
+          const double rkj = (Rk[j] + s*w[j]) / c;
+          Rk[j] = rkj;
+          w[j] = c*w[j] - s*rkj;
+        }
+      }
+    }
+  }
+}
+
+
+// Solves R^T * y = x in place, where R is upper triangular.  Within a
+// block of columns the solve is sequential; the block's contribution
+// to the rest of y is then subtracted in parallel.
+static void solveTransposed(const int n, const double* R, double* x)
+{
+  const int nb = choleskyBlockSize;
+  for(int b=0; b<n; b+=nb)
   {
-    for(int c=0; c<Y.ncols_; c++)
+    const int bend = (b + nb < n) ? b + nb : n;
+    for(int k=b; k<bend; k++)
+    {
+      const double* Rk = R + (std::size_t)k*n;
+      x[k] = x[k] / Rk[k];
+      for(int j=k+1; j<bend; j++)
+        x[j] = x[j] - Rk[j]*x[k];
+    }
+
+    const int ntrailing = (n - bend + nb - 1) / nb;
+    #pragma omp parallel for schedule(static)
+    for(int t=0; t<ntrailing; t++)
     {
-      Y(r,c) = 0;
-      for(int k=0; k<ncols_; k++)
+      const int jbegin = bend + t*nb;
+      const int jend = (jbegin + nb < n) ? jbegin + nb : n;
+      for(int k=b; k<bend; k++)
       {
-        Y(r,c) = Y(r,c) + data_[r][k] * X.data_[k][c];
+        const double* Rk = R + (std::size_t)k*n;
+        const double xk = x[k];
+        #pragma omp simd
+        for(int j=jbegin; j<jend; j++)
+          x[j] = x[j] - Rk[j]*xk;
       }
     }
   }
 }
 
 
+// Solves R * x = y in place, where R is upper triangular, a block of
+// rows at a time from the bottom
+static void solveUpper(const int n, const double* R, double* x)
+{
+  const int nb = choleskyBlockSize;
+  for(int bend=n; bend>0; bend-=nb)
+  {
+    const int b = (bend - nb > 0) ? bend - nb : 0;
+
+    // What the entries already solved contribute to this block
+    #pragma omp parallel for schedule(static)
+    for(int j=b; j<bend; j++)
+    {
+      const double* Rj = R + (std::size_t)j*n;
+      double sum = 0;
+      #pragma omp simd reduction(+:sum)
+      for(int i=bend; i<n; i++)
+        sum = sum + Rj[i]*x[i];
+      x[j] = x[j] - sum;
+    }
+
+    for(int j=bend-1; j>=b; j--)
+    {
+      const double* Rj = R + (std::size_t)j*n;
+      double sum = x[j];
+      for(int i=j+1; i<bend; i++)
+        sum = sum - Rj[i]*x[i];
+      x[j] = sum / Rj[j];
+    }
+  }
+}
+
+
+bool Matrix::downdateCholesky(const Vector& x)
+{
+  assert(nrows_ == ncols_);
+  assert(x.getNumElements() == nrows_);
+
+  const int n = nrows_;
+  const int nb = choleskyBlockSize;
+  std::vector<double> p(&x[0], &x[0] + n), cs(n), sn(n);
+
+  // A - x x^T is positive definite if and only if ||R^-T x|| < 1
+  solveTransposed(n, values_, &p[0]);
+  double norm = getBackend().norm2(n, &p[0]);
+  if(norm >= 1)
+    return false;
+
+  // Rotations that take (p, sqrt(1 - ||p||^2)) to (0, 1), from the
+  // last entry up
+  double alpha = std::sqrt(1 - norm*norm);
+  for(int i=n-1; i>=0; i--)
+  {
+    const double scale = alpha + std::abs(p[i]);
+    const double a = alpha / scale;
+    const double b = p[i] / scale;
+    norm = std::sqrt(a*a + b*b);
+    cs[i] = a / norm;
+    sn[i] = b / norm;
+    alpha = scale * norm;
+  }
+
+  // Column j takes rotations j, j-1, ..., 0.  Columns are independent,
+  // so each thread sweeps its own blocks of them; the blocks on the
+  // right have more rotations, so they are dealt out round-robin.
+  detach();
+  const int nblocks = (n + nb - 1) / nb;
+  #pragma omp parallel
+  {
+    std::vector<double> xx(nb);
+
+    #pragma omp for schedule(static,1)
+    for(int t=0; t<nblocks; t++)
+    {
+      const int jbegin = t*nb;
+      const int jend = (jbegin + nb < n) ? jbegin + nb : n;
+      for(int j=jbegin; j<jend; j++)
+        xx[j-jbegin] = 0;
+
+      for(int i=jend-1; i>=0; i--)
+      {
+        double* Ri = values_ + (std::size_t)i*n;
+        const double c = cs[i], s = sn[i];
+        #pragma omp simd
+        for(int j=(i > jbegin ? i : jbegin); j<jend; j++)
+        {
+          const double z = xx[j-jbegin];
+          xx[j-jbegin] = c*z + s*Ri[j];
+          Ri[j] = c*Ri[j] - s*z;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+
+void Matrix::solveCholesky(const Vector& B, Vector& X) const
+{
+  assert(nrows_ == ncols_);
+  assert(B.getNumElements() == nrows_);
+  assert(X.getNumElements() == nrows_);
+
+  double* x = &X[0];
+  if(&B != &X)
+  {
+    const double* b = &B[0];
+    #pragma omp parallel for schedule(static)
+    for(int i=0; i<nrows_; i++)
+      x[i] = b[i];
+  }
+
+  solveTransposed(nrows_, values_, x);
+  solveUpper(nrows_, values_, x);
+}
+
+
 bool Matrix::isSymmetric() const
 {
   if(nrows_ != ncols_)
     return false;
 
-  for(int r=0; r<nrows_; r++)
+  bool symmetric;
+  if(buffer_->getProperty(PROPERTY_SYMMETRIC, symmetric))
+    return symmetric;
+
+  symmetric = true;
+  for(int r=0; r<nrows_ && symmetric; r++)
   {
     for(int c=0; c<ncols_; c++)
     {
-      if(data_[r][c] != data_[c][r])
-        return false;
+      if((*this)(r,c) != (*this)(c,r))
+      {
+        symmetric = false;
+        break;
+      }
     }
   }
 
-  return true;
+  buffer_->setProperty(PROPERTY_SYMMETRIC, symmetric);
+  return symmetric;
 }
 
 
@@ -105,54 +641,181 @@ bool Matrix::isUpperTriangular() const
   if(nrows_ != ncols_)
     return false;
 
-  for(int r=0; r<nrows_; r++)
+  bool upper;
+  if(buffer_->getProperty(PROPERTY_UPPER_TRIANGULAR, upper))
+    return upper;
+
+  upper = true;
+  for(int r=1; r<nrows_ && upper; r++)
   {
-    for(int c=r+1; c<ncols_; c++)
+    for(int c=0; c<r; c++)
     {
-      if(data_[r][c] != 0)
-        return false;
+      if((*this)(r,c) != 0)
+      {
+        upper = false;
+        break;
+      }
     }
   }
 
-  return true;
+  buffer_->setProperty(PROPERTY_UPPER_TRIANGULAR, upper);
+  return upper;
 }
 
 
-// Maximum absolute column sum
-double Matrix::norm1() const
+// Rows and columns per tile of computeStats
+static const int statsBlockSize = 64;
+
+/* Adds the entries row[cbegin..cend) of row r to the running
+ * statistics of one thread: absolute row and column sums, sum of
+ * squares, largest absolute entry, nonzero count and bandwidths.
+ */
+static void accumulateStats(const double* row, const int r, const int cbegin,
+                            const int cend, double* rowSums, double* colSums,
+                            double& sumSquares, double& maxAbs, long& nnz,
+                            int& lower, int& upper)
 {
-  double curColSum;
-  double maxColSum = 0;
-  for(int c=0; c<ncols_; c++)
+  double rowSum = 0, squares = 0, maxVal = 0;
+  long count = 0;
+  int first = cend, last = cbegin-1;
+  #pragma omp simd reduction(+:rowSum,squares,count) \
+                   reduction(max:maxVal,last) reduction(min:first)
+  for(int c=cbegin; c<cend; c++)
   {
-    curColSum = 0;
-    for(int r=0; r<nrows_; r++)
-    {
-      curColSum = curColSum + data_[r][c];
-    }
-    if(curColSum > maxColSum)
-      maxColSum = curColSum;
+    double a = std::abs(row[c]);
+    rowSum += a;
+    squares += a*a;
+    colSums[c] += a;
+    maxVal = (a > maxVal) ? a : maxVal;
+    count += (a != 0);
+    first = (a != 0 && c < first) ? c : first;
+    last = (a != 0 && c > last) ? c : last;
+  }
+
+  rowSums[r] += rowSum;
+  sumSquares += squares;
+  if(maxVal > maxAbs)
+    maxAbs = maxVal;
+  nnz += count;
+  if(count > 0)
+  {
+    lower = std::max(lower, r - first);
+    upper = std::max(upper, last - r);
   }
-  return maxColSum;
 }
 
 
-// Maximum absolute row sum
-double Matrix::normInf() const
+MatrixStats Matrix::computeStats() const
 {
-  double curRowSum;
-  double maxRowSum = 0;
-  for(int r=0; r<nrows_; r++)
+  const bool square = (nrows_ == ncols_);
+  const int nb = statsBlockSize;
+  const int nrowBlocks = (nrows_ + nb - 1) / nb;
+  const int ncolBlocks = (ncols_ + nb - 1) / nb;
+  const std::size_t n = ncols_;
+
+  std::vector<double> rowSums(nrows_, 0.0), colSums(ncols_, 0.0);
+  double sumSquares = 0, maxAbs = 0;
+  long nnz = 0;
+  int lower = 0, upper = 0, asymmetric = square ? 0 : 1;
+
+  #pragma omp parallel reduction(+:sumSquares,nnz) \
+                       reduction(max:maxAbs,lower,upper,asymmetric)
   {
-    curRowSum = 0;
-    for(int c=0; c<ncols_; c++)
+    std::vector<double> myRowSums(nrows_, 0.0), myColSums(ncols_, 0.0);
+    bool mismatch = !square;
+
+    // A square matrix is walked in pairs of tiles (I,J) and (J,I) with
+    // I <= J; rows of pairs shrink with I, so they are dealt out
+    // round-robin to balance the threads
+    #pragma omp for schedule(static,1)
+    for(int I=0; I<nrowBlocks; I++)
+    {
+      const int rbegin = I*nb;
+      const int rend = std::min(nrows_, rbegin + nb);
+      for(int J=(square ? I : 0); J<ncolBlocks; J++)
+      {
+        const int cbegin = J*nb;
+        const int cend = std::min(ncols_, cbegin + nb);
+        for(int r=rbegin; r<rend; r++)
+          accumulateStats(values_ + r*n, r, cbegin, cend, &myRowSums[0],
+                          &myColSums[0], sumSquares, maxAbs, nnz, lower, upper);
+        if(!square || I == J)
+          continue;
+
+        // The mirrored tile (J,I)
+        for(int r=cbegin; r<cend; r++)
+          accumulateStats(values_ + r*n, r, rbegin, rend, &myRowSums[0],
+                          &myColSums[0], sumSquares, maxAbs, nnz, lower, upper);
+        for(int r=rbegin; r<rend && !mismatch; r++)
+        {
+          int mismatches = 0;
+          #pragma omp simd reduction(+:mismatches)
+          for(int c=cbegin; c<cend; c++)
+            mismatches += (values_[r*n + c] != values_[c*n + r]);
+          mismatch = (mismatches > 0);
+        }
+      }
+
+      // The upper triangle of the diagonal tile against its lower one
+      for(int r=rbegin; square && r<rend && !mismatch; r++)
+      {
+        for(int c=r+1; c<rend; c++)
+          mismatch = mismatch || (values_[r*n + c] != values_[c*n + r]);
+      }
+    }
+    asymmetric = mismatch;
+
+    #pragma omp critical
     {
-      curRowSum = curRowSum + data_[r][c];
+      for(int r=0; r<nrows_; r++)
+        rowSums[r] += myRowSums[r];
+      for(int c=0; c<ncols_; c++)
+        colSums[c] += myColSums[c];
     }
-    if(curRowSum > maxRowSum)
-      maxRowSum = curRowSum;
   }
-  return maxRowSum;
+
+  MatrixStats stats;
+  stats.norm1 = *std::max_element(colSums.begin(), colSums.end());
+  stats.normInf = *std::max_element(rowSums.begin(), rowSums.end());
+  stats.normFrobenius = std::sqrt(sumSquares);
+  stats.maxAbs = maxAbs;
+  stats.nnz = nnz;
+  stats.symmetric = !asymmetric;
+  stats.upperTriangular = square && lower == 0;
+  stats.lowerTriangular = square && upper == 0;
+  stats.lowerBandwidth = lower;
+  stats.upperBandwidth = upper;
+
+  if(square)
+  {
+    buffer_->setProperty(PROPERTY_SYMMETRIC, stats.symmetric);
+    buffer_->setProperty(PROPERTY_UPPER_TRIANGULAR, stats.upperTriangular);
+  }
+  return stats;
+}
+
+
+double Matrix::norm1() const
+{
+  return computeStats().norm1;
+}
+
+
+double Matrix::normInf() const
+{
+  return computeStats().normInf;
+}
+
+
+double Matrix::normFrobenius() const
+{
+  return computeStats().normFrobenius;
+}
+
+
+double Matrix::norm2(const double tol) const
+{
+  return estimateNorm2(*this, tol);
 }
 
 
@@ -174,6 +837,12 @@ int Matrix::getNumEntries() const
 }
 
 
+int Matrix::getUseCount() const
+{
+  return buffer_->getUseCount();
+}
+
+
 bool Matrix::approxEqual(const Matrix& m, const double tol) const
 {
   if(nrows_ != m.nrows_ || ncols_ != m.ncols_)
@@ -183,7 +852,7 @@ bool Matrix::approxEqual(const Matrix& m, const double tol) const
   {
     for(int c=0; c<ncols_; c++)
     {
-      if(std::abs(data_[r][c] - m.data_[r][c]) > tol)
+      if(std::abs((*this)(r,c) - m(r,c)) > tol)
         return false;
     }
   }
@@ -193,15 +862,10 @@ bool Matrix::approxEqual(const Matrix& m, const double tol) const
 
 void Matrix::print() const
 {
-  std::cout << nrows_ << "x" << ncols_ << " Matrix\n";
-  for(int r=0; r<nrows_; r++)
-  {
-    for(int c=0; c<ncols_; c++)
-    {
-      std::cout << data_[r][c] << " ";
-    }
-    std::cout << std::endl;
-  }
+  // std::cout writes %g with its precision, where 0 means 1
+  Writer writer(std::cout);
+  writer.setPrecision(std::max<int>(1, std::cout.precision()));
+  writer.write(*this);
 }
 
 } /* namespace Morpheus */
@@ -8,21 +8,56 @@
 #ifndef MORPHEUS_MATRIX_H_
 #define MORPHEUS_MATRIX_H_
 
+#include "Morpheus_LinearOperator.h"
+#include "Morpheus_Memory.h"
 #include "Morpheus_Vector.h"
+#include <atomic>
 
 namespace Morpheus {
 
+/** \brief Norms and structure of a Matrix, from Matrix::computeStats
+ *
+ * Entries are compared exactly; a tiny but nonzero entry counts as
+ * nonzero and breaks triangularity.
+ */
+struct MatrixStats {
+  //! Maximum absolute column sum
+  double norm1;
+  //! Maximum absolute row sum
+  double normInf;
+  //! Square root of the sum of the squares of all entries
+  double normFrobenius;
+  //! Largest absolute value of an entry
+  double maxAbs;
+  //! Number of nonzero entries
+  long nnz;
+  //! Whether the matrix is square and equal to its transpose
+  bool symmetric;
+  //! Whether the matrix is square with only zeros below the diagonal
+  bool upperTriangular;
+  //! Whether the matrix is square with only zeros above the diagonal
+  bool lowerTriangular;
+  //! Largest r - c of a nonzero entry (r,c)
+  int lowerBandwidth;
+  //! Largest c - r of a nonzero entry (r,c)
+  int upperBandwidth;
+};
+
 /** \class Matrix
  * \brief Stores a dense matrix
  *
- * \todo Add a function for computing the Frobenius norm
- * \todo Add a function for computing the 2-norm
  * \todo Add a function for reading a matrix from a file
  *
  * \example Morpheus_Matrix_Tests.cpp
  * Demonstrates the usage of the matrix class
+ *
+ * \example Morpheus_Matrix_copyTest.cpp
+ * Demonstrates copy-on-write sharing of a matrix between threads
+ *
+ * \example Morpheus_Matrix_statsTest.cpp
+ * Demonstrates computing the norms and structure of a matrix at once
  */
-class Matrix {
+class Matrix : public LinearOperator {
 public:
   //! \name Constructors and destructors
   ///@{
@@ -30,10 +65,32 @@ public:
    *
    * Allocates memory for a dense matrix.
    * If either nrows or ncols is not positive, the program terminates.
+   * The entries are stored row by row in a single contiguous block.
    * \param[in] nrows Number of rows
    * \param[in] ncols Number of columns
+   * \param[in] policy Where to place the pages of the matrix.
+   * By default, each row is zeroed by the thread that will work on
+   * it in the multiplication routines.
+   */
+  Matrix(const int nrows, const int ncols,
+         const AllocPolicy policy=ALLOC_FIRST_TOUCH);
+
+  /** \brief Copy constructor
+   *
+   * The copy shares the entries of \a A until either of them is
+   * written (see SharedBuffer), so it costs O(1) instead of O(n^2).
+   * Threads that each need a slightly modified matrix can take a copy
+   * of a shared one and write to it; only the threads that actually
+   * write pay for a deep copy, and the shared matrix never changes.
    */
-  Matrix(const int nrows, const int ncols);
+  Matrix(const Matrix& A);
+
+  /** \brief Assignment
+   *
+   * Releases the old entries and shares those of \a A, which may
+   * have different dimensions.
+   */
+  Matrix& operator=(const Matrix& A);
 
   /** \brief Destructor
    *
@@ -51,6 +108,21 @@ public:
    *
    * \note This is 0-based, not 1-based indexing
    *
+   * If the entries are shared with a copy, this matrix gets its own
+   * copy of them first, so call the const version when only reading.
+   * The returned reference, and pointers derived from it, must not be
+   * written through after the matrix is copied; call this again
+   * instead.  They may be written after a property (such as
+   * isSymmetric) is queried, because once a mutable reference has
+   * been given out the properties of these entries are no longer
+   * cached.
+   *
+   * \warning Do not call this from several threads on one matrix
+   * whose entries may be shared: each thread would make its own
+   * copy.  To fill a matrix in parallel, take <tt>double* a =
+   * &m(0,0);</tt> once, before the threads start, and have them write
+   * <tt>a[(size_t)r*ncols + c]</tt>.
+   *
    * Usage:
    * \code
    * Matrix m(4,3);
@@ -66,6 +138,13 @@ public:
    */
   double& operator()(const int row, const int col);
 
+  /** \brief Accesses a single entry of a const matrix
+   *
+   * \param[in] row Row
+   * \param[in] col Column
+   */
+  const double& operator()(const int row, const int col) const;
+
   //! Returns the number of rows
   int getNumRows() const;
 
@@ -74,6 +153,13 @@ public:
 
   //! Returns the number of entries
   int getNumEntries() const;
+
+  /** \brief Returns the number of matrices sharing these entries
+   *
+   * This is 1 unless the matrix was copied and neither copy has been
+   * written since.
+   */
+  int getUseCount() const;
   ///@}
 
   //! \name Multiplication routines
@@ -93,6 +179,31 @@ public:
    */
   void multiply(const Vector& X, Vector& Y) const;
 
+  /** \brief Computes a scaled matrix-vector multiplication (BLAS GEMV)
+   *
+   * Replaces \a Y by \a alpha * op(\a this) * \a X + \a beta * \a Y in a
+   * single sweep over the matrix, where op(\a this) is \a this or its
+   * transpose.
+   * \param[in] alpha Scalar multiplying the product
+   * \param[in] X vector to be multiplied
+   * \param[in] beta Scalar multiplying \a Y.  If it is 0, \a Y is not
+   * read, so it does not need to be initialized.
+   * \param[in,out] Y result of multiplication
+   * \param[in] transpose If true, multiply by the transpose of \a this
+   *
+   * \note The number of entries of \a X must equal the number of
+   * columns of op(\a this), and the number of entries of \a Y must equal
+   * its number of rows.  Otherwise, the program will terminate.
+   */
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+
   /** \brief Computes a matrix-matrix multiplication
    *
    * \param[in] X matrix to be multiplied
@@ -104,28 +215,165 @@ public:
    * of the calling matrix must equal the number of rows of \a X.  \a X
    * and \a Y must have the same number of columns.  Otherwise,
    * the program will terminate.
+   *
+   * If all three matrices are n x n and n exceeds the Strassen
+   * crossover (see setStrassenCrossover), the product is computed
+   * with the Strassen-Winograd algorithm.  Otherwise the conventional
+   * O(n^3) algorithm is used.
    */
   void multiply(const Matrix& X, Matrix& Y) const;
+
+  /** \brief Sets the crossover size for Strassen-Winograd multiplication
+   *
+   * Square products larger than \a n are split recursively into
+   * quadrants, using 7 half-size products per level instead of 8,
+   * until the blocks are no larger than \a n; those leaf blocks are
+   * multiplied with the conventional kernel.  A single workspace of
+   * about n^2 doubles (plus padded copies of the operands when n is
+   * not a multiple of the leaf size times a power of two) is
+   * allocated per product and reused by every level.
+   *
+   * \param[in] n Crossover size.  0 (the default) disables
+   * Strassen-Winograd entirely.
+   *
+   * \warning The error bound of Strassen-Winograd is normwise rather
+   * than componentwise and grows faster with the number of levels
+   * than that of the conventional algorithm.  Products with entries
+   * of widely varying magnitude may lose accuracy.
+   *
+   * This may be called from any thread.  A product that has already
+   * started keeps the crossover it began with.
+   */
+  static void setStrassenCrossover(const int n);
+
+  //! Returns the crossover size for Strassen-Winograd multiplication
+  static int getStrassenCrossover();
+  ///@}
+
+  /** \name Rank-k updates
+   * These change the matrix by a low-rank term in a single sweep,
+   * O(n^2) for a rank-1 term, instead of rebuilding it entry by entry.
+   */
+  ///@{
+  /** \brief Replaces \a this by \a alpha * \a x * \a y^T + \a this
+   * (BLAS GER)
+   *
+   * \param[in] alpha Scalar multiplying the update
+   * \param[in] x One entry per row
+   * \param[in] y One entry per column
+   */
+  void ger(const double alpha, const Vector& x, const Vector& y);
+
+  /** \brief Replaces \a this by \a alpha * \a x * \a x^T + \a this
+   * (BLAS SYR)
+   *
+   * The matrix must be square.  Only its lower triangle is read; the
+   * upper triangle is overwritten with its mirror image, so the result
+   * is exactly symmetric.
+   * \param[in] alpha Scalar multiplying the update
+   * \param[in] x One entry per row
+   */
+  void syr(const double alpha, const Vector& x);
+
+  /** \brief Replaces \a this by
+   * \a alpha * op(\a X) * op(\a X)^T + \a beta * \a this (BLAS SYRK)
+   *
+   * op(\a X) is \a X, or its transpose if \a transpose is true, and
+   * must have as many rows as \a this.  The matrix must be square.
+   * As in syr, only its lower triangle is read and the result is
+   * exactly symmetric.  If \a beta is 0, \a this is not read.
+   * \param[in] alpha Scalar multiplying the product
+   * \param[in] X Factor of the update; must not be \a this
+   * \param[in] beta Scalar multiplying \a this
+   * \param[in] transpose If true, use \a X^T * \a X
+   */
+  void syrk(const double alpha, const Matrix& X, const double beta,
+            const bool transpose=false);
+  ///@}
+
+  /** \name Cholesky factorization
+   * The factor is stored in place as the upper triangular R = L^T,
+   * with A = R^T * R, so the rows that the updates sweep are
+   * contiguous.  Once a matrix is factored, a rank-1 change of A can
+   * be folded into R in O(n^2) with updateCholesky or
+   * downdateCholesky, instead of refactoring in O(n^3).  The routines
+   * do not check that the matrix holds a factor; that is up to the
+   * caller.
+   */
+  ///@{
+  /** \brief Computes the Cholesky factorization A = R^T * R in place
+   *
+   * The matrix must be symmetric positive definite.  It is overwritten
+   * by R, with the strictly lower triangle zeroed.  This takes about
+   * n^3/3 multiply-adds, most of them in blocked Backend::syrk calls.
+   *
+   * Returns false if the matrix is not positive definite; it has then
+   * been partly overwritten.
+   */
+  bool factorCholesky();
+
+  /** \brief Replaces the factor R of A by the factor of A + \a x * \a x^T
+   *
+   * Applies one Givens rotation per column, in O(n^2).  The rotations
+   * for a block of columns are computed one after the other, then
+   * applied to all the columns to their right in parallel.
+   * \param[in] x The update
+   */
+  void updateCholesky(const Vector& x);
+
+  /** \brief Replaces the factor R of A by the factor of A - \a x * \a x^T
+   *
+   * Uses the method of LINPACK's DCHDD, which is stable: it solves
+   * R^T * p = \a x, builds the rotations from p, and applies them to
+   * the columns of R, which are independent, in parallel.  This takes
+   * O(n^2).
+   *
+   * Returns false, leaving the factor unchanged, if ||p|| >= 1, that
+   * is if A - \a x * \a x^T would not be positive definite.
+   * \param[in] x The downdate
+   */
+  bool downdateCholesky(const Vector& x);
+
+  /** \brief Solves A * \a X = \a B using the factor from factorCholesky
+   *
+   * This takes O(n^2) operations.
+   * \param[in] B right-hand side
+   * \param[out] X solution.  May be the same vector as \a B.
+   */
+  void solveCholesky(const Vector& B, Vector& X) const;
   ///@}
 
   //! \name Matrix property query methods
   ///@{
   /** \brief Determines whether the matrix is symmetric
    *
-   * \note The symmetry is not stored as a property of the
-   * matrix.  Every time this function is called, it will
-   * perform the O(n^2) comparison of entries.
+   * \note The first call performs the O(n^2) comparison of entries
+   * and caches the answer with the entries, so copies that share them
+   * get it for free.  Any change to the entries clears it.  Entries
+   * that the non-const operator() has given out a reference to are
+   * never cached, since they may be written at any time; each call
+   * then compares them again.
    */
   bool isSymmetric() const;
 
   /** \brief Determines whether the matrix is upper triangular
    *
-   * \note This is not stored as a property of the matrix.
-   * Every time this function is called, it will perform the
-   * O(n^2) comparison of entries.
+   * \note Cached in the same way as isSymmetric.
    */
   bool isUpperTriangular() const;
 
+  /** \brief Computes all the norms and structural properties at once
+   *
+   * Calling norm1, normInf, isSymmetric and so on separately sweeps
+   * the matrix once per call.  This reads every entry exactly once,
+   * in tiles: for a square matrix, tiles (I,J) and (J,I) are visited
+   * together, so symmetry is checked while both are in cache.  Rows
+   * of tiles are spread over the threads.  The symmetry and upper
+   * triangularity it finds are cached for isSymmetric and
+   * isUpperTriangular.
+   */
+  MatrixStats computeStats() const;
+
   /** \brief Determines whether this matrix is approximately equal
    * to another matrix
    *
@@ -142,11 +390,24 @@ public:
   //! \name Norms
   ///@{
 
-  //! Maximum absolute column sum
+  //! Maximum absolute column sum; see computeStats
   double norm1() const;
 
-  //! Maximum absolute row sum
+  //! Maximum absolute row sum; see computeStats
   double normInf() const;
+
+  //! Square root of the sum of the squares of all entries; see computeStats
+  double normFrobenius() const;
+
+  /** \brief Estimates the 2-norm (largest singular value)
+   *
+   * Runs the Lanczos process on A^T*A (see estimateNorm2), applying it
+   * as two gemv calls, so the cost is a few dozen matrix-vector
+   * products instead of the O(n^3) of an SVD.  The result is accurate
+   * to a relative error of about \a tol.
+   * \param[in] tol Relative tolerance
+   */
+  double norm2(const double tol=1e-8) const;
   ///@}
 
   //! \name I/O functions
@@ -161,6 +422,9 @@ public:
    * 0 0 1\n
    * 0 0 0\n
    * </tt>
+   *
+   * Entries have the precision of <tt>std::cout</tt>.  Use a Writer
+   * to write to a file, or to keep every digit.
    */
   void print() const;
   ///@}
@@ -170,8 +434,25 @@ private:
   int nrows_;
   //! Number of columns
   int ncols_;
-  //! Pointer to raw data
-  double** data_;
+  //! Entries, possibly shared with copies of this matrix
+  SharedBuffer* buffer_;
+  //! Contiguous storage for all the entries, row by row
+  double* values_;
+  //! Crossover size for Strassen-Winograd multiplication
+  static std::atomic<int> strassenCrossover_;
+
+  //! Properties cached in \a buffer_
+  enum Property {
+    PROPERTY_SYMMETRIC,
+    PROPERTY_UPPER_TRIANGULAR
+  };
+
+  /** \brief Gets a private copy of the entries before writing them
+   *
+   * \param[in] keepValues Whether the old entries are needed; see
+   * SharedBuffer::detach
+   */
+  void detach(const bool keepValues=true);
 };
 
 } /* namespace Morpheus */
@@ -0,0 +1,523 @@
+/**
+ * @file
+ * \brief Defines the NUMA-aware allocation routines used by Matrix
+ * and Vector
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Memory.h"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Older C libraries do not define the huge page size flags
+#if defined(__linux__) && defined(MAP_HUGETLB)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+#ifdef MORPHEUS_HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+namespace Morpheus {
+
+// Alignment of every buffer; one cache line
+static const std::size_t alignment = 64;
+
+// Zeroes the buffer with the same static partition the kernels use
+static void firstTouch(double* data, const int nblocks,
+                       const std::size_t blockSize)
+{
+  #pragma omp parallel for schedule(static)
+  for(int b=0; b<nblocks; b++)
+  {
+    double* block = data + b*blockSize;
+    for(std::size_t i=0; i<blockSize; i++)
+      block[i] = 0;
+  }
+}
+
+
+// Writes one entry of every page of a buffer that the kernel has
+// already zeroed, with the same static partition as firstTouch: block
+// b faults in the pages that start inside it
+static void prefault(double* data, const int nblocks,
+                     const std::size_t blockSize, const std::size_t pageBytes)
+{
+  const std::size_t perPage = pageBytes / sizeof(double);
+
+  #pragma omp parallel for schedule(static)
+  for(int b=0; b<nblocks; b++)
+  {
+    std::size_t begin = b*blockSize;
+    std::size_t end = begin + blockSize;
+    for(std::size_t i=(begin + perPage - 1)/perPage*perPage; i<end; i+=perPage)
+      data[i] = 0;
+  }
+}
+
+
+// Current huge page settings.  Any thread may allocate, so they are
+// atomic, and the environment is read exactly once, before the first
+// use or change of them.
+static std::atomic<HugePageMode> hugePageMode(HUGEPAGES_NONE);
+static std::atomic<std::size_t> hugePageMinBytes(2*1024*1024);
+static std::once_flag hugePageEnvironmentFlag;
+
+// Buffers that were mapped directly, with their length and pages
+struct Mapping {
+  std::size_t bytes;
+  HugePageMode mode;
+};
+static std::map<const void*, Mapping> mappings;
+static std::mutex mappingsMutex;
+// Size of mappings, so deallocate can skip the lock when it is empty
+static std::atomic<int> numMappings(0);
+
+// Applies MORPHEUS_HUGEPAGES to the settings
+static void parseHugePageEnvironment()
+{
+  const char* name = std::getenv("MORPHEUS_HUGEPAGES");
+  if(name == NULL)
+    return;
+  std::string value(name);
+  if(value == "thp")
+    hugePageMode = HUGEPAGES_TRANSPARENT;
+  else if(value == "2mb")
+    hugePageMode = HUGEPAGES_2MB;
+  else if(value == "1gb")
+    hugePageMode = HUGEPAGES_1GB;
+}
+
+// Reads MORPHEUS_HUGEPAGES the first time the settings are needed;
+// every other caller waits until it has been applied
+static void readHugePageEnvironment()
+{
+  std::call_once(hugePageEnvironmentFlag, parseHugePageEnvironment);
+}
+
+
+// Rounds n up to a multiple of m
+static std::size_t roundUp(const std::size_t n, const std::size_t m)
+{
+  return (n + m - 1) / m * m;
+}
+
+
+// Maps bytes of memory with the largest pages available, starting at
+// mode and falling back one size at a time.  On success, returns the
+// buffer and sets mode and mappedBytes to what it got.  Returns NULL if
+// nothing could be mapped at all.
+static void* mapPages(const std::size_t bytes, HugePageMode& mode,
+                      std::size_t& mappedBytes)
+{
+#ifdef __linux__
+  const std::size_t twoMB = 2*1024*1024;
+  void* ptr;
+
+#ifdef MAP_HUGETLB
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+  if(mode == HUGEPAGES_1GB)
+  {
+    mappedBytes = roundUp(bytes, (std::size_t)1024*1024*1024);
+    ptr = mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE,
+               flags | MAP_HUGE_1GB, -1, 0);
+    if(ptr != MAP_FAILED)
+      return ptr;
+    mode = HUGEPAGES_2MB;
+  }
+  if(mode == HUGEPAGES_2MB)
+  {
+    mappedBytes = roundUp(bytes, twoMB);
+    ptr = mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE,
+               flags | MAP_HUGE_2MB, -1, 0);
+    if(ptr != MAP_FAILED)
+      return ptr;
+  }
+#endif
+  mode = HUGEPAGES_TRANSPARENT;
+
+  // Over-allocate so the buffer can start on a 2 MB boundary, then
+  // give back the ends
+  mappedBytes = roundUp(bytes, twoMB);
+  std::size_t length = mappedBytes + twoMB;
+  ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(ptr == MAP_FAILED)
+    return NULL;
+  char* start = static_cast<char*>(ptr);
+  char* aligned = reinterpret_cast<char*>(
+                    roundUp(reinterpret_cast<std::size_t>(start), twoMB));
+  if(aligned > start)
+    munmap(start, aligned - start);
+  if(start + length > aligned + mappedBytes)
+    munmap(aligned + mappedBytes, start + length - (aligned + mappedBytes));
+
+#ifdef MADV_HUGEPAGE
+  if(madvise(aligned, mappedBytes, MADV_HUGEPAGE) != 0)
+    mode = HUGEPAGES_NONE;
+#else
+  mode = HUGEPAGES_NONE;
+#endif
+  return aligned;
+#else
+  (void)bytes;
+  (void)mode;
+  (void)mappedBytes;
+  return NULL;
+#endif
+}
+
+
+double* allocate(const int nblocks, const std::size_t blockSize,
+                 const AllocPolicy policy)
+{
+  assert(nblocks > 0);
+  assert(blockSize > 0);
+
+  std::size_t bytes = nblocks * blockSize * sizeof(double);
+  void* ptr = NULL;
+
+  readHugePageEnvironment();
+  HugePageMode mode = (bytes >= hugePageMinBytes.load()) ?
+                      hugePageMode.load() : HUGEPAGES_NONE;
+  std::size_t pageBytes = 0;
+
+#ifdef MORPHEUS_HAVE_LIBNUMA
+  if(policy == ALLOC_INTERLEAVED && numa_available() >= 0)
+  {
+    ptr = numa_alloc_interleaved(bytes);
+#ifdef MADV_HUGEPAGE
+    if(ptr != NULL && mode != HUGEPAGES_NONE)
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+  }
+  else
+#endif
+  if(mode != HUGEPAGES_NONE)
+  {
+    std::size_t mappedBytes;
+    ptr = mapPages(bytes, mode, mappedBytes);
+    if(ptr != NULL)
+    {
+      Mapping mapping = { mappedBytes, mode };
+      std::lock_guard<std::mutex> lock(mappingsMutex);
+      mappings[ptr] = mapping;
+      numMappings++;
+
+      // Mapped pages are already zero, so touching one entry per page
+      // places them.  The posix_memalign fallback below is not zeroed
+      // and goes through firstTouch instead.
+#ifdef __linux__
+      if(mode == HUGEPAGES_1GB)
+        pageBytes = (std::size_t)1024*1024*1024;
+      else if(mode == HUGEPAGES_2MB)
+        pageBytes = 2*1024*1024;
+      else
+        pageBytes = sysconf(_SC_PAGESIZE);
+#endif
+    }
+  }
+
+  if(ptr == NULL && posix_memalign(&ptr, alignment, bytes) != 0)
+    ptr = NULL;
+
+  if(ptr == NULL)
+    throw std::bad_alloc();
+
+  double* data = static_cast<double*>(ptr);
+  if(policy != ALLOC_UNTOUCHED)
+  {
+    if(pageBytes > 0)
+      prefault(data, nblocks, blockSize, pageBytes);
+    else
+      firstTouch(data, nblocks, blockSize);
+  }
+
+  return data;
+}
+
+
+void deallocate(double* data, const std::size_t numEntries,
+                const AllocPolicy policy)
+{
+  if(data == NULL)
+    return;
+
+#ifdef __linux__
+  if(numMappings > 0)
+  {
+    std::unique_lock<std::mutex> lock(mappingsMutex);
+    std::map<const void*, Mapping>::iterator it = mappings.find(data);
+    if(it != mappings.end())
+    {
+      std::size_t bytes = it->second.bytes;
+      mappings.erase(it);
+      numMappings--;
+      lock.unlock();
+      munmap(data, bytes);
+      return;
+    }
+  }
+#endif
+
+#ifdef MORPHEUS_HAVE_LIBNUMA
+  if(policy == ALLOC_INTERLEAVED && numa_available() >= 0)
+  {
+    numa_free(data, numEntries * sizeof(double));
+    return;
+  }
+#else
+  (void)numEntries;
+  (void)policy;
+#endif
+
+  std::free(data);
+}
+
+
+SharedBuffer::SharedBuffer(const int nblocks, const std::size_t blockSize,
+                           const AllocPolicy policy)
+  : nblocks_(nblocks), blockSize_(blockSize), policy_(policy),
+    useCount_(1), properties_(0), exposed_(false)
+{
+  data_ = allocate(nblocks_, blockSize_, policy_);
+}
+
+
+SharedBuffer::SharedBuffer(const SharedBuffer& source)
+  : nblocks_(source.nblocks_), blockSize_(source.blockSize_),
+    policy_(source.policy_), useCount_(1), properties_(0), exposed_(false)
+{
+  // Zeroing the copy first would double the cost.  The parallel copy
+  // below touches each block on the thread firstTouch would have
+  // used, and deallocate only needs the policy for interleaved memory.
+  data_ = allocate(nblocks_, blockSize_,
+                   (policy_ == ALLOC_FIRST_TOUCH) ? ALLOC_UNTOUCHED : policy_);
+
+  #pragma omp parallel for schedule(static)
+  for(int b=0; b<nblocks_; b++)
+  {
+    const double* from = source.data_ + b*blockSize_;
+    double* to = data_ + b*blockSize_;
+    for(std::size_t i=0; i<blockSize_; i++)
+      to[i] = from[i];
+  }
+}
+
+
+SharedBuffer::~SharedBuffer()
+{
+  deallocate(data_, nblocks_*blockSize_, policy_);
+}
+
+
+SharedBuffer* SharedBuffer::acquire()
+{
+  useCount_.fetch_add(1, std::memory_order_relaxed);
+  return this;
+}
+
+
+void SharedBuffer::release()
+{
+  // acq_rel so the last handle sees every other handle's accesses
+  // finished before it frees the entries
+  if(useCount_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete this;
+}
+
+
+int SharedBuffer::getUseCount() const
+{
+  return useCount_.load(std::memory_order_acquire);
+}
+
+
+SharedBuffer* SharedBuffer::detach(const bool keepValues)
+{
+  if(getUseCount() == 1)
+  {
+    if(properties_.load(std::memory_order_relaxed) != 0)
+      properties_.store(0, std::memory_order_relaxed);
+    return this;
+  }
+
+  SharedBuffer* copy = keepValues ? new SharedBuffer(*this)
+                                  : new SharedBuffer(nblocks_, blockSize_,
+                                                     policy_);
+  release();
+  return copy;
+}
+
+
+double* SharedBuffer::getData() const
+{
+  return data_;
+}
+
+
+void SharedBuffer::expose()
+{
+  // Checked first so repeated calls do not write the cache line
+  if(!exposed_.load(std::memory_order_relaxed))
+    exposed_.store(true, std::memory_order_relaxed);
+}
+
+
+AllocPolicy SharedBuffer::getPolicy() const
+{
+  return policy_;
+}
+
+
+bool SharedBuffer::getProperty(const int i, bool& value) const
+{
+  assert(i >= 0 && i < 16);
+
+  if(exposed_.load(std::memory_order_relaxed))
+    return false;
+  unsigned bits = properties_.load(std::memory_order_relaxed) >> (2*i);
+  if((bits & 1) == 0)
+    return false;
+  value = (bits & 2) != 0;
+  return true;
+}
+
+
+void SharedBuffer::setProperty(const int i, const bool value)
+{
+  assert(i >= 0 && i < 16);
+
+  if(exposed_.load(std::memory_order_relaxed))
+    return;
+  unsigned bits = value ? 3 : 1;
+  properties_.fetch_or(bits << (2*i), std::memory_order_relaxed);
+}
+
+
+void setHugePageMode(const HugePageMode mode, const std::size_t minBytes)
+{
+  // The environment must not override this later
+  readHugePageEnvironment();
+  hugePageMinBytes = minBytes;
+  hugePageMode = mode;
+}
+
+
+HugePageMode getHugePageMode()
+{
+  readHugePageEnvironment();
+  return hugePageMode;
+}
+
+
+HugePageMode getPageMode(const double* data)
+{
+  std::lock_guard<std::mutex> lock(mappingsMutex);
+  std::map<const void*, Mapping>::const_iterator it = mappings.find(data);
+  return (it == mappings.end()) ? HUGEPAGES_NONE : it->second.mode;
+}
+
+
+bool pinThreads()
+{
+#if defined(_OPENMP) && defined(__linux__)
+  cpu_set_t allowed;
+  if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return false;
+
+  // List the cores we are allowed to run on
+  int cpus[CPU_SETSIZE];
+  int ncpus = 0;
+  for(int c=0; c<CPU_SETSIZE; c++)
+  {
+    if(CPU_ISSET(c, &allowed))
+      cpus[ncpus++] = c;
+  }
+  if(ncpus == 0)
+    return false;
+
+  bool success = true;
+  #pragma omp parallel reduction(&&:success)
+  {
+    // Spread the threads evenly over the allowed cores
+    int nthreads = omp_get_num_threads();
+    int tid = omp_get_thread_num();
+    int cpu = cpus[(long)tid * ncpus / nthreads];
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    success = (sched_setaffinity(0, sizeof(mask), &mask) == 0);
+  }
+  return success;
+#else
+  return false;
+#endif
+}
+
+
+int getNumThreads()
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+
+int getNumNumaNodes()
+{
+#if defined(MORPHEUS_HAVE_LIBNUMA)
+  if(numa_available() >= 0)
+    return numa_max_node() + 1;
+  return 1;
+#elif defined(__linux__)
+  // Count the node directories exported by the kernel
+  DIR* dir = opendir("/sys/devices/system/node");
+  if(dir == NULL)
+    return 1;
+
+  int nnodes = 0;
+  struct dirent* entry;
+  while((entry = readdir(dir)) != NULL)
+  {
+    if(std::strncmp(entry->d_name, "node", 4) == 0 &&
+       entry->d_name[4] >= '0' && entry->d_name[4] <= '9')
+      nnodes++;
+  }
+  closedir(dir);
+  return (nnodes > 0) ? nnodes : 1;
+#else
+  return 1;
+#endif
+}
+
+} /* namespace Morpheus */
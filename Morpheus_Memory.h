@@ -0,0 +1,255 @@
+/**
+ * @file
+ * \brief Defines the NUMA-aware allocation routines used by Matrix
+ * and Vector
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_MEMORY_H_
+#define MORPHEUS_MEMORY_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace Morpheus {
+
+/** \brief Controls where the pages of a Matrix or Vector end up
+ *
+ * On a multi-socket node, Linux places a page on the NUMA node of
+ * the thread that first writes to it.  If one thread initializes a
+ * whole matrix, every page lands on one socket and the parallel
+ * kernels all fight over a single memory controller.
+ */
+enum AllocPolicy {
+  /** Memory is allocated but not touched.  Pages are placed wherever
+   * the caller first writes them. */
+  ALLOC_UNTOUCHED,
+  /** Memory is zeroed in parallel using the same static partition
+   * the kernels use, so each thread's rows are local to it. */
+  ALLOC_FIRST_TOUCH,
+  /** Pages are interleaved round-robin across all NUMA nodes.  This
+   * requires libnuma (build with <tt>make NUMA=1</tt>); otherwise it
+   * behaves like ::ALLOC_FIRST_TOUCH. */
+  ALLOC_INTERLEAVED
+};
+
+/** \brief Page sizes for large Matrix and Vector buffers
+ *
+ * With buffers of many GB, ordinary 4 KB pages mean millions of TLB
+ * entries and millions of page faults at first touch.  Huge pages cut
+ * both by a factor of 512 (2 MB) or 262144 (1 GB).  Explicit huge
+ * pages come from a pool the administrator reserves (for example
+ * <tt>sysctl vm.nr_hugepages=N</tt>); when the pool runs dry, each
+ * mode falls back to the next smaller one, down to ordinary pages.
+ */
+enum HugePageMode {
+  //! Ordinary pages (the default)
+  HUGEPAGES_NONE,
+  /** Transparent huge pages: the buffer is 2 MB aligned and marked
+   * with <tt>madvise(MADV_HUGEPAGE)</tt>, and the kernel backs it with
+   * 2 MB pages where it can.  Needs no reserved pool. */
+  HUGEPAGES_TRANSPARENT,
+  //! Explicit 2 MB pages, falling back to ::HUGEPAGES_TRANSPARENT
+  HUGEPAGES_2MB,
+  //! Explicit 1 GB pages, falling back to ::HUGEPAGES_2MB
+  HUGEPAGES_1GB
+};
+
+//! \name Allocation routines
+///@{
+/** \brief Allocates \a nblocks * \a blockSize doubles
+ *
+ * The memory is treated as \a nblocks contiguous blocks of
+ * \a blockSize entries.  With ::ALLOC_FIRST_TOUCH, block \a i is
+ * zeroed by the thread that owns iteration \a i of a
+ * <tt>schedule(static)</tt> loop over the blocks, which is how the
+ * Matrix kernels split rows and the Vector kernels split entries.
+ *
+ * \param[in] nblocks Number of blocks (rows of a matrix, entries of
+ * a vector)
+ * \param[in] blockSize Number of doubles per block
+ * \param[in] policy Placement policy
+ *
+ * \note The memory must be released with Morpheus::deallocate using
+ * the same size and policy.
+ */
+double* allocate(const int nblocks, const std::size_t blockSize,
+                 const AllocPolicy policy);
+
+/** \brief Sets the page size used by later allocations
+ *
+ * Only buffers of at least \a minBytes use huge pages; smaller ones
+ * would waste most of a page.  Huge-page buffers are mapped directly
+ * from the kernel, which hands them out already zeroed, so
+ * ::ALLOC_FIRST_TOUCH only has to write one entry per page to fault
+ * it in.  It still does so in parallel, with the same static
+ * partition, so the pages are placed exactly as before and the page
+ * faults are spread over all threads instead of stalling the first
+ * kernel.
+ *
+ * The initial mode can also be set with the environment variable
+ * <tt>MORPHEUS_HUGEPAGES</tt> (<tt>none</tt>, <tt>thp</tt>,
+ * <tt>2mb</tt> or <tt>1gb</tt>).  Huge pages are only available on
+ * Linux; elsewhere this setting is ignored.  With libnuma,
+ * ::ALLOC_INTERLEAVED buffers can only use transparent huge pages.
+ *
+ * This may be called from any thread.  Allocations that start after
+ * it returns use the new settings; one made at the same time may use
+ * the old mode or the old \a minBytes.
+ *
+ * \param[in] mode Page size to ask for
+ * \param[in] minBytes Smallest buffer that uses huge pages
+ */
+void setHugePageMode(const HugePageMode mode,
+                     const std::size_t minBytes=2*1024*1024);
+
+//! Returns the mode set by setHugePageMode
+HugePageMode getHugePageMode();
+
+/** \brief Returns the pages a buffer actually got
+ *
+ * This tells whether a fallback happened.  For
+ * ::HUGEPAGES_TRANSPARENT it only means the buffer was marked; the
+ * kernel may still back parts of it with ordinary pages.
+ * \param[in] data Pointer returned by Morpheus::allocate
+ */
+HugePageMode getPageMode(const double* data);
+
+/** \brief Releases memory obtained from Morpheus::allocate
+ *
+ * \param[in] data Pointer returned by Morpheus::allocate
+ * \param[in] numEntries Total number of doubles that were allocated
+ * \param[in] policy Policy the memory was allocated with
+ */
+void deallocate(double* data, const std::size_t numEntries,
+                const AllocPolicy policy);
+///@}
+
+/** \class SharedBuffer
+ * \brief Reference-counted storage shared by copies of a Matrix or
+ * Vector
+ *
+ * Copying a Matrix or Vector only increments the reference count of
+ * its buffer, so handing a large operator to many threads costs
+ * nothing.  The entries are copied the first time one of the handles
+ * is about to be written (copy on write), and only for that handle;
+ * the others keep sharing the original.
+ *
+ * The count is atomic: handles that share a buffer may be copied,
+ * read and destroyed by different threads at the same time, and a
+ * handle that sees a count of one knows every other handle is gone
+ * and that their reads have finished.  As with any object, a single
+ * handle must not be written by one thread while another uses it.
+ *
+ * The buffer also caches boolean properties of its entries, such as
+ * symmetry.  Every handle that shares the buffer sees the same
+ * cached values, and detach clears them before any entry can change.
+ * Once a handle has given out a pointer its owner may keep writing
+ * through (see expose), nothing is cached for that buffer any more,
+ * since such writes would go unnoticed.
+ */
+class SharedBuffer {
+public:
+  /** \brief Allocates \a nblocks * \a blockSize entries with
+   * Morpheus::allocate, with a reference count of one
+   */
+  SharedBuffer(const int nblocks, const std::size_t blockSize,
+               const AllocPolicy policy);
+
+  //! Adds a reference and returns \a this
+  SharedBuffer* acquire();
+
+  //! Drops a reference, and deletes the buffer if it was the last one
+  void release();
+
+  //! Returns the number of handles sharing the buffer
+  int getUseCount() const;
+
+  /** \brief Prepares the buffer to be written through one handle
+   *
+   * If other handles share the buffer, drops this handle's reference
+   * and returns a private copy; otherwise returns \a this.  Either way
+   * the cached properties of the returned buffer are cleared.
+   * \param[in] keepValues Whether the copy needs the current entries.
+   * If false, a new buffer is allocated as in the constructor and
+   * nothing is copied.
+   */
+  SharedBuffer* detach(const bool keepValues=true);
+
+  //! Returns the entries
+  double* getData() const;
+
+  /** \brief Records that a pointer to the entries has been given out
+   *
+   * Call this before returning a mutable reference or pointer that may
+   * outlive the call.  From then on getProperty finds nothing and
+   * setProperty does nothing, for as long as this buffer exists; a
+   * copy made by detach starts out unexposed.
+   */
+  void expose();
+
+  //! Returns the policy the entries were allocated with
+  AllocPolicy getPolicy() const;
+
+  /** \brief Looks up a cached property
+   *
+   * Returns false if property \a i has not been cached since the
+   * last detach, or if the buffer has been exposed; otherwise stores it in \a value and returns true.
+   * \param[in] i Property number, from 0 to 15
+   * \param[out] value Cached value
+   */
+  bool getProperty(const int i, bool& value) const;
+
+  //! Caches \a value as property \a i, unless the buffer is exposed
+  void setProperty(const int i, const bool value);
+
+private:
+  //! Copies \a source, placing the pages like \a source's policy
+  explicit SharedBuffer(const SharedBuffer& source);
+  //! Assignment is not supported
+  SharedBuffer& operator=(const SharedBuffer&);
+  //! Deallocates the entries; called by release
+  ~SharedBuffer();
+
+  //! Number of blocks passed to Morpheus::allocate
+  int nblocks_;
+  //! Number of entries per block
+  std::size_t blockSize_;
+  //! Policy the entries were allocated with
+  AllocPolicy policy_;
+  //! The entries
+  double* data_;
+  //! Number of handles sharing the buffer
+  std::atomic<int> useCount_;
+  //! Two bits per property: whether it is cached, and its value
+  std::atomic<unsigned> properties_;
+  //! Whether expose has been called
+  std::atomic<bool> exposed_;
+};
+
+//! \name Thread placement
+///@{
+/** \brief Pins each OpenMP thread to its own core
+ *
+ * First-touch placement only helps if a thread stays on the socket
+ * where it touched its pages.  Call this once, before constructing
+ * any large Matrix or Vector, with the number of threads the kernels
+ * will use.  Threads are spread evenly over the cores this process
+ * may run on, so both sockets get the same number of threads.
+ *
+ * Returns false if pinning is not supported on this platform or the
+ * library was built without OpenMP.  Setting <tt>OMP_PROC_BIND</tt>
+ * and <tt>OMP_PLACES</tt> has the same effect and takes precedence.
+ */
+bool pinThreads();
+
+//! Returns the number of threads the kernels will use
+int getNumThreads();
+
+//! Returns the number of NUMA nodes, or 1 if it cannot be determined
+int getNumNumaNodes();
+///@}
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_MEMORY_H_ */
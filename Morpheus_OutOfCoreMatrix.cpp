@@ -0,0 +1,528 @@
+/**
+ * @file
+ * \brief Defines a dense matrix class stored on disk
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_OutOfCoreMatrix.h"
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+namespace Morpheus {
+
+// The file starts with a header of one page, so the tiles after it
+// stay page aligned: the bytes "MORPHOOC", then the number of rows,
+// of columns and the tile size as 32-bit integers
+static const off_t headerBytes = 4096;
+static const char headerMagic[8] = {'M','O','R','P','H','O','O','C'};
+
+// Reads or writes exactly nbytes at offset, retrying short transfers
+static void transfer(const int fd, char* buf, std::size_t nbytes,
+                     off_t offset, const bool write)
+{
+  while(nbytes > 0)
+  {
+    ssize_t done = write ? pwrite(fd, buf, nbytes, offset)
+                         : pread(fd, buf, nbytes, offset);
+    if(done < 0 && errno == EINTR)
+      continue;
+    if(done < 0)
+      throw std::runtime_error(std::string("OutOfCoreMatrix: ") +
+                               std::strerror(errno));
+    if(done == 0)
+      throw std::runtime_error("OutOfCoreMatrix: unexpected end of file");
+    buf += done;
+    nbytes -= done;
+    offset += done;
+  }
+}
+
+
+/* Streams consecutive tiles of a file through a ring of buffers.
+ * A reader thread fills buffer t % nbuffers with tile t as soon as
+ * the consumer has released the tile that used to live there, so up
+ * to nbuffers-1 tiles are read ahead of the one being multiplied.
+ */
+class TileStream {
+public:
+  TileStream(const int fd, const std::size_t tileEntries,
+             const int ntiles, const int nbuffers)
+    : fd_(fd), tileEntries_(tileEntries), ntiles_(ntiles),
+      nbuffers_(nbuffers), nread_(0), nreleased_(0), current_(-1),
+      stop_(false), failed_(false)
+  {
+    buffers_ = allocate(nbuffers_, tileEntries_, ALLOC_UNTOUCHED);
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    reader_ = std::thread(&TileStream::readTiles, this);
+  }
+
+  ~TileStream()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    reader_.join();
+    deallocate(buffers_, nbuffers_*tileEntries_, ALLOC_UNTOUCHED);
+  }
+
+  // Releases the previous tile and waits for the next one
+  const double* next()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if(current_ >= 0)
+    {
+      nreleased_++;
+      cv_.notify_all();
+    }
+    current_++;
+    assert(current_ < ntiles_);
+    cv_.wait(lock, [this]{ return nread_ > current_ || failed_; });
+    if(failed_)
+      throw std::runtime_error(error_);
+    return buffers_ + (current_ % nbuffers_)*tileEntries_;
+  }
+
+private:
+  void readTiles()
+  {
+    const std::size_t tileBytes = tileEntries_ * sizeof(double);
+    for(int t=0; t<ntiles_; t++)
+    {
+      {
+        // Wait until the buffer this tile goes into is free
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this,t]{ return t < nreleased_ + nbuffers_ || stop_; });
+        if(stop_)
+          return;
+      }
+
+      char* buf = reinterpret_cast<char*>(buffers_ + (t % nbuffers_)*tileEntries_);
+      try
+      {
+        transfer(fd_, buf, tileBytes, headerBytes + (off_t)t*tileBytes,
+                 false);
+      }
+      catch(const std::runtime_error& e)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = e.what();
+        failed_ = true;
+        cv_.notify_all();
+        return;
+      }
+
+#ifdef POSIX_FADV_DONTNEED
+      // We will not read this tile again; keep the page cache for
+      // the tiles that are coming
+      posix_fadvise(fd_, headerBytes + (off_t)t*tileBytes, tileBytes,
+                    POSIX_FADV_DONTNEED);
+#endif
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      nread_++;
+      cv_.notify_all();
+    }
+  }
+
+  int fd_;
+  std::size_t tileEntries_;
+  int ntiles_;
+  int nbuffers_;
+  double* buffers_;
+  int nread_;
+  int nreleased_;
+  int current_;
+  bool stop_;
+  bool failed_;
+  std::string error_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread reader_;
+};
+
+
+OutOfCoreMatrix::OutOfCoreMatrix(const std::string& filename,
+                                 const int nrows, const int ncols,
+                                 const int tileSize,
+                                 const std::size_t memoryBudget)
+{
+  filename_ = filename;
+  nrows_ = nrows;
+  ncols_ = ncols;
+  tileSize_ = tileSize;
+
+  // Make sure the dimensions make sense
+  assert(nrows_ > 0);
+  assert(ncols_ > 0);
+  assert(tileSize_ > 0);
+
+  ntileRows_ = (nrows_ + tileSize_ - 1) / tileSize_;
+  ntileCols_ = (ncols_ + tileSize_ - 1) / tileSize_;
+
+  // Always double buffer, so reading overlaps computation
+  std::size_t tileBytes = (std::size_t)tileSize_*tileSize_*sizeof(double);
+  std::size_t nbuffers = memoryBudget / tileBytes;
+  if(nbuffers < 2)
+    nbuffers = 2;
+  if(nbuffers > (std::size_t)ntileRows_*ntileCols_)
+    nbuffers = (std::size_t)ntileRows_*ntileCols_;
+  nbuffers_ = (nbuffers < 2) ? 2 : (int)nbuffers;
+
+  fd_ = open(filename_.c_str(), O_RDWR | O_CREAT, 0644);
+  if(fd_ < 0)
+    throw std::runtime_error("OutOfCoreMatrix: cannot open " + filename_ +
+                             ": " + std::strerror(errno));
+
+  char header[headerBytes];
+  std::memset(header, 0, sizeof(header));
+  std::memcpy(header, headerMagic, sizeof(headerMagic));
+  std::int32_t dims[3] = {nrows_, ncols_, tileSize_};
+  std::memcpy(header + sizeof(headerMagic), dims, sizeof(dims));
+
+  // A new file gets the header, and every tile exists from the start
+  // even if it has not been written yet.  An existing file must hold
+  // exactly this layout; anything else would be read as garbage tiles.
+  off_t size = tileOffset(ntileRows_-1, ntileCols_-1) + (off_t)tileBytes;
+  off_t oldSize = lseek(fd_, 0, SEEK_END);
+  try
+  {
+    if(oldSize < 0)
+      throw std::runtime_error(std::string("OutOfCoreMatrix: ") +
+                               std::strerror(errno));
+    if(oldSize == 0)
+    {
+      transfer(fd_, header, sizeof(header), 0, true);
+      if(ftruncate(fd_, size) != 0)
+        throw std::runtime_error("OutOfCoreMatrix: cannot resize " +
+                                 filename_);
+    }
+    else
+    {
+      char oldHeader[headerBytes];
+      if(oldSize == size)
+        transfer(fd_, oldHeader, sizeof(oldHeader), 0, false);
+      if(oldSize != size ||
+         std::memcmp(oldHeader, header, sizeof(header)) != 0)
+        throw std::runtime_error("OutOfCoreMatrix: " + filename_ +
+                                 " does not hold a matrix with these "
+                                 "dimensions and tile size");
+    }
+  }
+  catch(const std::runtime_error&)
+  {
+    close(fd_);
+    throw;
+  }
+}
+
+
+OutOfCoreMatrix::~OutOfCoreMatrix()
+{
+  close(fd_);
+}
+
+
+int OutOfCoreMatrix::getNumRows() const
+{
+  return nrows_;
+}
+
+
+int OutOfCoreMatrix::getNumCols() const
+{
+  return ncols_;
+}
+
+
+int OutOfCoreMatrix::getTileSize() const
+{
+  return tileSize_;
+}
+
+
+int OutOfCoreMatrix::getNumTileRows() const
+{
+  return ntileRows_;
+}
+
+
+int OutOfCoreMatrix::getNumTileCols() const
+{
+  return ntileCols_;
+}
+
+
+int OutOfCoreMatrix::getNumBuffers() const
+{
+  return nbuffers_;
+}
+
+
+off_t OutOfCoreMatrix::tileOffset(const int tileRow, const int tileCol) const
+{
+  off_t tileBytes = (off_t)tileSize_*tileSize_*sizeof(double);
+  return headerBytes + ((off_t)tileRow*ntileCols_ + tileCol) * tileBytes;
+}
+
+
+void OutOfCoreMatrix::writeTile(const int tileRow, const int tileCol,
+                                const Matrix& tile)
+{
+  assert(tileRow >= 0 && tileRow < ntileRows_);
+  assert(tileCol >= 0 && tileCol < ntileCols_);
+  assert(tile.getNumRows() == tileSize_);
+  assert(tile.getNumCols() == tileSize_);
+
+  // Matrix stores its entries contiguously, row by row
+  transfer(fd_, (char*)&tile(0,0), (std::size_t)tileSize_*tileSize_*sizeof(double),
+           tileOffset(tileRow, tileCol), true);
+}
+
+
+void OutOfCoreMatrix::readTile(const int tileRow, const int tileCol,
+                               Matrix& tile) const
+{
+  assert(tileRow >= 0 && tileRow < ntileRows_);
+  assert(tileCol >= 0 && tileCol < ntileCols_);
+  assert(tile.getNumRows() == tileSize_);
+  assert(tile.getNumCols() == tileSize_);
+
+  transfer(fd_, (char*)&tile(0,0), (std::size_t)tileSize_*tileSize_*sizeof(double),
+           tileOffset(tileRow, tileCol), false);
+}
+
+
+void OutOfCoreMatrix::writeMatrix(const Matrix& A)
+{
+  assert(A.getNumRows() == nrows_);
+  assert(A.getNumCols() == ncols_);
+
+  Matrix tile(tileSize_, tileSize_);
+  for(int tr=0; tr<ntileRows_; tr++)
+  {
+    for(int tc=0; tc<ntileCols_; tc++)
+    {
+      for(int r=0; r<tileSize_; r++)
+      {
+        int row = tr*tileSize_ + r;
+        for(int c=0; c<tileSize_; c++)
+        {
+          int col = tc*tileSize_ + c;
+          tile(r,c) = (row < nrows_ && col < ncols_) ? A(row,col) : 0;
+        }
+      }
+      writeTile(tr, tc, tile);
+    }
+  }
+}
+
+
+void OutOfCoreMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == ncols_);
+  assert(Y.getNumElements() == nrows_);
+
+  Y.setValue(0);
+  const double* x = &X[0];
+  double* y = &Y[0];
+
+  TileStream stream(fd_, (std::size_t)tileSize_*tileSize_,
+                    ntileRows_*ntileCols_, nbuffers_);
+  for(int tr=0; tr<ntileRows_; tr++)
+  {
+    int rowStart = tr*tileSize_;
+    int nr = (rowStart + tileSize_ <= nrows_) ? tileSize_ : nrows_ - rowStart;
+    for(int tc=0; tc<ntileCols_; tc++)
+    {
+      const double* tile = stream.next();
+      int colStart = tc*tileSize_;
+      int nc = (colStart + tileSize_ <= ncols_) ? tileSize_ : ncols_ - colStart;
+
+      #pragma omp parallel for schedule(static)
+      for(int r=0; r<nr; r++)
+      {
+        const double* tileRow = tile + (std::size_t)r*tileSize_;
+        double sum = 0;
+        for(int c=0; c<nc; c++)
+          sum = sum + tileRow[c]*x[colStart + c];
+        y[rowStart + r] = y[rowStart + r] + sum;
+      }
+    }
+  }
+}
+
+
+void OutOfCoreMatrix::apply(const Vector& X, Vector& Y) const
+{
+  multiply(X, Y);
+}
+
+
+void OutOfCoreMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == nrows_);
+  assert(Y.getNumElements() == ncols_);
+
+  Y.setValue(0);
+  const double* x = &X[0];
+  double* y = &Y[0];
+
+  TileStream stream(fd_, (std::size_t)tileSize_*tileSize_,
+                    ntileRows_*ntileCols_, nbuffers_);
+  for(int tr=0; tr<ntileRows_; tr++)
+  {
+    int rowStart = tr*tileSize_;
+    int nr = (rowStart + tileSize_ <= nrows_) ? tileSize_ : nrows_ - rowStart;
+    for(int tc=0; tc<ntileCols_; tc++)
+    {
+      const double* tile = stream.next();
+      int colStart = tc*tileSize_;
+      int nc = (colStart + tileSize_ <= ncols_) ? tileSize_ : ncols_ - colStart;
+
+      // Each thread owns a range of columns of the tile
+      #pragma omp parallel for schedule(static)
+      for(int c=0; c<nc; c++)
+      {
+        double sum = 0;
+        for(int r=0; r<nr; r++)
+          sum = sum + tile[(std::size_t)r*tileSize_ + c]*x[rowStart + r];
+        y[colStart + c] = y[colStart + c] + sum;
+      }
+    }
+  }
+}
+
+
+void OutOfCoreMatrix::multiply(const Matrix& X, Matrix& Y) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumRows() == ncols_);
+  assert(Y.getNumRows() == nrows_);
+  assert(X.getNumCols() == Y.getNumCols());
+
+  const int k = X.getNumCols();
+  for(int r=0; r<nrows_; r++)
+  {
+    for(int c=0; c<k; c++)
+      Y(r,c) = 0;
+  }
+  double* y = &Y(0,0);
+
+  TileStream stream(fd_, (std::size_t)tileSize_*tileSize_,
+                    ntileRows_*ntileCols_, nbuffers_);
+  for(int tr=0; tr<ntileRows_; tr++)
+  {
+    int rowStart = tr*tileSize_;
+    int nr = (rowStart + tileSize_ <= nrows_) ? tileSize_ : nrows_ - rowStart;
+    for(int tc=0; tc<ntileCols_; tc++)
+    {
+      const double* tile = stream.next();
+      int colStart = tc*tileSize_;
+      int nc = (colStart + tileSize_ <= ncols_) ? tileSize_ : ncols_ - colStart;
+
+      // Y(rows of the tile,:) += tile * X(columns of the tile,:)
+      #pragma omp parallel for schedule(static)
+      for(int r=0; r<nr; r++)
+      {
+        const double* tileRow = tile + (std::size_t)r*tileSize_;
+        double* Yrow = y + (std::size_t)(rowStart + r)*k;
+        for(int p=0; p<nc; p++)
+        {
+          const double a = tileRow[p];
+          const double* Xrow = &X(colStart + p, 0);
+          for(int c=0; c<k; c++)
+            Yrow[c] = Yrow[c] + a*Xrow[c];
+        }
+      }
+    }
+  }
+}
+
+
+
+void OutOfCoreMatrix::sketch(const Matrix& X, Matrix& Y, const Matrix& Z,
+                             Matrix& W) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumRows() == ncols_);
+  assert(Y.getNumRows() == nrows_);
+  assert(X.getNumCols() == Y.getNumCols());
+  assert(Z.getNumCols() == nrows_);
+  assert(W.getNumCols() == ncols_);
+  assert(Z.getNumRows() == W.getNumRows());
+
+  const int k = X.getNumCols();
+  const int l = Z.getNumRows();
+  for(int r=0; r<nrows_; r++)
+  {
+    for(int c=0; c<k; c++)
+      Y(r,c) = 0;
+  }
+  double* y = &Y(0,0);
+  for(int r=0; r<l; r++)
+  {
+    for(int c=0; c<ncols_; c++)
+      W(r,c) = 0;
+  }
+  double* w = &W(0,0);
+
+  TileStream stream(fd_, (std::size_t)tileSize_*tileSize_,
+                    ntileRows_*ntileCols_, nbuffers_);
+  for(int tr=0; tr<ntileRows_; tr++)
+  {
+    int rowStart = tr*tileSize_;
+    int nr = (rowStart + tileSize_ <= nrows_) ? tileSize_ : nrows_ - rowStart;
+    for(int tc=0; tc<ntileCols_; tc++)
+    {
+      const double* tile = stream.next();
+      int colStart = tc*tileSize_;
+      int nc = (colStart + tileSize_ <= ncols_) ? tileSize_ : ncols_ - colStart;
+
+      // Y(rows of the tile,:) += tile * X(columns of the tile,:)
+      #pragma omp parallel for schedule(static)
+      for(int r=0; r<nr; r++)
+      {
+        const double* tileRow = tile + (std::size_t)r*tileSize_;
+        double* Yrow = y + (std::size_t)(rowStart + r)*k;
+        for(int p=0; p<nc; p++)
+        {
+          const double a = tileRow[p];
+          const double* Xrow = &X(colStart + p, 0);
+          for(int c=0; c<k; c++)
+            Yrow[c] = Yrow[c] + a*Xrow[c];
+        }
+      }
+
+      // W(:,columns of the tile) += Z(:,rows of the tile) * tile
+      #pragma omp parallel for schedule(static)
+      for(int i=0; i<l; i++)
+      {
+        double* Wrow = w + (std::size_t)i*ncols_ + colStart;
+        for(int r=0; r<nr; r++)
+        {
+          const double z = Z(i, rowStart + r);
+          const double* tileRow = tile + (std::size_t)r*tileSize_;
+          for(int c=0; c<nc; c++)
+            Wrow[c] = Wrow[c] + z*tileRow[c];
+        }
+      }
+    }
+  }
+}
+
+} /* namespace Morpheus */
@@ -0,0 +1,199 @@
+/**
+ * @file
+ * \brief Defines a dense matrix class stored on disk
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_OUTOFCOREMATRIX_H_
+#define MORPHEUS_OUTOFCOREMATRIX_H_
+
+#include "Morpheus_Matrix.h"
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+namespace Morpheus {
+
+/** \class OutOfCoreMatrix
+ * \brief Stores a dense matrix on disk, one square tile at a time
+ *
+ * The matrix is split into tiles of \a tileSize x \a tileSize entries,
+ * which are stored in the file row of tiles by row of tiles.  The
+ * multiplication routines read the tiles in exactly that order, so the
+ * disk only ever sees one long sequential read.  A background thread
+ * reads ahead into a ring of tile buffers while the current tile is
+ * being multiplied; the number of buffers is set by the memory budget.
+ *
+ * Tiles on the bottom and right edges of the matrix are stored at full
+ * size; the entries past the end of the matrix are never used.  The
+ * tiles follow a one-page header that records the dimensions and the
+ * tile size.
+ *
+ * I/O errors are reported by throwing std::runtime_error.
+ *
+ * \example Morpheus_OutOfCoreMatrix_multiplyTest.cpp
+ * Demonstrates how to store a matrix on disk and multiply by it
+ */
+class OutOfCoreMatrix : public LinearOperator {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Constructor
+   *
+   * Opens (creating it if necessary) the file that backs the matrix.
+   * An existing file is reused as is, so a matrix written by an
+   * earlier run can be multiplied without rewriting it.  It must have
+   * been created with the same \a nrows, \a ncols and \a tileSize;
+   * otherwise std::runtime_error is thrown.
+   *
+   * \param[in] filename File holding the tiles
+   * \param[in] nrows Number of rows
+   * \param[in] ncols Number of columns
+   * \param[in] tileSize Number of rows and columns in each tile
+   * \param[in] memoryBudget Number of bytes the multiplication
+   * routines may use for tile buffers.  At least two tiles are always
+   * buffered, so that reading overlaps computation.
+   */
+  OutOfCoreMatrix(const std::string& filename, const int nrows,
+                  const int ncols, const int tileSize,
+                  const std::size_t memoryBudget);
+
+  /** \brief Destructor
+   *
+   * Closes the file; the file itself is left on disk.
+   */
+  ~OutOfCoreMatrix();
+  ///@}
+
+  //! \name Accessor functions
+  ///@{
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+
+  //! Returns the number of rows and columns in each tile
+  int getTileSize() const;
+
+  //! Returns the number of tiles in each column of tiles
+  int getNumTileRows() const;
+
+  //! Returns the number of tiles in each row of tiles
+  int getNumTileCols() const;
+
+  //! Returns the number of tiles the multiplication routines buffer
+  int getNumBuffers() const;
+  ///@}
+
+  //! \name I/O functions
+  ///@{
+  /** \brief Writes one tile to disk
+   *
+   * \param[in] tileRow Row of the tile, between 0 and
+   * getNumTileRows()-1
+   * \param[in] tileCol Column of the tile, between 0 and
+   * getNumTileCols()-1
+   * \param[in] tile A \a tileSize x \a tileSize matrix.  Entry (r,c)
+   * is entry (tileRow*tileSize + r, tileCol*tileSize + c) of the
+   * out-of-core matrix.
+   */
+  void writeTile(const int tileRow, const int tileCol, const Matrix& tile);
+
+  /** \brief Reads one tile from disk
+   *
+   * \param[in] tileRow Row of the tile
+   * \param[in] tileCol Column of the tile
+   * \param[out] tile A \a tileSize x \a tileSize matrix
+   */
+  void readTile(const int tileRow, const int tileCol, Matrix& tile) const;
+
+  /** \brief Writes an entire in-core matrix to disk
+   *
+   * \param[in] A Matrix with the same dimensions as \a this
+   */
+  void writeMatrix(const Matrix& A);
+  ///@}
+
+  //! \name Multiplication routines
+  ///@{
+  /** \brief Computes a matrix-vector multiplication
+   *
+   * Reads the whole file once, sequentially.
+   * \param[in] X vector to be multiplied
+   * \param[out] Y result of multiplication
+   *
+   * \note As with Matrix::multiply, \a Y must already have one entry
+   * per row and \a X one entry per column.
+   */
+  void multiply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes \a Y = \a this^T * \a X
+   *
+   * Reads the whole file once, sequentially, like multiply.
+   */
+  void applyTranspose(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes a matrix-matrix multiplication
+   *
+   * Reads the whole file once, sequentially, no matter how many
+   * columns \a X has.  \a X and \a Y are held in memory.
+   * \param[in] X matrix to be multiplied
+   * \param[out] Y result of multiplication
+   *
+   * \note The number of rows of \a X must equal the number of columns
+   * of \a this, the number of rows of \a Y must equal the number of
+   * rows of \a this, and \a X and \a Y must have the same number of
+   * columns.
+   */
+  void multiply(const Matrix& X, Matrix& Y) const;
+
+  /** \brief Multiplies by a matrix on each side in a single pass
+   *
+   * Computes \a Y = A * \a X and \a W = \a Z * A while reading the file
+   * once, sequentially, so both sketches of a randomized low-rank
+   * approximation cost one read of the matrix.
+   * \param[in] X matrix to be multiplied on the right
+   * \param[out] Y A * \a X
+   * \param[in] Z matrix to be multiplied on the left
+   * \param[out] W \a Z * A
+   *
+   * \note The dimensions must be consistent, as in multiply, or the
+   * program terminates.
+   */
+  void sketch(const Matrix& X, Matrix& Y, const Matrix& Z, Matrix& W) const;
+  ///@}
+
+private:
+  //! Copying would close the file twice, so it is not allowed
+  OutOfCoreMatrix(const OutOfCoreMatrix&);
+  //! Copying would close the file twice, so it is not allowed
+  OutOfCoreMatrix& operator=(const OutOfCoreMatrix&);
+
+  //! Returns the byte offset of a tile in the file
+  off_t tileOffset(const int tileRow, const int tileCol) const;
+
+  //! Name of the backing file
+  std::string filename_;
+  //! File descriptor of the backing file
+  int fd_;
+  //! Number of rows
+  int nrows_;
+  //! Number of columns
+  int ncols_;
+  //! Number of rows and columns in each tile
+  int tileSize_;
+  //! Number of tiles in each column of tiles
+  int ntileRows_;
+  //! Number of tiles in each row of tiles
+  int ntileCols_;
+  //! Number of tiles buffered by the multiplication routines
+  int nbuffers_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_OUTOFCOREMATRIX_H_ */
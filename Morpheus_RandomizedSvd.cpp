@@ -0,0 +1,596 @@
+/**
+ * @file
+ * \brief Defines a randomized truncated singular value decomposition
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_RandomizedSvd.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace Morpheus {
+
+// Number of columns in each panel of the blocked QR
+static const int qrBlockSize = 16;
+
+// Number of extra Gaussian vectors used to estimate the out-of-core error
+static const int errorSamples = 10;
+
+
+// At = A^T
+static void transpose(const Matrix& A, Matrix& At)
+{
+  const int nrows = A.getNumRows(), ncols = A.getNumCols();
+  assert(At.getNumRows() == ncols && At.getNumCols() == nrows);
+
+  // Detach At once, before the threads write to it
+  double* at = &At(0,0);
+
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<ncols; r++)
+  {
+    for(int c=0; c<nrows; c++)
+      at[(std::size_t)r*nrows + c] = A(c,r);
+  }
+}
+
+
+// Entry i of Householder vector c0+p, stored below the diagonal of Y
+// with an implicit 1 on the diagonal
+static inline double reflectorEntry(const Matrix& Y, const int i,
+                                    const int c0, const int p)
+{
+  if(i < c0+p)
+    return 0;
+  if(i == c0+p)
+    return 1;
+  return Y(i,c0+p);
+}
+
+
+// Replaces columns cbegin..cend-1 of rows c0..m-1 of A by
+// (I - V*op(T)*V^T) times themselves, where V holds the nb Householder
+// vectors of the panel starting at column c0 of Y, and op(T) is T or
+// T^T.  Both products with V are O(m*nb*width) and threaded by rows.
+static void applyBlockReflector(const Matrix& Y, const int c0, const int nb,
+                                const std::vector<double>& T,
+                                const bool transposeT, Matrix& A,
+                                const int cbegin, const int cend)
+{
+  const int m = Y.getNumRows();
+  const int width = cend - cbegin;
+  if(width <= 0)
+    return;
+
+  // Detach A once, before the threads touch it.  A may be Y itself;
+  // both names then refer to the detached entries.
+  const std::size_t lda = A.getNumCols();
+  double* a = &A(0,0);
+
+  // M = V^T * A
+  std::vector<double> M((std::size_t)nb*width, 0);
+  #pragma omp parallel
+  {
+    std::vector<double> local((std::size_t)nb*width, 0);
+
+    #pragma omp for schedule(static)
+    for(int i=c0; i<m; i++)
+    {
+      const double* Arow = a + i*lda + cbegin;
+      for(int p=0; p<nb; p++)
+      {
+        const double v = reflectorEntry(Y, i, c0, p);
+        if(v == 0)
+          continue;
+        for(int c=0; c<width; c++)
+          local[p*width + c] += v*Arow[c];
+      }
+    }
+
+    #pragma omp critical
+    for(std::size_t e=0; e<local.size(); e++)
+      M[e] += local[e];
+  }
+
+  // M = op(T) * M, with T upper triangular
+  std::vector<double> TM((std::size_t)nb*width, 0);
+  for(int p=0; p<nb; p++)
+  {
+    for(int q=0; q<nb; q++)
+    {
+      const double t = transposeT ? T[q*nb + p] : T[p*nb + q];
+      if(t == 0)
+        continue;
+      for(int c=0; c<width; c++)
+        TM[p*width + c] += t*M[q*width + c];
+    }
+  }
+
+  // A -= V * M
+  #pragma omp parallel for schedule(static)
+  for(int i=c0; i<m; i++)
+  {
+    double* Arow = a + i*lda + cbegin;
+    for(int p=0; p<nb; p++)
+    {
+      const double v = reflectorEntry(Y, i, c0, p);
+      if(v == 0)
+        continue;
+      for(int c=0; c<width; c++)
+        Arow[c] -= v*TM[p*width + c];
+    }
+  }
+}
+
+
+// Replaces the m x l matrix Y (m >= l) by an orthonormal basis of its
+// column space, computed with a blocked Householder QR.  Each panel of
+// qrBlockSize columns is factored one column at a time, and its
+// reflectors are then applied to the rest of Y together, in the
+// compact WY form I - V*T*V^T.  Columns that are linearly dependent on
+// the previous ones are replaced by arbitrary orthonormal directions.
+static void orthonormalize(Matrix& Y)
+{
+  const int m = Y.getNumRows(), l = Y.getNumCols();
+  assert(m >= l);
+
+  // Detach Y once; the threads below only use this pointer
+  double* y = &Y(0,0);
+
+  const int npanels = (l + qrBlockSize - 1) / qrBlockSize;
+  std::vector<std::vector<double> > T(npanels);
+  std::vector<double> w(qrBlockSize);
+
+  for(int panel=0; panel<npanels; panel++)
+  {
+    const int c0 = panel*qrBlockSize;
+    const int nb = std::min(qrBlockSize, l - c0);
+    std::vector<double> tau(nb, 0);
+
+    // Unblocked QR of the panel
+    for(int p=0; p<nb; p++)
+    {
+      const int j = c0 + p;
+      double xnorm2 = 0;
+      #pragma omp parallel for schedule(static) reduction(+:xnorm2)
+      for(int i=j+1; i<m; i++)
+        xnorm2 += y[(std::size_t)i*l + j]*y[(std::size_t)i*l + j];
+
+      const double alpha = Y(j,j);
+      if(xnorm2 == 0)
+        continue;
+      double beta = std::sqrt(alpha*alpha + xnorm2);
+      if(alpha > 0)
+        beta = -beta;
+      tau[p] = (beta - alpha) / beta;
+      const double scale = 1 / (alpha - beta);
+      #pragma omp parallel for schedule(static)
+      for(int i=j+1; i<m; i++)
+        y[(std::size_t)i*l + j] *= scale;
+      Y(j,j) = beta;
+
+      // Apply the reflector to the rest of the panel
+      const int width = c0 + nb - (j+1);
+      for(int c=0; c<width; c++)
+        w[c] = Y(j,j+1+c);
+      for(int i=j+1; i<m; i++)
+      {
+        const double v = Y(i,j);
+        for(int c=0; c<width; c++)
+          w[c] += v*Y(i,j+1+c);
+      }
+      for(int c=0; c<width; c++)
+        w[c] *= tau[p];
+      for(int c=0; c<width; c++)
+        Y(j,j+1+c) -= w[c];
+      #pragma omp parallel for schedule(static)
+      for(int i=j+1; i<m; i++)
+      {
+        double* Yrow = y + (std::size_t)i*l;
+        const double v = Yrow[j];
+        for(int c=0; c<width; c++)
+          Yrow[j+1+c] -= v*w[c];
+      }
+    }
+
+    // T such that H_0 * ... * H_{nb-1} = I - V*T*V^T; G = V^T*V
+    std::vector<double> G((std::size_t)nb*nb, 0);
+    for(int i=c0; i<m; i++)
+    {
+      for(int p=0; p<nb; p++)
+      {
+        const double vp = reflectorEntry(Y, i, c0, p);
+        if(vp == 0)
+          continue;
+        for(int q=p; q<nb; q++)
+          G[p*nb + q] += vp*reflectorEntry(Y, i, c0, q);
+      }
+    }
+    std::vector<double>& Tp = T[panel];
+    Tp.assign((std::size_t)nb*nb, 0);
+    for(int q=0; q<nb; q++)
+    {
+      Tp[q*nb + q] = tau[q];
+      for(int p=0; p<q; p++)
+      {
+        double sum = 0;
+        for(int r=p; r<q; r++)
+          sum += Tp[p*nb + r]*G[r*nb + q];
+        Tp[p*nb + q] = -tau[q]*sum;
+      }
+    }
+
+    // Q^T * (trailing columns)
+    applyBlockReflector(Y, c0, nb, Tp, true, Y, c0 + nb, l);
+  }
+
+  // Q = H_0 * ... * H_{l-1} * [I; 0], applying the panels last to first
+  Matrix Q(m, l);
+  for(int j=0; j<l; j++)
+    Q(j,j) = 1;
+  for(int panel=npanels-1; panel>=0; panel--)
+  {
+    const int c0 = panel*qrBlockSize;
+    const int nb = std::min(qrBlockSize, l - c0);
+    applyBlockReflector(Y, c0, nb, T[panel], false, Q, c0, l);
+  }
+
+  const Matrix& constQ = Q;
+  #pragma omp parallel for schedule(static)
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<l; c++)
+      y[(std::size_t)r*l + c] = constQ(r,c);
+  }
+}
+
+
+// One-sided Jacobi: applies plane rotations to the rows of the l x l
+// matrix C, and the same rotations to R (initially I), until the rows
+// of C are mutually orthogonal.  Then C = R^T * (R*C) is an SVD, with
+// the singular values being the norms of the rows of R*C.
+static void jacobiRows(Matrix& C, Matrix& R)
+{
+  const int l = C.getNumRows();
+  bool rotated = true;
+  for(int sweep=0; sweep<100 && rotated; sweep++)
+  {
+    rotated = false;
+    for(int p=0; p<l-1; p++)
+    {
+      for(int q=p+1; q<l; q++)
+      {
+        double a = 0, b = 0, c = 0;
+        for(int k=0; k<l; k++)
+        {
+          a += C(p,k)*C(p,k);
+          b += C(q,k)*C(q,k);
+          c += C(p,k)*C(q,k);
+        }
+        if(c == 0 || std::abs(c) <= DBL_EPSILON*std::sqrt(a*b))
+          continue;
+        rotated = true;
+
+        const double zeta = (b - a) / (2*c);
+        const double t = ((zeta >= 0) ? 1 : -1) /
+                         (std::abs(zeta) + std::sqrt(1 + zeta*zeta));
+        const double cs = 1 / std::sqrt(1 + t*t);
+        const double sn = cs*t;
+        for(int k=0; k<l; k++)
+        {
+          double cp = C(p,k), cq = C(q,k);
+          C(p,k) = cs*cp - sn*cq;
+          C(q,k) = sn*cp + cs*cq;
+          double rp = R(p,k), rq = R(q,k);
+          R(p,k) = cs*rp - sn*rq;
+          R(q,k) = sn*rp + cs*rq;
+        }
+      }
+    }
+  }
+}
+
+
+// Orders the rows of the Jacobi result by decreasing norm
+struct RowNormOrder {
+  const std::vector<double>* norms;
+  bool operator()(const int a, const int b) const
+  {
+    return (*norms)[a] > (*norms)[b];
+  }
+};
+
+
+RandomizedSvd::RandomizedSvd(const int rank, const int oversampling,
+                             const unsigned seed)
+{
+  rank_ = rank;
+  oversampling_ = oversampling;
+  seed_ = seed;
+  U_ = NULL;
+  Vt_ = NULL;
+  error_ = 0;
+  numPasses_ = 0;
+
+  // Make sure the sizes make sense
+  assert(rank_ > 0);
+  assert(oversampling_ >= 0);
+}
+
+
+RandomizedSvd::~RandomizedSvd()
+{
+  delete U_;
+  delete Vt_;
+}
+
+
+void RandomizedSvd::fillGaussian(Matrix& M)
+{
+  const int nrows = M.getNumRows(), ncols = M.getNumCols();
+  const double twoPi = 6.28318530717958647693;
+
+  // Box-Muller on a 64-bit linear congruential generator, using the
+  // top 53 bits of each state for a uniform number in (0,1]
+  bool haveSpare = false;
+  double spare = 0;
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+    {
+      if(haveSpare)
+      {
+        M(r,c) = spare;
+        haveSpare = false;
+        continue;
+      }
+      double u[2];
+      for(int k=0; k<2; k++)
+      {
+        seed_ = seed_ * 6364136223846793005UL + 1442695040888963407UL;
+        u[k] = ((seed_ >> 11) + 1.0) / 9007199254740992.0;
+      }
+      double radius = std::sqrt(-2*std::log(u[0]));
+      M(r,c) = radius*std::cos(twoPi*u[1]);
+      spare = radius*std::sin(twoPi*u[1]);
+      haveSpare = true;
+    }
+  }
+}
+
+
+double RandomizedSvd::factorProjection(const Matrix& Q, Matrix& B)
+{
+  const int m = Q.getNumRows();
+  const int l = B.getNumRows(), n = B.getNumCols();
+  assert(Q.getNumCols() == l);
+
+  // B = C * Qb^T, where Qb is an orthonormal basis of the rows of B
+  // and C = B * Qb is only l x l
+  Matrix Qb(n, l), QbT(l, n), C(l, l), R(l, l);
+  transpose(B, Qb);
+  orthonormalize(Qb);
+  transpose(Qb, QbT);
+  B.multiply(Qb, C);
+
+  // C = R^T * (R*C), where the rows of R*C are orthogonal
+  for(int i=0; i<l; i++)
+    R(i,i) = 1;
+  jacobiRows(C, R);
+
+  std::vector<double> sigma(l);
+  std::vector<int> order(l);
+  for(int i=0; i<l; i++)
+  {
+    double sum = 0;
+    for(int k=0; k<l; k++)
+      sum += C(i,k)*C(i,k);
+    sigma[i] = std::sqrt(sum);
+    order[i] = i;
+  }
+  RowNormOrder byNorm;
+  byNorm.norms = &sigma;
+  std::sort(order.begin(), order.end(), byNorm);
+
+  // The leading left singular vectors of C are rows of R, and the
+  // right ones are the normalized rows of R*C
+  Matrix Uc(l, rank_), VcT(rank_, l);
+  double captured = 0;
+  S_.assign(rank_, 0);
+  for(int j=0; j<rank_; j++)
+  {
+    const int i = order[j];
+    S_[j] = sigma[i];
+    captured += sigma[i]*sigma[i];
+    for(int k=0; k<l; k++)
+    {
+      Uc(k,j) = R(i,k);
+      VcT(j,k) = (sigma[i] > 0) ? C(i,k) / sigma[i] : 0;
+    }
+  }
+
+  delete U_;
+  delete Vt_;
+  U_ = new Matrix(m, rank_);
+  Vt_ = new Matrix(rank_, n);
+  Q.multiply(Uc, *U_);
+  VcT.multiply(QbT, *Vt_);
+  return captured;
+}
+
+
+void RandomizedSvd::compute(const Matrix& A, const int powerIterations)
+{
+  const int m = A.getNumRows(), n = A.getNumCols();
+  const int l = rank_ + oversampling_;
+
+  // Make sure the sizes make sense
+  assert(l <= m && l <= n);
+  assert(powerIterations >= 0);
+
+  // Y = (A*A^T)^q * A * Omega, orthonormalizing after every product
+  Matrix Omega(n, l), Y(m, l), Yt(l, m), Z(l, n);
+  fillGaussian(Omega);
+  A.multiply(Omega, Y);
+  numPasses_ = 1;
+  for(int it=0; it<powerIterations; it++)
+  {
+    orthonormalize(Y);
+    transpose(Y, Yt);
+    Yt.multiply(A, Z);
+    transpose(Z, Omega);
+    orthonormalize(Omega);
+    A.multiply(Omega, Y);
+    numPasses_ += 2;
+  }
+
+  // B = Q^T * A
+  orthonormalize(Y);
+  transpose(Y, Yt);
+  Yt.multiply(A, Z);
+  numPasses_++;
+
+  double normA2 = 0;
+  #pragma omp parallel for schedule(static) reduction(+:normA2)
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<n; c++)
+      normA2 += A(r,c)*A(r,c);
+  }
+
+  // U*S*V^T is the orthogonal projection of A onto the span of U, so
+  // ||A - U*S*V^T||^2 = ||A||^2 - ||S||^2
+  double captured = factorProjection(Y, Z);
+  error_ = std::sqrt(std::max(normA2 - captured, 0.0));
+}
+
+
+void RandomizedSvd::compute(const OutOfCoreMatrix& A)
+{
+  const int m = A.getNumRows(), n = A.getNumCols();
+  const int l = rank_ + oversampling_;
+  const int l2 = 2*l + 1;
+
+  // Make sure the sizes make sense
+  assert(l2 <= m && l2 <= n);
+
+  // Range sketch Y = A*Omega, co-range sketch W = Psi*A, and s extra
+  // rows Theta*A for the error estimate, all in one pass
+  Matrix Omega(n, l), Y(m, l);
+  Matrix Psi(l2 + errorSamples, m), W(l2 + errorSamples, n);
+  fillGaussian(Omega);
+  fillGaussian(Psi);
+  A.sketch(Omega, Y, Psi, W);
+  numPasses_ = 1;
+  orthonormalize(Y);
+
+  // Q^T*A ~ X = argmin ||(Psi*Q)*X - Psi*A||, since Psi*A ~ Psi*Q*Q^T*A.
+  // With Psi*Q = P*Rp, X = Rp^{-1} * P^T * (Psi*A).
+  Matrix PsiQ(l2 + errorSamples, l);
+  Psi.multiply(Y, PsiQ);
+  Matrix P(l2, l), Pt(l, l2), W1(l2, n), Rp(l, l), X(l, n);
+  for(int r=0; r<l2; r++)
+  {
+    for(int c=0; c<l; c++)
+      P(r,c) = PsiQ(r,c);
+    for(int c=0; c<n; c++)
+      W1(r,c) = W(r,c);
+  }
+  orthonormalize(P);
+  transpose(P, Pt);
+  Matrix PsiQ1(l2, l);
+  for(int r=0; r<l2; r++)
+  {
+    for(int c=0; c<l; c++)
+      PsiQ1(r,c) = PsiQ(r,c);
+  }
+  Pt.multiply(PsiQ1, Rp);
+  Pt.multiply(W1, X);
+
+  // Back substitution with the upper triangle of Rp
+  for(int i=l-1; i>=0; i--)
+  {
+    double* Xi = &X(i,0);
+    for(int j=i+1; j<l; j++)
+    {
+      const double rij = Rp(i,j);
+      const double* Xj = &X(j,0);
+      for(int c=0; c<n; c++)
+        Xi[c] -= rij*Xj[c];
+    }
+    const double scale = 1 / Rp(i,i);
+    for(int c=0; c<n; c++)
+      Xi[c] *= scale;
+  }
+  factorProjection(Y, X);
+
+  // E||Theta*(A - U*S*V^T)||^2 = s*||A - U*S*V^T||^2 for Gaussian Theta
+  Matrix Theta(errorSamples, m), ThetaU(errorSamples, rank_);
+  Matrix ThetaApprox(errorSamples, n);
+  for(int r=0; r<errorSamples; r++)
+  {
+    for(int c=0; c<m; c++)
+      Theta(r,c) = Psi(l2 + r, c);
+  }
+  Theta.multiply(*U_, ThetaU);
+  for(int r=0; r<errorSamples; r++)
+  {
+    for(int c=0; c<rank_; c++)
+      ThetaU(r,c) *= S_[c];
+  }
+  ThetaU.multiply(*Vt_, ThetaApprox);
+  double sum = 0;
+  for(int r=0; r<errorSamples; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      double diff = W(l2 + r, c) - ThetaApprox(r,c);
+      sum += diff*diff;
+    }
+  }
+  error_ = std::sqrt(sum / errorSamples);
+}
+
+
+int RandomizedSvd::getRank() const
+{
+  return rank_;
+}
+
+
+const Matrix& RandomizedSvd::getU() const
+{
+  assert(U_ != NULL);
+  return *U_;
+}
+
+
+double RandomizedSvd::getSingularValue(const int i) const
+{
+  assert(i >= 0 && i < (int)S_.size());
+  return S_[i];
+}
+
+
+const Matrix& RandomizedSvd::getVt() const
+{
+  assert(Vt_ != NULL);
+  return *Vt_;
+}
+
+
+double RandomizedSvd::getErrorEstimate() const
+{
+  return error_;
+}
+
+
+int RandomizedSvd::getNumPasses() const
+{
+  return numPasses_;
+}
+
+} /* namespace Morpheus */
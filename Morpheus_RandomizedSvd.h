@@ -0,0 +1,152 @@
+/**
+ * @file
+ * \brief Defines a randomized truncated singular value decomposition
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_RANDOMIZEDSVD_H_
+#define MORPHEUS_RANDOMIZEDSVD_H_
+
+#include "Morpheus_Matrix.h"
+#include "Morpheus_OutOfCoreMatrix.h"
+#include <vector>
+
+namespace Morpheus {
+
+/** \class RandomizedSvd
+ * \brief Computes a rank-\a k approximation A ~ U * S * V^T
+ *
+ * The range of A is found by multiplying it by a block of \a k + \a p
+ * Gaussian random vectors (\a p is the oversampling) and
+ * orthonormalizing the product with a blocked Householder QR.  The
+ * products with A are the only operations that touch all of A, and
+ * they go through Matrix::multiply, so almost all of the work is
+ * GEMM.  A is then projected onto that range, and the SVD of the
+ * small projected matrix is computed with one-sided Jacobi.
+ *
+ * For an in-core Matrix, \a q power iterations multiply by
+ * (A*A^T)^\a q first, which sharpens the result when the singular
+ * values decay slowly, at the cost of 2\a q more passes over A.
+ *
+ * For an OutOfCoreMatrix, the whole computation reads the file once:
+ * both the range sketch A*Omega and a co-range sketch Psi*A are formed
+ * in the same sequential pass (OutOfCoreMatrix::sketch), and the
+ * projection of A is recovered from Psi*A by least squares instead of
+ * being recomputed.  This is less accurate than the in-core version,
+ * which is why the co-range sketch has 2(\a k+\a p)+1 rows.
+ *
+ * In both cases getErrorEstimate returns an estimate of the Frobenius
+ * norm of A - U*S*V^T.
+ *
+ * \example Morpheus_RandomizedSvd_Tests.cpp
+ * Demonstrates the usage of the randomized SVD
+ */
+class RandomizedSvd {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Constructor
+   *
+   * \param[in] rank Number of singular triplets to compute
+   * \param[in] oversampling Number of extra random vectors
+   * \param[in] seed Seed of the random number generator; the same seed
+   * gives the same result
+   *
+   * If \a rank is not positive or \a oversampling is negative, the
+   * program terminates.
+   */
+  RandomizedSvd(const int rank, const int oversampling=10,
+                const unsigned seed=1);
+
+  /** \brief Destructor
+   *
+   * Deallocates the factors
+   */
+  ~RandomizedSvd();
+  ///@}
+
+  //! \name Computation
+  ///@{
+  /** \brief Computes the approximation of an in-core matrix
+   *
+   * \param[in] A Matrix to approximate.  \a rank + \a oversampling
+   * must not exceed either of its dimensions, or the program
+   * terminates.
+   * \param[in] powerIterations Number of power iterations \a q
+   */
+  void compute(const Matrix& A, const int powerIterations=2);
+
+  /** \brief Computes the approximation of a matrix stored on disk
+   *
+   * Reads the file exactly once.  2(\a rank + \a oversampling)+1 must
+   * not exceed either dimension of \a A, or the program terminates.
+   */
+  void compute(const OutOfCoreMatrix& A);
+  ///@}
+
+  //! \name Results
+  ///@{
+  //! Returns the number of singular triplets
+  int getRank() const;
+
+  //! Returns the left singular vectors, an nrows x rank matrix
+  const Matrix& getU() const;
+
+  //! Returns singular value \a i, largest first
+  double getSingularValue(const int i) const;
+
+  //! Returns the right singular vectors transposed, a rank x ncols matrix
+  const Matrix& getVt() const;
+
+  /** \brief Returns an estimate of ||A - U*S*V^T|| in the Frobenius norm
+   *
+   * In-core, this is computed from ||A|| and the singular values, so it
+   * is exact up to rounding errors of about sqrt(machine epsilon) times
+   * ||A||.  Out-of-core, it is estimated from a few extra Gaussian
+   * vectors added to the co-range sketch; it is typically within a few
+   * tens of percent.
+   */
+  double getErrorEstimate() const;
+
+  //! Returns the number of passes over A used by the last computation
+  int getNumPasses() const;
+  ///@}
+
+private:
+  //! Copying is not supported
+  RandomizedSvd(const RandomizedSvd&);
+  //! Copying is not supported
+  RandomizedSvd& operator=(const RandomizedSvd&);
+
+  //! Fills \a M with independent standard normal entries
+  void fillGaussian(Matrix& M);
+
+  /** \brief Computes the SVD of the small matrix \a B
+   *
+   * On return, U_ = \a Q * (left singular vectors of \a B), S_ and Vt_
+   * hold the leading rank_ triplets, and the return value is the sum of
+   * their squared singular values.
+   */
+  double factorProjection(const Matrix& Q, Matrix& B);
+
+  //! Number of singular triplets
+  int rank_;
+  //! Number of extra random vectors
+  int oversampling_;
+  //! State of the random number generator
+  unsigned long seed_;
+  //! Left singular vectors
+  Matrix* U_;
+  //! Singular values, largest first
+  std::vector<double> S_;
+  //! Right singular vectors, transposed
+  Matrix* Vt_;
+  //! Estimate of the approximation error
+  double error_;
+  //! Number of passes over A
+  int numPasses_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_RANDOMIZEDSVD_H_ */
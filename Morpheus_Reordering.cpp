@@ -0,0 +1,315 @@
+/**
+ * @file
+ * \brief Defines orderings that improve the locality of sparse matrices
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Reordering.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Morpheus {
+
+// Graph of A + A^T without self loops, plus the scratch space the
+// breadth-first searches share.  Each search works on one region of
+// the graph: the vertices whose region_ entry equals its id.
+class OrderingGraph {
+public:
+  OrderingGraph(const CsrMatrix& A)
+  {
+    // Make sure the matrix is square
+    assert(A.getNumRows() == A.getNumCols());
+
+    n_ = A.getNumRows();
+    const int* rowPtr = A.getRowPtr();
+    const int* colInd = A.getColIndices();
+
+    // Every off-diagonal entry links both of its vertices
+    xadj_.assign(n_+1, 0);
+    for(int r=0; r<n_; r++)
+    {
+      for(int k=rowPtr[r]; k<rowPtr[r+1]; k++)
+      {
+        if(colInd[k] != r)
+        {
+          xadj_[r+1]++;
+          xadj_[colInd[k]+1]++;
+        }
+      }
+    }
+    for(int v=0; v<n_; v++)
+      xadj_[v+1] += xadj_[v];
+
+    adj_.resize(xadj_[n_]);
+    std::vector<int> next(xadj_.begin(), xadj_.end()-1);
+    for(int r=0; r<n_; r++)
+    {
+      for(int k=rowPtr[r]; k<rowPtr[r+1]; k++)
+      {
+        if(colInd[k] != r)
+        {
+          adj_[next[r]++] = colInd[k];
+          adj_[next[colInd[k]]++] = r;
+        }
+      }
+    }
+
+    // Symmetric entries appear twice; remove the duplicates
+    int pos = 0;
+    int begin = 0;
+    for(int v=0; v<n_; v++)
+    {
+      int end = xadj_[v+1];
+      std::sort(adj_.begin() + begin, adj_.begin() + end);
+      xadj_[v] = pos;
+      for(int k=begin; k<end; k++)
+      {
+        if(k == begin || adj_[k] != adj_[k-1])
+          adj_[pos++] = adj_[k];
+      }
+      begin = end;
+    }
+    xadj_[n_] = pos;
+    adj_.resize(pos);
+
+    region_.assign(n_, 0);
+    mark_.assign(n_, -1);
+    stamp_ = 0;
+    nextRegion_ = 1;
+  }
+
+  int degree(const int v) const
+  {
+    return xadj_[v+1] - xadj_[v];
+  }
+
+  // Breadth-first search from root within root's region.  order holds
+  // the vertices level by level; level l is order[levelPtr[l]] through
+  // order[levelPtr[l+1]-1].
+  void levels(const int root, std::vector<int>& order,
+              std::vector<int>& levelPtr)
+  {
+    int id = region_[root];
+    stamp_++;
+    order.clear();
+    levelPtr.clear();
+    order.push_back(root);
+    mark_[root] = stamp_;
+    levelPtr.push_back(0);
+
+    std::size_t levelBegin = 0;
+    while(levelBegin < order.size())
+    {
+      std::size_t levelEnd = order.size();
+      levelPtr.push_back((int)levelEnd);
+      for(std::size_t i=levelBegin; i<levelEnd; i++)
+      {
+        int v = order[i];
+        for(int k=xadj_[v]; k<xadj_[v+1]; k++)
+        {
+          int w = adj_[k];
+          if(region_[w] == id && mark_[w] != stamp_)
+          {
+            mark_[w] = stamp_;
+            order.push_back(w);
+          }
+        }
+      }
+      levelBegin = levelEnd;
+    }
+  }
+
+  // Finds a vertex of large eccentricity in root's component
+  // (George and Liu): restart from the lowest-degree vertex of the
+  // last level until the number of levels stops growing
+  int pseudoPeripheral(const int root, std::vector<int>& order,
+                       std::vector<int>& levelPtr)
+  {
+    int start = root;
+    levels(start, order, levelPtr);
+    while(true)
+    {
+      int nlevels = (int)levelPtr.size() - 1;
+      int candidate = order[levelPtr[nlevels-1]];
+      for(int i=levelPtr[nlevels-1]; i<levelPtr[nlevels]; i++)
+      {
+        if(degree(order[i]) < degree(candidate))
+          candidate = order[i];
+      }
+
+      std::vector<int> newOrder, newLevelPtr;
+      levels(candidate, newOrder, newLevelPtr);
+      if((int)newLevelPtr.size() - 1 <= nlevels)
+        break;
+      start = candidate;
+      order.swap(newOrder);
+      levelPtr.swap(newLevelPtr);
+    }
+
+    return start;
+  }
+
+  // Appends the reverse Cuthill-McKee ordering of verts, which must be
+  // one whole region, to perm
+  void cuthillMcKee(const std::vector<int>& verts, std::vector<int>& perm)
+  {
+    std::size_t first = perm.size();
+    std::vector<int> order, levelPtr, neighbours;
+
+    for(std::size_t i=0; i<verts.size(); i++)
+    {
+      if(region_[verts[i]] < 0)
+        continue;
+
+      int start = pseudoPeripheral(verts[i], order, levelPtr);
+      int id = region_[start];
+
+      // Search again from there, visiting neighbours by increasing
+      // degree; placed vertices leave the region
+      std::size_t head = perm.size();
+      perm.push_back(start);
+      region_[start] = -1;
+      while(head < perm.size())
+      {
+        int v = perm[head++];
+        neighbours.clear();
+        for(int k=xadj_[v]; k<xadj_[v+1]; k++)
+        {
+          if(region_[adj_[k]] == id)
+          {
+            neighbours.push_back(adj_[k]);
+            region_[adj_[k]] = -1;
+          }
+        }
+        std::sort(neighbours.begin(), neighbours.end(), ByDegree(*this));
+        perm.insert(perm.end(), neighbours.begin(), neighbours.end());
+      }
+    }
+
+    std::reverse(perm.begin() + first, perm.end());
+  }
+
+  // Appends the nested dissection ordering of verts, which must be one
+  // whole region, to perm
+  void dissect(const std::vector<int>& verts, std::vector<int>& perm,
+               const int leafSize)
+  {
+    std::vector<int> order, levelPtr;
+
+    // Handle each connected component separately
+    for(std::size_t i=0; i<verts.size(); i++)
+    {
+      if(region_[verts[i]] < 0)
+        continue;
+
+      pseudoPeripheral(verts[i], order, levelPtr);
+      int nlevels = (int)levelPtr.size() - 1;
+      int size = (int)order.size();
+      if(size <= leafSize || nlevels < 3)
+      {
+        setRegion(order, nextRegion_++);
+        cuthillMcKee(order, perm);
+        continue;
+      }
+
+      // The separator is the first level that reaches half of the
+      // vertices, kept away from both ends
+      int m = 1;
+      while(m < nlevels-2 && levelPtr[m+1] < size/2)
+        m++;
+
+      std::vector<int> part1(order.begin(), order.begin() + levelPtr[m]);
+      std::vector<int> part2(order.begin() + levelPtr[m+1], order.end());
+      std::vector<int> separator(order.begin() + levelPtr[m],
+                                 order.begin() + levelPtr[m+1]);
+      setRegion(separator, -1);
+      setRegion(part1, nextRegion_++);
+      setRegion(part2, nextRegion_++);
+
+      dissect(part1, perm, leafSize);
+      dissect(part2, perm, leafSize);
+      perm.insert(perm.end(), separator.begin(), separator.end());
+    }
+  }
+
+  int getNumVertices() const
+  {
+    return n_;
+  }
+
+private:
+  // Orders vertices by increasing degree
+  struct ByDegree {
+    const OrderingGraph& g;
+    ByDegree(const OrderingGraph& graph) : g(graph) { }
+    bool operator()(const int a, const int b) const
+    {
+      return g.degree(a) < g.degree(b);
+    }
+  };
+
+  void setRegion(const std::vector<int>& verts, const int id)
+  {
+    for(std::size_t i=0; i<verts.size(); i++)
+      region_[verts[i]] = id;
+  }
+
+  int n_;
+  std::vector<int> xadj_;
+  std::vector<int> adj_;
+  std::vector<int> region_;
+  std::vector<int> mark_;
+  int stamp_;
+  int nextRegion_;
+};
+
+
+void reverseCuthillMcKee(const CsrMatrix& A, std::vector<int>& perm)
+{
+  OrderingGraph graph(A);
+  std::vector<int> all(graph.getNumVertices());
+  for(int v=0; v<graph.getNumVertices(); v++)
+    all[v] = v;
+
+  perm.clear();
+  perm.reserve(graph.getNumVertices());
+  graph.cuthillMcKee(all, perm);
+}
+
+
+void nestedDissection(const CsrMatrix& A, std::vector<int>& perm,
+                      const int leafSize)
+{
+  assert(leafSize > 0);
+
+  OrderingGraph graph(A);
+  std::vector<int> all(graph.getNumVertices());
+  for(int v=0; v<graph.getNumVertices(); v++)
+    all[v] = v;
+
+  perm.clear();
+  perm.reserve(graph.getNumVertices());
+  graph.dissect(all, perm, leafSize);
+}
+
+
+OrderingReport reorder(CsrMatrix& A, const OrderingMethod method,
+                       std::vector<int>& perm)
+{
+  OrderingReport report;
+  report.bandwidthBefore = A.getBandwidth();
+  report.profileBefore = A.getProfile();
+
+  if(method == ORDER_RCM)
+    reverseCuthillMcKee(A, perm);
+  else
+    nestedDissection(A, perm);
+  A.permute(&perm[0]);
+
+  report.bandwidthAfter = A.getBandwidth();
+  report.profileAfter = A.getProfile();
+  return report;
+}
+
+} /* namespace Morpheus */
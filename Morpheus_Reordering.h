@@ -0,0 +1,88 @@
+/**
+ * @file
+ * \brief Defines orderings that improve the locality of sparse matrices
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_REORDERING_H_
+#define MORPHEUS_REORDERING_H_
+
+#include "Morpheus_CsrMatrix.h"
+#include <vector>
+
+namespace Morpheus {
+
+/** \brief Symmetric orderings known to reorder */
+enum OrderingMethod {
+  //! Reverse Cuthill-McKee; see reverseCuthillMcKee
+  ORDER_RCM,
+  //! Recursive bisection; see nestedDissection
+  ORDER_NESTED_DISSECTION
+};
+
+/** \brief Bandwidth and profile before and after reordering */
+struct OrderingReport {
+  //! Bandwidth of the original matrix
+  int bandwidthBefore;
+  //! Bandwidth of the reordered matrix
+  int bandwidthAfter;
+  //! Profile of the original matrix
+  long profileBefore;
+  //! Profile of the reordered matrix
+  long profileAfter;
+};
+
+//! \name Orderings
+///@{
+/** \brief Computes the reverse Cuthill-McKee ordering
+ *
+ * Numbers the vertices of the graph of \a A + \a A^T breadth first,
+ * starting each connected component from a pseudo-peripheral vertex
+ * and visiting neighbours in order of increasing degree, then reverses
+ * the numbering.  Neighbouring rows end up with nearby numbers, which
+ * gives a small bandwidth and profile.  Takes O(nnz) time.
+ *
+ * If \a A is not square, the program terminates.
+ * \param[in] A Matrix whose pattern is used
+ * \param[out] perm New row \a i is old row \a perm[i]
+ */
+void reverseCuthillMcKee(const CsrMatrix& A, std::vector<int>& perm);
+
+/** \brief Computes a nested dissection ordering by level-set bisection
+ *
+ * Splits the graph of \a A + \a A^T in two with the middle level of
+ * a breadth-first search from a pseudo-peripheral vertex.  The two
+ * halves are ordered recursively, followed by the separating level.
+ * Subgraphs of at most \a leafSize vertices are ordered with reverse
+ * Cuthill-McKee.
+ *
+ * This is a cheap stand-in for a real graph partitioner: every
+ * subgraph gets consecutive numbers, so an SpMV on it stays within a
+ * small window of the vector, and the separators-last structure limits
+ * fill in a factorization.  The bandwidth is usually larger than with
+ * reverseCuthillMcKee.
+ *
+ * If \a A is not square, the program terminates.
+ * \param[in] A Matrix whose pattern is used
+ * \param[out] perm New row \a i is old row \a perm[i]
+ * \param[in] leafSize Largest subgraph that is not split further
+ */
+void nestedDissection(const CsrMatrix& A, std::vector<int>& perm,
+                      const int leafSize=256);
+
+/** \brief Computes an ordering and applies it to \a A
+ *
+ * Vectors that are multiplied by \a A afterwards must be permuted
+ * with Vector::permute(&perm[0]), and results brought back with
+ * Vector::permute(&perm[0], true).
+ * \param[in,out] A Matrix to reorder in place
+ * \param[in] method Ordering to use
+ * \param[out] perm New row \a i is old row \a perm[i]
+ */
+OrderingReport reorder(CsrMatrix& A, const OrderingMethod method,
+                       std::vector<int>& perm);
+///@}
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_REORDERING_H_ */
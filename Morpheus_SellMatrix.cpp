@@ -0,0 +1,437 @@
+/**
+ * @file
+ * \brief Defines a SellMatrix class and sparse format selection
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_SellMatrix.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Morpheus {
+
+// Largest supported chunk height
+static const int maxChunkHeight = 64;
+
+// Orders rows by decreasing length; ties keep their original order
+struct LongerRow {
+  const int* rowPtr;
+  bool operator()(const int a, const int b) const
+  {
+    int lenA = rowPtr[a+1] - rowPtr[a];
+    int lenB = rowPtr[b+1] - rowPtr[b];
+    return lenA > lenB || (lenA == lenB && a < b);
+  }
+};
+
+// Fills in the chunk height and sigma defaults
+static void chooseChunking(const int chunkHeight, const int sigma,
+                           int& C, int& S)
+{
+  C = (chunkHeight > 0) ? chunkHeight : SellMatrix::getDefaultChunkHeight();
+  S = (sigma > 0) ? sigma : 8*C;
+  assert(C <= maxChunkHeight);
+
+  // A window must hold whole chunks, or sorting would mix them
+  assert(S == 1 || S % C == 0);
+}
+
+// Sorts the rows within each window of sigma rows, and finds the
+// padded length of each chunk.  Rows past the end of the matrix are
+// given index -1.
+static void sortWindows(const CsrMatrix& A, const int C, const int sigma,
+                        std::vector<int>& perm, std::vector<int>& chunkLen)
+{
+  const int nrows = A.getNumRows();
+  const int nchunks = (nrows + C - 1) / C;
+  const int* rowPtr = A.getRowPtr();
+
+  perm.resize((std::size_t)nchunks*C);
+  chunkLen.resize(nchunks);
+  for(int r=0; r<nrows; r++)
+    perm[r] = r;
+  for(int r=nrows; r<nchunks*C; r++)
+    perm[r] = -1;
+
+  if(sigma > 1)
+  {
+    LongerRow longer = { rowPtr };
+    #pragma omp parallel for schedule(static)
+    for(int w=0; w<nrows; w+=sigma)
+    {
+      int end = (w + sigma < nrows) ? w + sigma : nrows;
+      std::sort(perm.begin() + w, perm.begin() + end, longer);
+    }
+  }
+
+  #pragma omp parallel for schedule(static)
+  for(int c=0; c<nchunks; c++)
+  {
+    int len = 0;
+    for(int r=c*C; r<(c+1)*C; r++)
+    {
+      if(perm[r] >= 0 && A.getRowLength(perm[r]) > len)
+        len = A.getRowLength(perm[r]);
+    }
+    chunkLen[c] = len;
+  }
+}
+
+
+SellMatrix::SellMatrix(const CsrMatrix& A, const int chunkHeight,
+                       const int sigma)
+{
+  nrows_ = A.getNumRows();
+  ncols_ = A.getNumCols();
+  nnz_ = A.getNumEntries();
+  chooseChunking(chunkHeight, sigma, C_, sigma_);
+  nchunks_ = (nrows_ + C_ - 1) / C_;
+
+  sortWindows(A, C_, sigma_, perm_, chunkLen_);
+
+  chunkPtr_.resize(nchunks_+1);
+  chunkPtr_[0] = 0;
+  for(int c=0; c<nchunks_; c++)
+    chunkPtr_[c+1] = chunkPtr_[c] + chunkLen_[c]*C_;
+
+  // The arrays are filled chunk by chunk with the same static schedule
+  // multiply uses, so each thread first touches the chunks it reads
+  std::size_t nstored = chunkPtr_[nchunks_];
+  colInd_ = new int[nstored > 0 ? nstored : 1];
+  vals_ = allocate(1, nstored > 0 ? nstored : 1, ALLOC_UNTOUCHED);
+
+  const int* rowPtr = A.getRowPtr();
+  const int* colInd = A.getColIndices();
+  const double* vals = A.getValues();
+
+  #pragma omp parallel for schedule(static)
+  for(int c=0; c<nchunks_; c++)
+  {
+    int* cols = colInd_ + chunkPtr_[c];
+    double* entries = vals_ + chunkPtr_[c];
+    for(int r=0; r<C_; r++)
+    {
+      int row = perm_[c*C_+r];
+      int begin = (row >= 0) ? rowPtr[row] : 0;
+      int len = (row >= 0) ? rowPtr[row+1] - begin : 0;
+      int lastCol = (len > 0) ? colInd[begin+len-1] : 0;
+      for(int j=0; j<chunkLen_[c]; j++)
+      {
+        cols[j*C_+r] = (j < len) ? colInd[begin+j] : lastCol;
+        entries[j*C_+r] = (j < len) ? vals[begin+j] : 0;
+      }
+    }
+  }
+}
+
+
+SellMatrix::~SellMatrix()
+{
+  std::size_t nstored = chunkPtr_[nchunks_];
+  delete[] colInd_;
+  deallocate(vals_, nstored > 0 ? nstored : 1, ALLOC_UNTOUCHED);
+}
+
+
+int SellMatrix::getNumRows() const
+{
+  return nrows_;
+}
+
+
+int SellMatrix::getNumCols() const
+{
+  return ncols_;
+}
+
+
+int SellMatrix::getNumEntries() const
+{
+  return nnz_;
+}
+
+
+int SellMatrix::getChunkHeight() const
+{
+  return C_;
+}
+
+
+int SellMatrix::getSigma() const
+{
+  return sigma_;
+}
+
+
+double SellMatrix::getFillEfficiency() const
+{
+  int nstored = chunkPtr_[nchunks_];
+  return (nstored > 0) ? (double)nnz_ / nstored : 1;
+}
+
+
+int SellMatrix::getDefaultChunkHeight()
+{
+#if defined(__AVX512F__)
+  return 8;
+#elif defined(__AVX__)
+  return 4;
+#else
+  return 2;
+#endif
+}
+
+
+void SellMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void SellMatrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void SellMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+
+// Multiplies chunk by chunk.  CT is the chunk height if it is known at
+// compile time, so the lane loop can be unrolled into whole registers,
+// or 0 to use the runtime chunk height C.
+template<int CT>
+static void sellGemv(const int nchunks, const int runtimeC,
+                     const int* chunkPtr, const int* chunkLen,
+                     const int* perm, const int* colInd, const double* vals,
+                     const double alpha, const double* x, const double beta,
+                     double* y)
+{
+  const int C = (CT > 0) ? CT : runtimeC;
+
+  #pragma omp parallel for schedule(static)
+  for(int c=0; c<nchunks; c++)
+  {
+    const int* cols = colInd + chunkPtr[c];
+    const double* entries = vals + chunkPtr[c];
+    double s[(CT > 0) ? CT : maxChunkHeight];
+
+    for(int r=0; r<C; r++)
+      s[r] = 0;
+    for(int j=0; j<chunkLen[c]; j++)
+    {
+      #pragma omp simd
+      for(int r=0; r<C; r++)
+        s[r] = s[r] + entries[j*C+r]*x[cols[j*C+r]];
+    }
+
+    for(int r=0; r<C; r++)
+    {
+      int row = perm[c*C+r];
+      if(row < 0)
+        continue;
+      y[row] = (beta == 0) ? alpha*s[r] : alpha*s[r] + beta*y[row];
+    }
+  }
+}
+
+
+void SellMatrix::gemv(const double alpha, const Vector& X, const double beta,
+                      Vector& Y, const bool transpose) const
+{
+  // Make sure the dimensions are consistent
+  assert(X.getNumElements() == (transpose ? nrows_ : ncols_));
+  assert(Y.getNumElements() == (transpose ? ncols_ : nrows_));
+
+  const double* x = &X[0];
+  double* y = &Y[0];
+
+  if(transpose)
+  {
+    // Each stored row scatters into y; padding is skipped
+    #pragma omp parallel for schedule(static)
+    for(int c=0; c<ncols_; c++)
+      y[c] = (beta == 0) ? 0 : beta*y[c];
+
+    #pragma omp parallel for schedule(static)
+    for(int c=0; c<nchunks_; c++)
+    {
+      const int* cols = colInd_ + chunkPtr_[c];
+      const double* entries = vals_ + chunkPtr_[c];
+      for(int r=0; r<C_; r++)
+      {
+        int row = perm_[c*C_+r];
+        if(row < 0)
+          continue;
+        double ax = alpha*x[row];
+        for(int j=0; j<chunkLen_[c]; j++)
+        {
+          if(entries[j*C_+r] == 0)
+            continue;
+          #pragma omp atomic
+          y[cols[j*C_+r]] += entries[j*C_+r]*ax;
+        }
+      }
+    }
+    return;
+  }
+
+  switch(C_)
+  {
+  case 2:
+    sellGemv<2>(nchunks_, C_, &chunkPtr_[0], &chunkLen_[0], &perm_[0],
+                colInd_, vals_, alpha, x, beta, y);
+    break;
+  case 4:
+    sellGemv<4>(nchunks_, C_, &chunkPtr_[0], &chunkLen_[0], &perm_[0],
+                colInd_, vals_, alpha, x, beta, y);
+    break;
+  case 8:
+    sellGemv<8>(nchunks_, C_, &chunkPtr_[0], &chunkLen_[0], &perm_[0],
+                colInd_, vals_, alpha, x, beta, y);
+    break;
+  default:
+    sellGemv<0>(nchunks_, C_, &chunkPtr_[0], &chunkLen_[0], &perm_[0],
+                colInd_, vals_, alpha, x, beta, y);
+    break;
+  }
+}
+
+
+SparseFormatAnalysis analyzeSparseFormat(const CsrMatrix& A,
+                                         const int chunkHeight,
+                                         const int sigma)
+{
+  const int nrows = A.getNumRows();
+  const double nnz = A.getNumEntries();
+
+  int C, S;
+  chooseChunking(chunkHeight, sigma, C, S);
+
+  SparseFormatAnalysis result;
+  result.meanRowLength = nnz / nrows;
+  result.maxRowLength = 0;
+  double sumSq = 0;
+  for(int r=0; r<nrows; r++)
+  {
+    int len = A.getRowLength(r);
+    double diff = len - result.meanRowLength;
+    sumSq = sumSq + diff*diff;
+    if(len > result.maxRowLength)
+      result.maxRowLength = len;
+  }
+  result.stdDevRowLength = std::sqrt(sumSq / nrows);
+
+  std::vector<int> perm, chunkLen;
+  sortWindows(A, C, S, perm, chunkLen);
+  double nstored = 0;
+  for(std::size_t c=0; c<chunkLen.size(); c++)
+    nstored = nstored + (double)chunkLen[c]*C;
+  result.sellFillEfficiency = (nstored > 0) ? nnz / nstored : 1;
+
+  // Bytes moved, or charged as if moved: 8 for a value and 4 for its
+  // column index, 4 for a row pointer or permutation entry, 8 for an
+  // entry of the result
+  //
+  // A CSR row also pays a fixed cost that does not depend on its
+  // length: the loop setup, the horizontal reduction of the SIMD
+  // accumulator and the partially filled last vector.  Together they
+  // take about as long as one full vector pass, i.e. as processing C
+  // more entries at 12 bytes each.  SELL keeps one row per lane, so it
+  // needs no reduction, and only its chunk pointer and length (8 bytes
+  // per chunk of C rows) are charged; this term is what lets it win on
+  // short rows despite the padding.
+  double csrRowOverhead = 12.0*C;
+  double csrCost = 12*nnz + 12.0*nrows + csrRowOverhead*nrows;
+  double sellCost = 12*nstored + 12.0*nrows + 8.0*chunkLen.size();
+  result.predictedSpeedup = csrCost / sellCost;
+  result.format = (result.predictedSpeedup >= 1.1) ? SPARSE_SELL : SPARSE_CSR;
+
+  return result;
+}
+
+
+SparseMatrix::SparseMatrix(const CsrMatrix& A, const bool automatic,
+                           const SparseFormat format)
+{
+  analysis_ = analyzeSparseFormat(A);
+  if(!automatic)
+    analysis_.format = format;
+
+  csr_ = NULL;
+  sell_ = NULL;
+  if(analysis_.format == SPARSE_SELL)
+    sell_ = new SellMatrix(A);
+  else
+    csr_ = new CsrMatrix(A);
+}
+
+
+SparseMatrix::~SparseMatrix()
+{
+  delete csr_;
+  delete sell_;
+}
+
+
+SparseFormat SparseMatrix::getFormat() const
+{
+  return analysis_.format;
+}
+
+
+const SparseFormatAnalysis& SparseMatrix::getAnalysis() const
+{
+  return analysis_;
+}
+
+
+int SparseMatrix::getNumRows() const
+{
+  return csr_ ? csr_->getNumRows() : sell_->getNumRows();
+}
+
+
+int SparseMatrix::getNumCols() const
+{
+  return csr_ ? csr_->getNumCols() : sell_->getNumCols();
+}
+
+
+void SparseMatrix::multiply(const Vector& X, Vector& Y) const
+{
+  if(csr_)
+    csr_->multiply(X, Y);
+  else
+    sell_->multiply(X, Y);
+}
+
+
+void SparseMatrix::gemv(const double alpha, const Vector& X,
+                        const double beta, Vector& Y,
+                        const bool transpose) const
+{
+  if(csr_)
+    csr_->gemv(alpha, X, beta, Y, transpose);
+  else
+    sell_->gemv(alpha, X, beta, Y, transpose);
+}
+
+
+void SparseMatrix::apply(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y);
+}
+
+
+void SparseMatrix::applyTranspose(const Vector& X, Vector& Y) const
+{
+  gemv(1, X, 0, Y, true);
+}
+
+} /* namespace Morpheus */
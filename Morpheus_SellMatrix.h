@@ -0,0 +1,243 @@
+/**
+ * @file
+ * \brief Defines a SellMatrix class and sparse format selection
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_SELLMATRIX_H_
+#define MORPHEUS_SELLMATRIX_H_
+
+#include "Morpheus_CsrMatrix.h"
+
+namespace Morpheus {
+
+/** \class SellMatrix
+ * \brief Stores a sparse matrix in SELL-C-sigma format
+ *
+ * The rows are cut into chunks of \a C consecutive rows, and each
+ * chunk is stored as a small column-major ELLPACK block, padded with
+ * explicit zeros to the length of its longest row.  Entry \a j of
+ * every row in a chunk is therefore contiguous in memory, so the
+ * multiplication runs \a C rows at a time in SIMD lanes regardless of
+ * how short the individual rows are.
+ *
+ * To limit the padding, rows are first sorted by decreasing length
+ * within windows of \a sigma rows.  The result of multiply is
+ * unpermuted, so the sorting is invisible to the caller.  A larger
+ * \a sigma gives less padding but scatters the writes to the result.
+ *
+ * \example Morpheus_SellMatrix_Tests.cpp
+ * Demonstrates the usage of the SELL-C-sigma matrix class
+ */
+class SellMatrix : public LinearOperator {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Converts a CSR matrix
+   *
+   * \param[in] A Matrix to convert
+   * \param[in] chunkHeight Rows per chunk (\a C), at most 64.  0
+   * chooses getDefaultChunkHeight().
+   * \param[in] sigma Rows per sorting window.  0 chooses 8 * \a C; 1
+   * disables sorting.  Otherwise it must be a multiple of \a C, or the
+   * program terminates.
+   */
+  SellMatrix(const CsrMatrix& A, const int chunkHeight=0, const int sigma=0);
+
+  /** \brief Destructor
+   *
+   * Deallocates memory allocated in the constructor
+   */
+  ~SellMatrix();
+  ///@}
+
+  //! \name Accessor functions
+  ///@{
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+
+  //! Returns the number of nonzeros, not counting padding
+  int getNumEntries() const;
+
+  //! Returns the number of rows per chunk
+  int getChunkHeight() const;
+
+  //! Returns the number of rows per sorting window
+  int getSigma() const;
+
+  /** \brief Returns the fraction of stored entries that are nonzeros
+   *
+   * 1 means there is no padding at all.
+   */
+  double getFillEfficiency() const;
+
+  /** \brief Returns the chunk height that fills one SIMD register
+   *
+   * This is the number of doubles in the widest vector unit the
+   * library was compiled for (8 for AVX-512, 4 for AVX, otherwise 2).
+   */
+  static int getDefaultChunkHeight();
+  ///@}
+
+  //! \name Multiplication routines
+  ///@{
+  /** \brief Computes a matrix-vector multiplication
+   *
+   * \param[in] X vector to be multiplied
+   * \param[out] Y result of multiplication
+   *
+   * \note The number of rows of the matrix must equal the number of
+   * entries in \a Y, and the number of columns must equal the number
+   * of entries in \a X.  Otherwise, the program will terminate.
+   */
+  void multiply(const Vector& X, Vector& Y) const;
+
+  /** \brief Computes \a Y = \a alpha * op(\a this) * \a X + \a beta * \a Y
+   *
+   * Works exactly like Matrix::gemv.  The transposed product scatters
+   * into \a Y with atomic updates, as in CsrMatrix, and is much slower
+   * than the plain one.
+   */
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+  ///@}
+
+private:
+  //! Copying is not supported
+  SellMatrix(const SellMatrix&);
+  //! Copying is not supported
+  SellMatrix& operator=(const SellMatrix&);
+
+  //! Number of rows
+  int nrows_;
+  //! Number of columns
+  int ncols_;
+  //! Number of nonzeros, not counting padding
+  int nnz_;
+  //! Rows per chunk
+  int C_;
+  //! Rows per sorting window
+  int sigma_;
+  //! Number of chunks
+  int nchunks_;
+  //! Start of each chunk in colInd_ and vals_ (nchunks_ + 1 entries)
+  std::vector<int> chunkPtr_;
+  //! Padded length of each chunk
+  std::vector<int> chunkLen_;
+  //! Original index of each sorted row (nchunks_ * C_ entries)
+  std::vector<int> perm_;
+  //! Column of each stored entry; padding repeats the row's last column
+  int* colInd_;
+  //! Value of each stored entry; padding is 0
+  double* vals_;
+};
+
+/** \brief Sparse storage formats known to the format selector */
+enum SparseFormat { SPARSE_CSR, SPARSE_SELL };
+
+/** \brief Row-length statistics and the format chosen for them */
+struct SparseFormatAnalysis {
+  //! The recommended format
+  SparseFormat format;
+  //! Predicted SpMV time in CSR divided by predicted time in SELL
+  double predictedSpeedup;
+  //! Average nonzeros per row
+  double meanRowLength;
+  //! Standard deviation of the nonzeros per row
+  double stdDevRowLength;
+  //! Longest row
+  int maxRowLength;
+  //! Fraction of SELL entries that would be nonzeros
+  double sellFillEfficiency;
+};
+
+/** \brief Predicts whether SELL-C-sigma beats CSR for a matrix
+ *
+ * The prediction is a simple traffic model.  Both formats stream 12
+ * bytes per stored entry, but SELL also streams its padding.  CSR
+ * pays a fixed cost per row (loop setup, a horizontal reduction and
+ * the partial vector), charged here as one full SIMD pass of the
+ * \a C lanes, which dominates when rows are short.  SELL is chosen
+ * when it is predicted to be at least 10% faster.
+ *
+ * This only looks at row lengths, and takes O(nrows log sigma) time.
+ * \param[in] A Matrix to analyze
+ * \param[in] chunkHeight As in the SellMatrix constructor
+ * \param[in] sigma As in the SellMatrix constructor
+ */
+SparseFormatAnalysis analyzeSparseFormat(const CsrMatrix& A,
+                                         const int chunkHeight=0,
+                                         const int sigma=0);
+
+/** \class SparseMatrix
+ * \brief A sparse matrix stored in whichever format multiplies fastest
+ *
+ * The format is picked by analyzeSparseFormat unless the caller asks
+ * for one.  Only the chosen format is kept.
+ */
+class SparseMatrix : public LinearOperator {
+public:
+  /** \brief Stores a copy of \a A in the chosen format
+   *
+   * \param[in] A Matrix to store
+   * \param[in] automatic If true, run analyzeSparseFormat; otherwise
+   * use \a format
+   * \param[in] format Format to use when \a automatic is false
+   */
+  SparseMatrix(const CsrMatrix& A, const bool automatic=true,
+               const SparseFormat format=SPARSE_CSR);
+
+  //! Destructor
+  ~SparseMatrix();
+
+  //! Returns the format in use
+  SparseFormat getFormat() const;
+
+  //! Returns the analysis behind the choice of format
+  const SparseFormatAnalysis& getAnalysis() const;
+
+  //! Returns the number of rows
+  int getNumRows() const;
+
+  //! Returns the number of columns
+  int getNumCols() const;
+
+  //! Computes a matrix-vector multiplication, as in CsrMatrix::multiply
+  void multiply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a alpha * op(\a this) * \a X + \a beta * \a Y
+  void gemv(const double alpha, const Vector& X, const double beta,
+            Vector& Y, const bool transpose=false) const;
+
+  //! Computes \a Y = \a this * \a X, as in multiply
+  void apply(const Vector& X, Vector& Y) const;
+
+  //! Computes \a Y = \a this^T * \a X
+  void applyTranspose(const Vector& X, Vector& Y) const;
+
+private:
+  //! Copying is not supported
+  SparseMatrix(const SparseMatrix&);
+  //! Copying is not supported
+  SparseMatrix& operator=(const SparseMatrix&);
+
+  //! Row-length statistics of the matrix
+  SparseFormatAnalysis analysis_;
+  //! The matrix, if stored in CSR
+  CsrMatrix* csr_;
+  //! The matrix, if stored in SELL-C-sigma
+  SellMatrix* sell_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_SELLMATRIX_H_ */
@@ -0,0 +1,289 @@
+/**
+ * @file
+ * \brief Defines sparse matrix-matrix multiplication
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Spgemm.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace Morpheus {
+
+// SPGEMM_AUTO uses a dense accumulator up to this many output columns,
+// which keeps each thread's accumulator within a typical L2 cache
+static const int denseColumnLimit = 1 << 15;
+
+// Merges the partial products of one row of the output.  Each thread
+// owns one, and reuses it row after row; clear only touches the slots
+// the previous row used.
+class RowAccumulator {
+public:
+  // A dense accumulator has one slot per column; a hash accumulator
+  // has at least twice as many slots as the longest row, and at least 2
+  RowAccumulator(const SpgemmAccumulator kind, const int ncols,
+                 const int maxRowLength)
+  {
+    dense_ = (kind == SPGEMM_DENSE);
+    int size = ncols;
+    shift_ = 32;
+    if(!dense_)
+    {
+      size = 2;
+      shift_ = 31;
+      while(size < 2*maxRowLength)
+      {
+        size *= 2;
+        shift_--;
+      }
+    }
+    mask_ = size - 1;
+    keys_.assign(size, -1);
+    vals_.assign(size, 0);
+  }
+
+  // Returns the slot for column col, adding it if it is new
+  int insert(const int col)
+  {
+    int slot = home(col);
+    while(keys_[slot] != col)
+    {
+      if(keys_[slot] < 0)
+      {
+        keys_[slot] = col;
+        vals_[slot] = 0;
+        used_.push_back(slot);
+        break;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  // Returns the slot holding column col, which must be present
+  int find(const int col) const
+  {
+    int slot = home(col);
+    while(keys_[slot] != col)
+      slot = (slot + 1) & mask_;
+    return slot;
+  }
+
+  // Number of distinct columns added since the last clear
+  int size() const
+  {
+    return (int)used_.size();
+  }
+
+  // Column added in position i
+  int column(const int i) const
+  {
+    return keys_[used_[i]];
+  }
+
+  double& value(const int slot)
+  {
+    return vals_[slot];
+  }
+
+  void clear()
+  {
+    for(std::size_t i=0; i<used_.size(); i++)
+      keys_[used_[i]] = -1;
+    used_.clear();
+  }
+
+private:
+  // First slot to probe for column col.  The hash keeps the high bits
+  // of col * 2^32/phi: the low bits depend only on the low bits of
+  // col, so columns with a power-of-two stride would share a slot.
+  int home(const int col) const
+  {
+    if(dense_)
+      return col;
+    return (int)(((std::uint32_t)col * 2654435761u) >> shift_);
+  }
+
+  bool dense_;
+  int mask_;
+  // 32 - log2 of the number of hash slots
+  int shift_;
+  std::vector<int> keys_;
+  std::vector<double> vals_;
+  std::vector<int> used_;
+};
+
+
+SpgemmPlan::SpgemmPlan(const CsrMatrix& A, const CsrMatrix& B,
+                       const SpgemmAccumulator accumulator)
+{
+  // Make sure the dimensions are consistent
+  assert(A.getNumCols() == B.getNumRows());
+
+  nrows_ = A.getNumRows();
+  ncols_ = B.getNumCols();
+  nnzA_ = A.getNumEntries();
+  nnzB_ = B.getNumEntries();
+  accumulator_ = accumulator;
+  if(accumulator_ == SPGEMM_AUTO)
+    accumulator_ = (ncols_ <= denseColumnLimit) ? SPGEMM_DENSE : SPGEMM_HASH;
+
+  const int* rowPtrA = A.getRowPtr();
+  const int* colIndA = A.getColIndices();
+  const int* rowPtrB = B.getRowPtr();
+  const int* colIndB = B.getColIndices();
+
+  // Bound the length of each output row by the number of partial
+  // products that land in it, to size the hash tables
+  int maxProducts = 0;
+  #pragma omp parallel
+  {
+    int myMax = 0;
+
+    #pragma omp for schedule(static)
+    for(int r=0; r<nrows_; r++)
+    {
+      int nprod = 0;
+      for(int k=rowPtrA[r]; k<rowPtrA[r+1]; k++)
+        nprod = nprod + B.getRowLength(colIndA[k]);
+      if(nprod > myMax)
+        myMax = nprod;
+    }
+
+    #pragma omp critical
+    {
+      if(myMax > maxProducts) maxProducts = myMax;
+    }
+  }
+  if(maxProducts > ncols_)
+    maxProducts = ncols_;
+
+  // Count the nonzeros in each row, then fill in their columns
+  rowPtr_.assign(nrows_+1, 0);
+  maxRowLength_ = 0;
+  #pragma omp parallel
+  {
+    RowAccumulator acc(accumulator_, ncols_, maxProducts);
+    int myMax = 0;
+
+    #pragma omp for schedule(dynamic,64)
+    for(int r=0; r<nrows_; r++)
+    {
+      for(int k=rowPtrA[r]; k<rowPtrA[r+1]; k++)
+      {
+        int row = colIndA[k];
+        for(int j=rowPtrB[row]; j<rowPtrB[row+1]; j++)
+          acc.insert(colIndB[j]);
+      }
+      rowPtr_[r+1] = acc.size();
+      if(acc.size() > myMax)
+        myMax = acc.size();
+      acc.clear();
+    }
+
+    #pragma omp critical
+    {
+      if(myMax > maxRowLength_) maxRowLength_ = myMax;
+    }
+  }
+
+  for(int r=0; r<nrows_; r++)
+    rowPtr_[r+1] += rowPtr_[r];
+  colInd_.resize(rowPtr_[nrows_]);
+
+  #pragma omp parallel
+  {
+    RowAccumulator acc(accumulator_, ncols_, maxRowLength_);
+
+    #pragma omp for schedule(dynamic,64)
+    for(int r=0; r<nrows_; r++)
+    {
+      for(int k=rowPtrA[r]; k<rowPtrA[r+1]; k++)
+      {
+        int row = colIndA[k];
+        for(int j=rowPtrB[row]; j<rowPtrB[row+1]; j++)
+          acc.insert(colIndB[j]);
+      }
+      for(int i=0; i<acc.size(); i++)
+        colInd_[rowPtr_[r]+i] = acc.column(i);
+      std::sort(colInd_.begin() + rowPtr_[r], colInd_.begin() + rowPtr_[r+1]);
+      acc.clear();
+    }
+  }
+}
+
+
+CsrMatrix SpgemmPlan::createProduct() const
+{
+  std::vector<double> zeros(colInd_.size() > 0 ? colInd_.size() : 1, 0);
+  return CsrMatrix(nrows_, ncols_, &rowPtr_[0],
+                   colInd_.empty() ? NULL : &colInd_[0], &zeros[0]);
+}
+
+
+void SpgemmPlan::numeric(const CsrMatrix& A, const CsrMatrix& B,
+                         CsrMatrix& C) const
+{
+  // Make sure the patterns could be the ones the plan was made for
+  assert(A.getNumRows() == nrows_ && B.getNumCols() == ncols_);
+  assert(A.getNumCols() == B.getNumRows());
+  assert(A.getNumEntries() == nnzA_ && B.getNumEntries() == nnzB_);
+  assert(C.getNumRows() == nrows_ && C.getNumCols() == ncols_);
+  assert(C.getNumEntries() == getNumEntries());
+
+  const int* rowPtrA = A.getRowPtr();
+  const int* colIndA = A.getColIndices();
+  const double* valsA = A.getValues();
+  const int* rowPtrB = B.getRowPtr();
+  const int* colIndB = B.getColIndices();
+  const double* valsB = B.getValues();
+  double* valsC = C.getValues();
+
+  #pragma omp parallel
+  {
+    RowAccumulator acc(accumulator_, ncols_, maxRowLength_);
+
+    #pragma omp for schedule(dynamic,64)
+    for(int r=0; r<nrows_; r++)
+    {
+      for(int k=rowPtrA[r]; k<rowPtrA[r+1]; k++)
+      {
+        int row = colIndA[k];
+        double a = valsA[k];
+        for(int j=rowPtrB[row]; j<rowPtrB[row+1]; j++)
+        {
+          int slot = acc.insert(colIndB[j]);
+          acc.value(slot) = acc.value(slot) + a*valsB[j];
+        }
+      }
+      for(int k=rowPtr_[r]; k<rowPtr_[r+1]; k++)
+        valsC[k] = acc.value(acc.find(colInd_[k]));
+      acc.clear();
+    }
+  }
+}
+
+
+int SpgemmPlan::getNumEntries() const
+{
+  return rowPtr_[nrows_];
+}
+
+
+SpgemmAccumulator SpgemmPlan::getAccumulator() const
+{
+  return accumulator_;
+}
+
+
+CsrMatrix multiply(const CsrMatrix& A, const CsrMatrix& B)
+{
+  SpgemmPlan plan(A, B);
+  CsrMatrix C = plan.createProduct();
+  plan.numeric(A, B, C);
+  return C;
+}
+
+} /* namespace Morpheus */
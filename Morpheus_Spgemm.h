@@ -0,0 +1,119 @@
+/**
+ * @file
+ * \brief Defines sparse matrix-matrix multiplication
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_SPGEMM_H_
+#define MORPHEUS_SPGEMM_H_
+
+#include "Morpheus_CsrMatrix.h"
+
+namespace Morpheus {
+
+/** \brief How SpgemmPlan merges the partial products of a row */
+enum SpgemmAccumulator {
+  //! Pick SPGEMM_DENSE or SPGEMM_HASH from the size of the output
+  SPGEMM_AUTO,
+  //! One array per thread as long as a row of the output
+  SPGEMM_DENSE,
+  //! One hash table per thread, sized to the longest output row
+  SPGEMM_HASH
+};
+
+/** \class SpgemmPlan
+ * \brief Computes the product of two sparse matrices in two phases
+ *
+ * The constructor runs the symbolic phase, which finds the sparsity
+ * pattern of \a C = \a A * \a B.  numeric then computes the values.
+ * As long as the patterns of \a A and \a B do not change, the plan
+ * can be reused for any number of numeric phases, which is much
+ * cheaper than multiplying from scratch.
+ *
+ * A Galerkin product R*A*P takes two plans:
+ * \code
+ * SpgemmPlan planAP(A, P);
+ * CsrMatrix AP = planAP.createProduct();
+ * SpgemmPlan planRAP(R, AP);
+ * CsrMatrix RAP = planRAP.createProduct();
+ * for(...)   // A changes, but not its pattern
+ * {
+ *   planAP.numeric(A, P, AP);
+ *   planRAP.numeric(R, AP, RAP);
+ * }
+ * \endcode
+ *
+ * Both phases are multithreaded over the rows of \a A.  Each thread
+ * merges the contributions to a row in its own accumulator: a dense
+ * array indexed by column when the output has few columns, or a hash
+ * table otherwise.
+ *
+ * \example Morpheus_Spgemm_Tests.cpp
+ * Demonstrates how to reuse the symbolic phase
+ */
+class SpgemmPlan {
+public:
+  /** \brief Runs the symbolic phase
+   *
+   * If the number of columns of \a A does not equal the number of
+   * rows of \a B, the program terminates.
+   * \param[in] A Left factor
+   * \param[in] B Right factor
+   * \param[in] accumulator Accumulator used by both phases
+   */
+  SpgemmPlan(const CsrMatrix& A, const CsrMatrix& B,
+             const SpgemmAccumulator accumulator=SPGEMM_AUTO);
+
+  /** \brief Returns a matrix with the pattern of the product
+   *
+   * The values are all 0 until numeric is called.
+   */
+  CsrMatrix createProduct() const;
+
+  /** \brief Runs the numeric phase
+   *
+   * \param[in] A Left factor, with the same pattern as in the constructor
+   * \param[in] B Right factor, with the same pattern as in the constructor
+   * \param[in,out] C Matrix created by createProduct; its values are
+   * overwritten with those of \a A * \a B
+   *
+   * \note Only the dimensions and numbers of nonzeros are checked.
+   * If the patterns changed in any other way, the result is wrong.
+   */
+  void numeric(const CsrMatrix& A, const CsrMatrix& B, CsrMatrix& C) const;
+
+  //! Returns the number of nonzeros in the product
+  int getNumEntries() const;
+
+  //! Returns the accumulator in use (never SPGEMM_AUTO)
+  SpgemmAccumulator getAccumulator() const;
+
+private:
+  //! Number of rows of A
+  int nrows_;
+  //! Number of columns of B
+  int ncols_;
+  //! Number of nonzeros of A when the plan was made
+  int nnzA_;
+  //! Number of nonzeros of B when the plan was made
+  int nnzB_;
+  //! Longest row of the product
+  int maxRowLength_;
+  //! Accumulator used by both phases
+  SpgemmAccumulator accumulator_;
+  //! Start of each row of the product
+  std::vector<int> rowPtr_;
+  //! Column of each nonzero of the product, sorted within each row
+  std::vector<int> colInd_;
+};
+
+/** \brief Computes \a A * \a B in one go
+ *
+ * This is SpgemmPlan followed by a single numeric phase.  Keep the
+ * plan instead if the product will be recomputed with new values.
+ */
+CsrMatrix multiply(const CsrMatrix& A, const CsrMatrix& B);
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_SPGEMM_H_ */
@@ -8,25 +8,59 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include "Morpheus_Vector.h"
+#include "Morpheus_Backend.h"
+#include "Morpheus_Writer.h"
 
 namespace Morpheus {
 
-Vector::Vector(const int numElements)
+Vector::Vector(const int numElements, const AllocPolicy policy)
 {
   assert(numElements > 0);
 
   numElements_ = numElements;
 
   // Allocate memory for the data
-  data_ = new double[numElements_];
+  buffer_ = new SharedBuffer(numElements_, 1, policy);
+  data_ = buffer_->getData();
+}
+
+
+Vector::Vector(const Vector& v)
+{
+  numElements_ = v.numElements_;
+
+  // Share the entries until one of us writes them
+  buffer_ = v.buffer_->acquire();
+  data_ = v.data_;
+}
+
+
+Vector& Vector::operator=(const Vector& v)
+{
+  // Acquire first, in case v shares our buffer
+  SharedBuffer* buffer = v.buffer_->acquire();
+  buffer_->release();
+
+  numElements_ = v.numElements_;
+  buffer_ = buffer;
+  data_ = v.data_;
+  return *this;
 }
 
 
 Vector::~Vector()
 {
-  // Release the memory
-  delete[] data_;
+  // Release the memory, if no copy still uses it
+  buffer_->release();
+}
+
+
+void Vector::detach(const bool keepValues)
+{
+  buffer_ = buffer_->detach(keepValues);
+  data_ = buffer_->getData();
 }
 
 
@@ -36,6 +70,7 @@ double& Vector::operator[](const int subscript)
   // Terminate the program if it's not
   assert(subscript >= 0 && subscript < numElements_);
 
+  detach();
   return data_[subscript];
 }
 
@@ -56,8 +91,44 @@ int Vector::getNumElements() const
 }
 
 
+int Vector::getUseCount() const
+{
+  return buffer_->getUseCount();
+}
+
+
+void Vector::permute(const int* perm, const bool inverse)
+{
+  detach();
+  double* old = allocate(1, numElements_, ALLOC_UNTOUCHED);
+
+  #pragma omp parallel for schedule(static)
+  for(int i=0; i<numElements_; i++)
+    old[i] = data_[i];
+
+  if(inverse)
+  {
+    #pragma omp parallel for schedule(static)
+    for(int i=0; i<numElements_; i++)
+      data_[perm[i]] = old[i];
+  }
+  else
+  {
+    #pragma omp parallel for schedule(static)
+    for(int i=0; i<numElements_; i++)
+      data_[i] = old[perm[i]];
+  }
+
+  deallocate(old, numElements_, ALLOC_UNTOUCHED);
+}
+
+
 void Vector::setValue(const double alpha)
 {
+  // The old entries are never read, so a shared buffer is not copied
+  detach(false);
+
+  #pragma omp parallel for schedule(static)
   for(int i=0; i<numElements_; i++)
   {
     data_[i] = alpha;
@@ -67,6 +138,9 @@ void Vector::setValue(const double alpha)
 
 void Vector::scale(const double alpha)
 {
+  detach();
+
+  #pragma omp parallel for schedule(static)
   for(int i=0; i<numElements_; i++)
   {
     data_[i] = alpha * data_[i];
@@ -79,8 +153,10 @@ void Vector::add(const Vector& b, Vector& sum) const
   // Make sure all three vectors are the same size
   assert(this->numElements_ == b.numElements_);
   assert(this->numElements_ == sum.numElements_);
+  sum.detach();
 
   // Compute the sum of each entry
+  #pragma omp parallel for schedule(static)
   for(int i=0; i<this->numElements_; i++)
   {
     sum.data_[i] = this->data_[i] + b.data_[i];
@@ -93,71 +169,120 @@ double Vector::dot(const Vector& b) const
   // Make sure the vectors are the same size
   assert(this->numElements_ == b.numElements_);
 
-  double sum;
-
   // Compute the sum of all the products
-  for(int i=0; i<this->numElements_; i++)
-  {
-    sum = sum + (this->data_[i] * b.data_[i]);
-  }
+  return getBackend().dot(numElements_, this->data_, b.data_);
+}
 
-  return sum;
+
+void Vector::axpy(const double alpha, const Vector& x)
+{
+  // Make sure the vectors are the same size
+  assert(this->numElements_ == x.numElements_);
+  detach();
+
+  getBackend().axpy(numElements_, alpha, x.data_, data_);
 }
 
 
-double Vector::norm1() const
+void Vector::axpby(const double alpha, const Vector& x, const double beta)
 {
-  double sum = 0;
+  // Make sure the vectors are the same size
+  assert(this->numElements_ == x.numElements_);
+  detach();
 
-  // Compute the sum of all the entries magnitudes
+  #pragma omp parallel for schedule(static)
   for(int i=0; i<numElements_; i++)
   {
-    sum = sum + data_[i];
+    data_[i] = alpha * x.data_[i] + beta * data_[i];
   }
-
-  return sum;
 }
 
 
-double Vector::normInf() const
+void Vector::waxpby(const double alpha, const Vector& x, const double beta,
+                    const Vector& y)
 {
-  double maxVal = 0;
+  // Make sure all three vectors are the same size
+  assert(this->numElements_ == x.numElements_);
+  assert(this->numElements_ == y.numElements_);
+  detach();
 
-  // Find the biggest entry
+  #pragma omp parallel for schedule(static)
   for(int i=0; i<numElements_; i++)
   {
-    double absVal = data_[i];
-    if(absVal > maxVal)
-    {
-      maxVal = absVal;
-    }
+    data_[i] = alpha * x.data_[i] + beta * y.data_[i];
   }
-
-  return maxVal;
 }
 
 
-double Vector::norm2() const
+double Vector::axpyDot(const double alpha, const Vector& x, const Vector& z)
 {
+  // Make sure all three vectors are the same size
+  assert(this->numElements_ == x.numElements_);
+  assert(this->numElements_ == z.numElements_);
+  detach();
+
   double sum = 0;
 
-  // Compute the sum of squares
+  // Update each entry and use it while it is still in a register
+  #pragma omp parallel for schedule(static) reduction(+:sum)
   for(int i=0; i<numElements_; i++)
   {
-    sum = sum + (data_[i]*data_[i]);
+    double updated = data_[i] + alpha * x.data_[i];
+    data_[i] = updated;
+    sum = sum + updated * z.data_[i];
   }
 
   return sum;
 }
 
 
-void Vector::print() const
+void Vector::dotNorm2(const Vector& b, double& dot, double& norm2) const
 {
-  std::cout << "Vector with " << numElements_ << " entries\n";
+  // Make sure the vectors are the same size
+  assert(this->numElements_ == b.numElements_);
+
+  double dotSum = 0;
+  double normSum = 0;
+
+  #pragma omp parallel for schedule(static) reduction(+:dotSum,normSum)
   for(int i=0; i<numElements_; i++)
   {
-    std::cout << "data[" << i << "] = " << data_[i] << std::endl;
+    dotSum = dotSum + data_[i] * b.data_[i];
+    normSum = normSum + data_[i] * data_[i];
   }
+
+  dot = dotSum;
+  norm2 = std::sqrt(normSum);
+}
+
+
+double Vector::norm1() const
+{
+  // Compute the sum of all the entries magnitudes
+  return getBackend().norm1(numElements_, data_);
+}
+
+
+double Vector::normInf() const
+{
+  // Find the biggest entry
+  return getBackend().normInf(numElements_, data_);
+}
+
+
+double Vector::norm2() const
+{
+  // Compute the square root of the sum of squares
+  return getBackend().norm2(numElements_, data_);
+}
+
+
+void Vector::print() const
+{
+  // std::cout writes %g with its precision, where 0 means 1
+  Writer writer(std::cout);
+  writer.setPrecision(std::max<int>(1, std::cout.precision()));
+  writer.write(*this);
 }
 
 } /* namespace Morpheus */
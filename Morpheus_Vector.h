@@ -8,10 +8,11 @@
 #ifndef MORPHEUS_VECTOR_H_
 #define MORPHEUS_VECTOR_H_
 
+#include "Morpheus_Memory.h"
+
 /** \namespace Morpheus
  * \brief Contains linear algebra classes
  *
- * \todo Add a sparse matrix class
  */
 namespace Morpheus {
 
@@ -37,11 +38,29 @@ public:
    * Allocates memory for a Vector.  If \a numElements is not
    * positive, the program terminates.
    * \param[in] numElements The number of entries in the vector
+   * \param[in] policy Where to place the pages of the vector
+   *
+   * \warning With the default policy the entries are zeroed in
+   * parallel so that each page is local to the thread that works on
+   * it; with ::ALLOC_UNTOUCHED the memory is not initialized at all.
+   */
+  Vector(const int numElements,
+         const AllocPolicy policy=ALLOC_FIRST_TOUCH);
+
+  /** \brief Copy constructor
+   *
+   * The copy shares the entries of \a v until either of them is
+   * written (see SharedBuffer), so copying costs O(1) no matter how
+   * long the vector is.
+   */
+  Vector(const Vector& v);
+
+  /** \brief Assignment
    *
-   * \warning This function only allocates the memory; it does not
-   * initialize the memory.
+   * Releases the old entries and shares those of \a v, which may
+   * have a different length.
    */
-  Vector(const int numElements);
+  Vector& operator=(const Vector& v);
 
   /** \brief Destructor
    *
@@ -55,7 +74,13 @@ public:
   /** \brief Subscript operator
    *
    * Returns a reference to the entry at the location
-   * denoted by \a subscript.
+   * denoted by \a subscript.  If the entries are shared with a copy,
+   * this vector gets its own copy of them first, so call the const
+   * version when only reading.
+   * \warning Do not call this from several threads on one vector
+   * whose entries may be shared: each thread would make its own
+   * copy.  To fill a vector in parallel, take <tt>double* x =
+   * &v[0];</tt> once, before the threads start, and write through it.
    * Example usage:
    * \code
    * Vector v(3);
@@ -83,6 +108,23 @@ public:
 
   //! Returns the total number of entries
   int getNumElements() const;
+
+  /** \brief Returns the number of vectors sharing these entries
+   *
+   * This is 1 unless the vector was copied and neither copy has been
+   * written since.
+   */
+  int getUseCount() const;
+
+  /** \brief Reorders the entries in place
+   *
+   * Entry \a i becomes the old entry \a perm[i], which matches
+   * CsrMatrix::permute.  With \a inverse, entry \a perm[i] becomes
+   * the old entry \a i instead, which undoes the permutation.
+   * \param[in] perm A permutation of 0, ..., getNumElements()-1
+   * \param[in] inverse Whether to apply the inverse permutation
+   */
+  void permute(const int* perm, const bool inverse=false);
   ///@}
 
   //! \name Linear algebra functions
@@ -122,10 +164,64 @@ public:
   double dot(const Vector& b) const;
   ///@}
 
+  /** \name BLAS-style update functions
+   * These combine what would otherwise be several calls to scale,
+   * add and dot into a single sweep over memory.  If the vectors are
+   * not the same size, the functions will abort.
+   */
+  ///@{
+  /** \brief Replaces \a this by \a alpha * \a x + \a this (BLAS AXPY)
+   *
+   * \param[in] alpha Scalar multiplying \a x
+   * \param[in] x Vector to add
+   */
+  void axpy(const double alpha, const Vector& x);
+
+  /** \brief Replaces \a this by \a alpha * \a x + \a beta * \a this
+   *
+   * \param[in] alpha Scalar multiplying \a x
+   * \param[in] x Vector to add
+   * \param[in] beta Scalar multiplying \a this
+   */
+  void axpby(const double alpha, const Vector& x, const double beta);
+
+  /** \brief Replaces \a this by \a alpha * \a x + \a beta * \a y
+   *
+   * The old values of \a this are never read, so it does not need
+   * to be initialized.
+   * \param[in] alpha Scalar multiplying \a x
+   * \param[in] x First vector
+   * \param[in] beta Scalar multiplying \a y
+   * \param[in] y Second vector
+   */
+  void waxpby(const double alpha, const Vector& x, const double beta,
+              const Vector& y);
+
+  /** \brief Replaces \a this by \a alpha * \a x + \a this and returns
+   * the dot product of the updated \a this with \a z
+   *
+   * Passing \a this as \a z gives the squared 2-norm of the updated
+   * vector, as in the residual update of conjugate gradients.
+   * \param[in] alpha Scalar multiplying \a x
+   * \param[in] x Vector to add
+   * \param[in] z Vector to take the dot product with
+   */
+  double axpyDot(const double alpha, const Vector& x, const Vector& z);
+
+  /** \brief Computes the dot product with \a b and the 2-norm of
+   * \a this together
+   *
+   * \param[in] b Vector to use in dot-product
+   * \param[out] dot \a this dot \a b
+   * \param[out] norm2 2-norm of \a this
+   */
+  void dotNorm2(const Vector& b, double& dot, double& norm2) const;
+  ///@}
+
   //! \name Norms
   ///@{
 
-  //! Sum of all entries
+  //! Sum of the magnitudes of all entries
   double norm1() const;
 
   //! Maximum magnitude entry
@@ -146,6 +242,9 @@ public:
    * data[1] = 0\n
    * data[2] = 7\n
    * </tt>
+   *
+   * Entries have the precision of <tt>std::cout</tt>.  Use a Writer
+   * to write to a file, or to keep every digit.
    */
   void print() const;
   ///@}
@@ -156,11 +255,17 @@ private:
    * Cannot be changed after construction
    */
   int numElements_;
-  /** \brief Pointer to raw data
+  //! Entries, possibly shared with copies of this vector
+  SharedBuffer* buffer_;
+  //! The entries of \a buffer_
+  double* data_;
+
+  /** \brief Gets a private copy of the entries before writing them
    *
-   * Allocated in the constructor and deallocated in the destructor.
+   * \param[in] keepValues Whether the old entries are needed; see
+   * SharedBuffer::detach
    */
-  double* data_;
+  void detach(const bool keepValues=true);
 };
 
 } /* namespace Morpheus */
@@ -0,0 +1,273 @@
+/**
+ * @file
+ * \brief Defines a buffered writer for Matrix and Vector
+ *
+ * @author Alicia Klinvex
+ */
+
+#include "Morpheus_Writer.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#if defined(__cpp_lib_to_chars)
+#define MORPHEUS_HAVE_TO_CHARS
+#endif
+
+namespace Morpheus {
+
+// Longest entry of the shortest exact representation,
+// e.g. -2.2250738585072014e-308
+static const int shortestDigits = 17;
+
+// Bytes reserved per entry; %g never needs more than its digits plus
+// a sign, a point and an exponent
+static std::size_t entryBytes(const int precision)
+{
+  return (precision > 0 ? precision : shortestDigits) + 32;
+}
+
+// Writes x at p and returns the end of what was written
+static char* formatDouble(char* p, char* end, const double x,
+                          const int precision)
+{
+#ifdef MORPHEUS_HAVE_TO_CHARS
+  std::to_chars_result result = (precision > 0) ?
+      std::to_chars(p, end, x, std::chars_format::general, precision) :
+      std::to_chars(p, end, x);
+  assert(result.ec == std::errc());
+  return result.ptr;
+#else
+  int n;
+  if(precision > 0)
+    n = std::snprintf(p, end-p, "%.*g", precision, x);
+  else
+  {
+    // The fewest digits that read back as x
+    for(int digits=15; ; digits++)
+    {
+      n = std::snprintf(p, end-p, "%.*g", digits, x);
+      if(digits == shortestDigits || std::strtod(p, NULL) == x || x != x)
+        break;
+    }
+  }
+  assert(n > 0 && n < end-p);
+  return p + n;
+#endif
+}
+
+// Writes i at p and returns the end of what was written
+static char* formatInt(char* p, char* end, const int i)
+{
+#ifdef MORPHEUS_HAVE_TO_CHARS
+  std::to_chars_result result = std::to_chars(p, end, i);
+  assert(result.ec == std::errc());
+  return result.ptr;
+#else
+  int n = std::snprintf(p, end-p, "%d", i);
+  assert(n > 0 && n < end-p);
+  return p + n;
+#endif
+}
+
+// Appends s to the buffer at p
+static char* append(char* p, const char* s)
+{
+  std::size_t n = std::strlen(s);
+  std::memcpy(p, s, n);
+  return p + n;
+}
+
+Writer::Writer(std::ostream& os, const WriteFormat format)
+{
+  os_ = &os;
+  fd_ = -1;
+  format_ = format;
+  precision_ = 0;
+  bufferSize_ = 1 << 20;
+  parallel_ = true;
+}
+
+Writer::Writer(const int fd, const WriteFormat format)
+{
+  assert(fd >= 0);
+
+  os_ = NULL;
+  fd_ = fd;
+  format_ = format;
+  precision_ = 0;
+  bufferSize_ = 1 << 20;
+  parallel_ = true;
+}
+
+void Writer::setPrecision(const int digits)
+{
+  assert(digits >= 0);
+
+  precision_ = digits;
+}
+
+void Writer::setBufferSize(const std::size_t bytes)
+{
+  assert(bytes > 0);
+
+  bufferSize_ = bytes;
+}
+
+void Writer::setParallel(const bool parallel)
+{
+  parallel_ = parallel;
+}
+
+void Writer::write(const Matrix& A)
+{
+  int nrows = A.getNumRows();
+  int ncols = A.getNumCols();
+  writeArray(nrows > 0 && ncols > 0 ? &A(0,0) : NULL, nrows, ncols, false);
+}
+
+void Writer::write(const Vector& v)
+{
+  int n = v.getNumElements();
+  writeArray(n > 0 ? &v[0] : NULL, n, 1, true);
+}
+
+void Writer::writeArray(const double* values, const int nrows,
+                        const int ncols, const bool vectorLayout)
+{
+  char header[64];
+
+  if(format_ == WRITE_BINARY)
+  {
+    std::int32_t dims[2] = {nrows, ncols};
+    std::memcpy(header, "MORPHEUS", 8);
+    std::memcpy(header+8, dims, sizeof(dims));
+    put(header, 8 + sizeof(dims));
+    put(reinterpret_cast<const char*>(values),
+        (std::size_t)nrows*ncols*sizeof(double));
+    flush();
+    if(os_ != NULL)
+      os_->flush();
+    return;
+  }
+
+  // The header
+  char* p = header;
+  if(vectorLayout)
+  {
+    p = append(p, "Vector with ");
+    p = formatInt(p, header+sizeof(header), nrows);
+    p = append(p, " entries\n");
+  }
+  else
+  {
+    p = formatInt(p, header+sizeof(header), nrows);
+    p = append(p, "x");
+    p = formatInt(p, header+sizeof(header), ncols);
+    p = append(p, " Matrix\n");
+  }
+  put(header, p - header);
+
+  // Rows are formatted in blocks of about bufferSize_ bytes, one block
+  // per thread at a time, and the blocks are written in order
+  std::size_t rowBytes = ncols*(entryBytes(precision_) + 1) +
+                         (vectorLayout ? 32 : 1);
+  int rowsPerBlock = (int)std::max<std::size_t>(1, bufferSize_ / rowBytes);
+  int nblocks = parallel_ ? getNumThreads() : 1;
+  std::vector< std::vector<char> > blocks(nblocks);
+  std::vector<std::size_t> blockLengths(nblocks);
+
+  for(int first=0; first<nrows; first += nblocks*rowsPerBlock)
+  {
+    #pragma omp parallel for schedule(static) if(nblocks > 1)
+    for(int b=0; b<nblocks; b++)
+    {
+      int rbegin = std::min(nrows, first + b*rowsPerBlock);
+      int rend = std::min(nrows, rbegin + rowsPerBlock);
+      std::vector<char>& block = blocks[b];
+      block.resize((std::size_t)(rend-rbegin)*rowBytes);
+      char* q = block.data();
+      char* end = q + block.size();
+      for(int r=rbegin; r<rend; r++)
+      {
+        const double* row = values + (std::size_t)r*ncols;
+        if(vectorLayout)
+        {
+          q = append(q, "data[");
+          q = formatInt(q, end, r);
+          q = append(q, "] = ");
+          q = formatDouble(q, end, row[0], precision_);
+        }
+        else
+        {
+          for(int c=0; c<ncols; c++)
+          {
+            q = formatDouble(q, end, row[c], precision_);
+            *q++ = ' ';
+          }
+        }
+        *q++ = '\n';
+      }
+      blockLengths[b] = q - block.data();
+    }
+
+    for(int b=0; b<nblocks; b++)
+      put(blocks[b].data(), blockLengths[b]);
+  }
+  flush();
+  if(os_ != NULL)
+    os_->flush();
+}
+
+void Writer::put(const char* data, const std::size_t nbytes)
+{
+  if(buffer_.size() + nbytes > bufferSize_)
+    flush();
+  if(nbytes >= bufferSize_)
+    emit(data, nbytes);
+  else
+    buffer_.insert(buffer_.end(), data, data + nbytes);
+}
+
+void Writer::flush()
+{
+  emit(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
+
+void Writer::emit(const char* data, std::size_t nbytes)
+{
+  if(os_ != NULL)
+  {
+    if(nbytes > 0)
+      os_->write(data, nbytes);
+    return;
+  }
+
+  while(nbytes > 0)
+  {
+    ssize_t done = ::write(fd_, data, nbytes);
+    if(done < 0 && errno == EINTR)
+      continue;
+    if(done < 0)
+      throw std::runtime_error(std::string("Writer: ") +
+                               std::strerror(errno));
+    data += done;
+    nbytes -= done;
+  }
+}
+
+} /* namespace Morpheus */
@@ -0,0 +1,140 @@
+/**
+ * @file
+ * \brief Defines a buffered writer for Matrix and Vector
+ *
+ * @author Alicia Klinvex
+ */
+
+#ifndef MORPHEUS_WRITER_H_
+#define MORPHEUS_WRITER_H_
+
+#include "Morpheus_Matrix.h"
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+namespace Morpheus {
+
+//! Layouts that Writer can produce
+enum WriteFormat {
+  //! The layout of Matrix::print and Vector::print
+  WRITE_TEXT,
+  /** The bytes "MORPHEUS", the number of rows and of columns as
+   * 32-bit integers (a Vector has one column), then the entries row by
+   * row as raw doubles.  Integers and doubles are in the byte order of
+   * the machine that wrote them. */
+  WRITE_BINARY
+};
+
+/** \class Writer
+ * \brief Writes matrices and vectors to a stream or file descriptor
+ *
+ * Numbers are formatted with <tt>std::to_chars</tt> (or
+ * <tt>snprintf</tt> where the standard library lacks it) into large
+ * blocks, and each block is handed to the stream or file descriptor
+ * in one call, so nothing is flushed line by line.  Blocks of rows
+ * are formatted by different threads and written in order, so the
+ * output does not depend on the number of threads.
+ *
+ * Usage:
+ * \code
+ * std::ofstream out("A.txt");
+ * Morpheus::Writer writer(out);
+ * writer.write(A);      // same layout as A.print(), every digit kept
+ * \endcode
+ *
+ * \example Morpheus_Writer_Tests.cpp
+ * Demonstrates the text and binary formats
+ */
+class Writer {
+public:
+  //! \name Constructors and destructors
+  ///@{
+  /** \brief Writes to \a os
+   *
+   * Failures are reported through the state of \a os, as with any
+   * other output to it.
+   */
+  explicit Writer(std::ostream& os, const WriteFormat format=WRITE_TEXT);
+
+  /** \brief Writes to the open file descriptor \a fd with
+   * <tt>write(2)</tt>
+   *
+   * The descriptor is not closed.  A failed write throws
+   * std::runtime_error.
+   */
+  explicit Writer(const int fd, const WriteFormat format=WRITE_TEXT);
+  ///@}
+
+  //! \name Options
+  ///@{
+  /** \brief Sets the number of significant digits of the text format
+   *
+   * With \a digits > 0 every entry is written as by
+   * <tt>printf("%.*g", digits, x)</tt>, which is what Matrix::print
+   * gets from <tt>std::cout</tt> (6 digits by default).  With 0, the
+   * default, each entry gets the fewest digits that read back as
+   * exactly the same double.
+   */
+  void setPrecision(const int digits);
+
+  /** \brief Sets the size of the blocks handed to the output
+   *
+   * Each thread formats about this many bytes at a time.  Default:
+   * 1 MB.
+   */
+  void setBufferSize(const std::size_t bytes);
+
+  //! Enables or disables formatting with several threads (default: on)
+  void setParallel(const bool parallel);
+  ///@}
+
+  /** \name Output
+   * Everything is handed to the output, and a stream is flushed,
+   * before these return.
+   */
+  ///@{
+  //! Writes \a A
+  void write(const Matrix& A);
+
+  //! Writes \a v
+  void write(const Vector& v);
+  ///@}
+
+private:
+  //! Copying is not supported
+  Writer(const Writer&);
+  //! Copying is not supported
+  Writer& operator=(const Writer&);
+
+  //! Writes the header and entries of an nrows x ncols array
+  void writeArray(const double* values, const int nrows, const int ncols,
+                  const bool vectorLayout);
+
+  //! Buffers \a nbytes bytes, or writes them directly if they are many
+  void put(const char* data, const std::size_t nbytes);
+
+  //! Passes \a nbytes bytes to the stream or file descriptor
+  void emit(const char* data, std::size_t nbytes);
+
+  //! Emits the buffered bytes and empties the buffer
+  void flush();
+
+  //! Stream to write to, or NULL
+  std::ostream* os_;
+  //! File descriptor to write to, if \a os_ is NULL
+  int fd_;
+  //! Layout of the output
+  WriteFormat format_;
+  //! Significant digits, or 0 for the shortest exact representation
+  int precision_;
+  //! Bytes per formatted block
+  std::size_t bufferSize_;
+  //! Whether blocks are formatted by several threads
+  bool parallel_;
+  //! Bytes not yet written
+  std::vector<char> buffer_;
+};
+
+} /* namespace Morpheus */
+#endif /* MORPHEUS_WRITER_H_ */
@@ -0,0 +1,108 @@
+/*
+ * Morpheus_bandwidthBench.cpp
+ *
+ * Measures the memory bandwidth of Vector::add and the matrix-vector
+ * multiply for each allocation policy as the number of threads grows.
+ * On a dual-socket node, ALLOC_UNTOUCHED followed by a serial
+ * initialization should stop scaling once one memory controller is
+ * saturated, while ALLOC_FIRST_TOUCH and ALLOC_INTERLEAVED should
+ * keep scaling across both sockets.
+ *
+ * Usage: Morpheus_bandwidthBench.exe [vector length] [matrix rows]
+ * Build with: make bench OMPFLAGS=-fopenmp [NUMA=1]
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// Runs both kernels with the given policy and prints GB/s
+static void runPolicy(const char* name, Morpheus::AllocPolicy policy,
+                      int n, int nrows, int ntrials)
+{
+  Morpheus::Vector a(n, policy), b(n, policy), c(n, policy);
+
+  // Emulate code that fills its data from a single thread
+  if(policy == Morpheus::ALLOC_UNTOUCHED)
+  {
+    for(int i=0; i<n; i++) { a[i] = 1; b[i] = 2; c[i] = 0; }
+  }
+  else
+  {
+    a.setValue(1); b.setValue(2);
+  }
+
+  double best = 1e30;
+  for(int t=0; t<ntrials; t++)
+  {
+    double start = wallTime();
+    a.add(b, c);
+    double elapsed = wallTime() - start;
+    if(elapsed < best) best = elapsed;
+  }
+  double addBW = 3.0 * sizeof(double) * n / best / 1e9;
+
+  int ncols = nrows;
+  Morpheus::Matrix A(nrows, ncols, policy);
+  Morpheus::Vector x(ncols, policy), y(nrows, policy);
+  // With ALLOC_UNTOUCHED this serial loop decides the placement;
+  // otherwise the pages were already placed by the constructor
+  for(int r=0; r<nrows; r++)
+    for(int col=0; col<ncols; col++)
+      A(r,col) = 1.0 / (r+col+1);
+  for(int i=0; i<ncols; i++)
+    x[i] = 1;
+
+  best = 1e30;
+  for(int t=0; t<ntrials; t++)
+  {
+    double start = wallTime();
+    A.multiply(x, y);
+    double elapsed = wallTime() - start;
+    if(elapsed < best) best = elapsed;
+  }
+  double mvBW = sizeof(double) * (double)nrows * ncols / best / 1e9;
+
+  std::cout << "  " << name << ": add " << addBW << " GB/s, "
+            << "matvec " << mvBW << " GB/s\n";
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : (1 << 25);
+  int nrows = (argc > 2) ? atoi(argv[2]) : 8192;
+  int ntrials = 5;
+
+  Morpheus::pinThreads();
+  int maxThreads = Morpheus::getNumThreads();
+
+  std::cout << "NUMA nodes: " << Morpheus::getNumNumaNodes()
+            << ", max threads: " << maxThreads << "\n";
+
+  for(int nthreads=1; ; nthreads*=2)
+  {
+    if(nthreads > maxThreads) nthreads = maxThreads;
+#ifdef _OPENMP
+    omp_set_num_threads(nthreads);
+#endif
+    std::cout << nthreads << " thread(s)\n";
+    runPolicy("serial init ", Morpheus::ALLOC_UNTOUCHED, n, nrows, ntrials);
+    runPolicy("first touch ", Morpheus::ALLOC_FIRST_TOUCH, n, nrows, ntrials);
+    runPolicy("interleaved ", Morpheus::ALLOC_INTERLEAVED, n, nrows, ntrials);
+    if(nthreads == maxThreads) break;
+  }
+
+  return EXIT_SUCCESS;
+}
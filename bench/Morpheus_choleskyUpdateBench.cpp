@@ -0,0 +1,85 @@
+/*
+ * Morpheus_choleskyUpdateBench.cpp
+ *
+ * Follows a covariance matrix that changes by a rank-1 term every
+ * step, as an online estimator would, and times the two ways to keep
+ * its Cholesky factor current: refactoring the updated matrix from
+ * scratch, O(n^3), and updating or downdating the factor in place,
+ * O(n^2).  The gap should grow linearly with n.
+ *
+ * Usage: Morpheus_choleskyUpdateBench.exe [n] [steps]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 2000;
+  int nsteps = (argc > 2) ? atoi(argv[2]) : 10;
+  int k = 50;
+
+  // A covariance matrix built from k samples plus a ridge
+  Morpheus::Matrix X(n, k), C(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<k; c++)
+      X(r,c) = std::sin(r*k + c + 1.0);
+  }
+  C.syrk(1, X, 0);
+  for(int i=0; i<n; i++)
+    C(i,i) += 1;
+
+  Morpheus::Matrix R(C);
+  double start = wallTime();
+  R.factorCholesky();
+  double factorTime = wallTime() - start;
+
+  // Each step adds a new sample and drops an old one
+  Morpheus::Vector add(n), drop(n);
+  double syrTime = 0, updateTime = 0, refactorTime = 0;
+  for(int step=0; step<nsteps; step++)
+  {
+    for(int i=0; i<n; i++)
+    {
+      add[i] = std::cos(i*(step + 2.0));
+      drop[i] = 0.5*add[i];
+    }
+
+    start = wallTime();
+    C.syr(1, add);
+    C.syr(-1, drop);
+    syrTime += wallTime() - start;
+
+    start = wallTime();
+    R.updateCholesky(add);
+    R.downdateCholesky(drop);
+    updateTime += wallTime() - start;
+
+    start = wallTime();
+    Morpheus::Matrix Rnew(C);
+    Rnew.factorCholesky();
+    refactorTime += wallTime() - start;
+  }
+
+  std::cout << n << " x " << n << " covariance, " << nsteps << " steps, "
+            << Morpheus::getNumThreads() << " threads\n"
+            << "initial factorization: " << factorTime*1e3 << " ms\n"
+            << "per step: syr " << syrTime/nsteps*1e3 << " ms, update + "
+            << "downdate " << updateTime/nsteps*1e3 << " ms, refactor "
+            << refactorTime/nsteps*1e3 << " ms\n";
+
+  return EXIT_SUCCESS;
+}
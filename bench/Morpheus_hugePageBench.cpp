@@ -0,0 +1,93 @@
+/*
+ * Morpheus_hugePageBench.cpp
+ *
+ * Times the construction of a large Matrix and Vector (which faults in
+ * every page), the matrix-vector multiply, and a random permutation of
+ * a long vector for each huge page mode.  The permutation touches a
+ * new page on almost every access, so it shows the TLB effect most
+ * clearly; the multiply streams through memory and mostly shows the
+ * cost of the page walks the hardware prefetcher cannot hide.
+ *
+ * The explicit 2 MB and 1 GB modes need pages reserved by the
+ * administrator, for example
+ *   sysctl vm.nr_hugepages=1024
+ * and otherwise fall back to transparent huge pages; the mode each
+ * buffer actually got is printed.
+ *
+ * Usage: Morpheus_hugePageBench.exe [matrix rows] [vector length]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_Matrix.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+#include <vector>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+int main(int argc, char* argv[])
+{
+  int nrows = (argc > 1) ? atoi(argv[1]) : 8192;
+  int n = (argc > 2) ? atoi(argv[2]) : 1 << 26;
+  int ntrials = 5;
+
+  std::vector<int> perm(n);
+  for(int i=0; i<n; i++)
+    perm[i] = i;
+  srand(1);
+  for(int i=n-1; i>0; i--)
+    std::swap(perm[i], perm[((long)rand()*RAND_MAX + rand()) % (i+1)]);
+
+  Morpheus::HugePageMode modes[4] = { Morpheus::HUGEPAGES_NONE,
+    Morpheus::HUGEPAGES_TRANSPARENT, Morpheus::HUGEPAGES_2MB,
+    Morpheus::HUGEPAGES_1GB };
+  const char* names[4] = { "4 KB", "transparent", "2 MB", "1 GB" };
+
+  std::cout << nrows << " x " << nrows << " matrix, vector of " << n
+            << " entries, " << Morpheus::getNumThreads() << " threads\n";
+  for(int h=0; h<4; h++)
+  {
+    Morpheus::setHugePageMode(modes[h]);
+
+    double start = wallTime();
+    Morpheus::Matrix A(nrows, nrows);
+    double matrixTime = wallTime() - start;
+    start = wallTime();
+    Morpheus::Vector v(n);
+    double vectorTime = wallTime() - start;
+
+    Morpheus::Vector x(nrows), y(nrows);
+    x.setValue(1);
+    for(int r=0; r<nrows; r++)
+      A(r,r) = 1;
+    v.setValue(1);
+
+    double multiplyTime = 1e30, permuteTime = 1e30;
+    for(int t=0; t<ntrials; t++)
+    {
+      start = wallTime();
+      A.multiply(x, y);
+      multiplyTime = std::min(multiplyTime, wallTime() - start);
+
+      start = wallTime();
+      v.permute(&perm[0]);
+      permuteTime = std::min(permuteTime, wallTime() - start);
+    }
+
+    std::cout << names[h] << " (got "
+              << names[Morpheus::getPageMode(&A(0,0))] << "): construct "
+              << matrixTime*1e3 << " ms + " << vectorTime*1e3
+              << " ms, multiply " << multiplyTime*1e3 << " ms, permute "
+              << permuteTime*1e3 << " ms\n";
+  }
+
+  return EXIT_SUCCESS;
+}
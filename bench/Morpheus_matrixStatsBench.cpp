@@ -0,0 +1,124 @@
+/*
+ * Morpheus_matrixStatsBench.cpp
+ *
+ * Times the summary a monitoring loop wants from a dense symmetric
+ * matrix -- 1-, infinity- and Frobenius norms, largest entry, nonzero
+ * count, symmetry, triangularity and bandwidth -- computed the old
+ * way, one sweep per quantity with the 1-norm walking down columns,
+ * and with the single tiled pass of Matrix::computeStats.
+ *
+ * Usage: Morpheus_matrixStatsBench.exe [n] [repetitions]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_BandedMatrix.h"
+#include "Morpheus_Matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// One sweep per quantity, as the separate query functions used to do
+static Morpheus::MatrixStats separateSweeps(const Morpheus::Matrix& A)
+{
+  int n = A.getNumRows();
+  Morpheus::MatrixStats stats;
+
+  stats.norm1 = 0;
+  for(int c=0; c<n; c++)
+  {
+    double sum = 0;
+    for(int r=0; r<n; r++)
+      sum += std::abs(A(r,c));
+    stats.norm1 = std::max(stats.norm1, sum);
+  }
+
+  stats.normInf = 0;
+  for(int r=0; r<n; r++)
+  {
+    double sum = 0;
+    for(int c=0; c<n; c++)
+      sum += std::abs(A(r,c));
+    stats.normInf = std::max(stats.normInf, sum);
+  }
+
+  double squares = 0;
+  stats.maxAbs = 0;
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      squares += A(r,c)*A(r,c);
+      stats.maxAbs = std::max(stats.maxAbs, std::abs(A(r,c)));
+    }
+  }
+  stats.normFrobenius = std::sqrt(squares);
+
+  stats.nnz = 0;
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      stats.nnz += (A(r,c) != 0);
+  }
+
+  stats.symmetric = true;
+  for(int r=0; r<n && stats.symmetric; r++)
+  {
+    for(int c=0; c<n; c++)
+      stats.symmetric = stats.symmetric && A(r,c) == A(c,r);
+  }
+
+  Morpheus::BandedMatrix::detectBandwidth(A, 0, stats.lowerBandwidth,
+                                          stats.upperBandwidth);
+  stats.upperTriangular = (stats.lowerBandwidth == 0);
+  stats.lowerTriangular = (stats.upperBandwidth == 0);
+  return stats;
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 4000;
+  int nreps = (argc > 2) ? atoi(argv[2]) : 3;
+
+  Morpheus::Matrix A(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      A(r,c) = std::sin(1.0*r*c + r + c);
+  }
+  const Morpheus::Matrix& constA = A;
+
+  double separateTime = 0, singleTime = 0;
+  Morpheus::MatrixStats separate, single;
+  for(int rep=0; rep<nreps; rep++)
+  {
+    double start = wallTime();
+    separate = separateSweeps(constA);
+    separateTime += wallTime() - start;
+
+    start = wallTime();
+    single = constA.computeStats();
+    singleTime += wallTime() - start;
+  }
+
+  std::cout << n << " x " << n << " symmetric matrix, "
+            << Morpheus::getNumThreads() << " threads\n"
+            << "separate sweeps: " << separateTime/nreps*1e3 << " ms\n"
+            << "computeStats:    " << singleTime/nreps*1e3 << " ms\n"
+            << "norms " << single.norm1 << " " << single.normInf << " "
+            << single.normFrobenius << ", bandwidth "
+            << single.lowerBandwidth << "," << single.upperBandwidth
+            << (single.symmetric == separate.symmetric &&
+                single.nnz == separate.nnz ? "" : ", MISMATCH") << "\n";
+
+  return EXIT_SUCCESS;
+}
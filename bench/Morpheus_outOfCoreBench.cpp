@@ -0,0 +1,88 @@
+/*
+ * Morpheus_outOfCoreBench.cpp
+ *
+ * Compares the throughput of the out-of-core matrix-vector product
+ * with a plain sequential read of the same file.  With enough tile
+ * buffers the two should be close, since the multiplication overlaps
+ * the reads.
+ *
+ * Usage: Morpheus_outOfCoreBench.exe file n [tile size] [budget in MB]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ *
+ * \note Drop the page cache between runs (or use a file larger than
+ * RAM), otherwise this measures memory bandwidth instead of disk
+ * bandwidth.
+ */
+
+#include "Morpheus_OutOfCoreMatrix.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+int main(int argc, char* argv[])
+{
+  if(argc < 3)
+  {
+    std::cout << "Usage: " << argv[0] << " file n [tile size] [budget in MB]\n";
+    return EXIT_FAILURE;
+  }
+  std::string filename = argv[1];
+  int n = atoi(argv[2]);
+  int tileSize = (argc > 3) ? atoi(argv[3]) : 2048;
+  std::size_t budget = ((argc > 4) ? atol(argv[4]) : 256) << 20;
+
+  // Every tile is rewritten below, so start from a new file; one left
+  // by a run with another n or tile size would be rejected
+  std::remove(filename.c_str());
+  Morpheus::OutOfCoreMatrix A(filename, n, n, tileSize, budget);
+
+  // Fill the file one tile at a time
+  Morpheus::Matrix tile(tileSize, tileSize);
+  for(int tr=0; tr<A.getNumTileRows(); tr++)
+  {
+    for(int tc=0; tc<A.getNumTileCols(); tc++)
+    {
+      for(int r=0; r<tileSize; r++)
+        for(int c=0; c<tileSize; c++)
+          tile(r,c) = 1.0 / (tr + tc + r + c + 1);
+      A.writeTile(tr, tc, tile);
+    }
+  }
+  double gbytes = (double)A.getNumTileRows() * A.getNumTileCols() *
+                  tileSize * tileSize * sizeof(double) / 1e9;
+
+  // Raw sequential read of the whole file
+  int fd = open(filename.c_str(), O_RDONLY);
+  std::size_t chunk = 16 << 20;
+  char* buf = new char[chunk];
+  double start = wallTime();
+  while(read(fd, buf, chunk) > 0)
+    ;
+  double readTime = wallTime() - start;
+  close(fd);
+  delete[] buf;
+
+  Morpheus::Vector x(n), y(n);
+  x.setValue(1);
+  start = wallTime();
+  A.multiply(x, y);
+  double multiplyTime = wallTime() - start;
+
+  std::cout << gbytes << " GB in " << A.getNumBuffers() << " buffers of "
+            << tileSize << "x" << tileSize << "\n"
+            << "sequential read: " << gbytes / readTime << " GB/s\n"
+            << "out-of-core matvec: " << gbytes / multiplyTime << " GB/s\n";
+
+  return EXIT_SUCCESS;
+}
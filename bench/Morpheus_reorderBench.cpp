@@ -0,0 +1,103 @@
+/*
+ * Morpheus_reorderBench.cpp
+ *
+ * Scrambles the numbering of a 7-point Laplacian on an n x n x n grid,
+ * as an unstructured mesh generator might, then times the CSR
+ * matrix-vector multiply before and after each reordering.  Once the
+ * matrix no longer fits in cache, the scrambled product should be
+ * several times slower because almost every gather from x misses.
+ *
+ * Usage: Morpheus_reorderBench.exe [n]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_Reordering.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// Returns the best of several timings of A*x
+static double timeMultiply(const Morpheus::CsrMatrix& A)
+{
+  Morpheus::Vector x(A.getNumRows()), y(A.getNumRows());
+  x.setValue(1);
+
+  double best = 1e30;
+  for(int t=0; t<20; t++)
+  {
+    double start = wallTime();
+    A.multiply(x, y);
+    double elapsed = wallTime() - start;
+    if(elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 80;
+  int nv = n*n*n;
+
+  std::vector<int> scramble(nv);
+  for(int i=0; i<nv; i++)
+    scramble[i] = i;
+  srand(1);
+  for(int i=nv-1; i>0; i--)
+    std::swap(scramble[i], scramble[rand() % (i+1)]);
+
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  for(int i=0; i<n; i++)
+  {
+    for(int j=0; j<n; j++)
+    {
+      for(int k=0; k<n; k++)
+      {
+        int v = (i*n + j)*n + k;
+        int nbr[7] = { v, v-n*n, v+n*n, v-n, v+n, v-1, v+1 };
+        bool inside[7] = { true, i > 0, i < n-1, j > 0, j < n-1, k > 0, k < n-1 };
+        for(int d=0; d<7; d++)
+        {
+          if(!inside[d])
+            continue;
+          rows.push_back(scramble[v]);
+          cols.push_back(scramble[nbr[d]]);
+          vals.push_back(d == 0 ? 6 : -1);
+        }
+      }
+    }
+  }
+  Morpheus::CsrMatrix scrambled(nv, nv, (int)vals.size(),
+                                &rows[0], &cols[0], &vals[0]);
+  double baseTime = timeMultiply(scrambled);
+  std::cout << "scrambled: " << baseTime*1e3 << " ms\n";
+
+  Morpheus::OrderingMethod methods[] = { Morpheus::ORDER_RCM,
+                                         Morpheus::ORDER_NESTED_DISSECTION };
+  const char* names[] = { "RCM", "nested dissection" };
+  for(int m=0; m<2; m++)
+  {
+    Morpheus::CsrMatrix A = scrambled;
+    std::vector<int> perm;
+    double start = wallTime();
+    Morpheus::OrderingReport report = Morpheus::reorder(A, methods[m], perm);
+    double orderTime = wallTime() - start;
+    double time = timeMultiply(A);
+    std::cout << names[m] << ": " << time*1e3 << " ms, speedup "
+              << baseTime / time << ", bandwidth " << report.bandwidthBefore
+              << " -> " << report.bandwidthAfter << ", profile "
+              << report.profileBefore << " -> " << report.profileAfter
+              << ", ordering took " << orderTime << " s\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/*
+ * Morpheus_spmvBench.cpp
+ *
+ * Compares the CSR and SELL-C-sigma sparse matrix-vector products on
+ * random matrices with short, irregular rows and with long rows, and
+ * prints the format analyzeSparseFormat picks for each along with its
+ * predicted and measured speedup.
+ *
+ * Usage: Morpheus_spmvBench.exe [rows]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_SellMatrix.h"
+#include <cstdlib>
+#include <iostream>
+#include <sys/time.h>
+#include <vector>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// Returns the best of several timings of A*x
+template<class SparseType>
+static double timeMultiply(const SparseType& A, const Morpheus::Vector& x,
+                           Morpheus::Vector& y, int ntrials)
+{
+  double best = 1e30;
+  for(int t=0; t<ntrials; t++)
+  {
+    double start = wallTime();
+    A.multiply(x, y);
+    double elapsed = wallTime() - start;
+    if(elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+// Builds a random n x n matrix whose row lengths are uniform in
+// [minLen, maxLen], with columns near the diagonal
+static void runCase(const char* name, int n, int minLen, int maxLen)
+{
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  for(int r=0; r<n; r++)
+  {
+    int len = minLen + rand() % (maxLen - minLen + 1);
+    for(int k=0; k<len; k++)
+    {
+      rows.push_back(r);
+      cols.push_back((r + rand() % 2001 - 1000 + n) % n);
+      vals.push_back((double)rand() / RAND_MAX);
+    }
+  }
+  Morpheus::CsrMatrix A(n, n, (int)vals.size(), &rows[0], &cols[0], &vals[0]);
+  Morpheus::SellMatrix S(A);
+  Morpheus::SparseFormatAnalysis analysis = Morpheus::analyzeSparseFormat(A);
+
+  Morpheus::Vector x(n), y(n);
+  x.setValue(1);
+  int ntrials = 20;
+  double csrTime = timeMultiply(A, x, y, ntrials);
+  double sellTime = timeMultiply(S, x, y, ntrials);
+
+  std::cout << name << ": " << A.getNumEntries() << " nonzeros, "
+            << "SELL-" << S.getChunkHeight() << "-" << S.getSigma()
+            << " fill " << S.getFillEfficiency() << "\n"
+            << "  CSR " << csrTime*1e3 << " ms, SELL " << sellTime*1e3
+            << " ms, measured speedup " << csrTime / sellTime << "\n"
+            << "  chose " << (analysis.format == Morpheus::SPARSE_SELL ? "SELL" : "CSR")
+            << ", predicted speedup " << analysis.predictedSpeedup << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+  srand(1);
+  runCase("short irregular rows", n, 1, 8);
+  runCase("long rows", n/10, 80, 120);
+
+  return EXIT_SUCCESS;
+}
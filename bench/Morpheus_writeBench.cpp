@@ -0,0 +1,103 @@
+/*
+ * Morpheus_writeBench.cpp
+ *
+ * Writes one dense matrix to a file the way print() used to, streaming
+ * every entry and ending every row with std::endl, and then with a
+ * Writer: as text at print()'s precision and at full round-trip
+ * precision, with one thread and with all of them, and as binary.
+ *
+ * Usage: Morpheus_writeBench.exe [n] [file]
+ * Build with: make bench OMPFLAGS=-fopenmp
+ */
+
+#include "Morpheus_Writer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Returns the wall clock time in seconds
+static double wallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+// Returns the size of the file in MB
+static double fileSize(const std::string& filename)
+{
+  struct stat st;
+  stat(filename.c_str(), &st);
+  return st.st_size / 1e6;
+}
+
+// Writes A to filename with a Writer and reports how long it took
+static void timeWriter(const Morpheus::Matrix& A, const std::string& filename,
+                       const char* label, const Morpheus::WriteFormat format,
+                       const int precision, const bool parallel)
+{
+  double start = wallTime();
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  Morpheus::Writer writer(fd, format);
+  writer.setPrecision(precision);
+  writer.setParallel(parallel);
+  writer.write(A);
+  close(fd);
+  double elapsed = wallTime() - start;
+  std::cout << label << elapsed*1e3 << " ms, " << fileSize(filename)
+            << " MB\n";
+}
+
+int main(int argc, char* argv[])
+{
+  int n = (argc > 1) ? atoi(argv[1]) : 2000;
+  std::string filename = (argc > 2) ? argv[2] : "Morpheus_writeBench.out";
+
+  Morpheus::Matrix A(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      A(r,c) = std::sin(r*n + c + 1.0) * std::pow(10.0, (r+c) % 20 - 10);
+  }
+  const Morpheus::Matrix& constA = A;
+
+  std::cout << n << " x " << n << " matrix, " << Morpheus::getNumThreads()
+            << " threads\n";
+
+  // The old print()
+  double start = wallTime();
+  {
+    std::ofstream out(filename.c_str());
+    out << n << "x" << n << " Matrix\n";
+    for(int r=0; r<n; r++)
+    {
+      for(int c=0; c<n; c++)
+        out << constA(r,c) << " ";
+      out << std::endl;
+    }
+  }
+  double elapsed = wallTime() - start;
+  std::cout << "ostream with endl, 6 digits:   " << elapsed*1e3 << " ms, "
+            << fileSize(filename) << " MB\n";
+
+  timeWriter(A, filename, "Writer, 6 digits, 1 thread:    ",
+             Morpheus::WRITE_TEXT, 6, false);
+  timeWriter(A, filename, "Writer, 6 digits, parallel:    ",
+             Morpheus::WRITE_TEXT, 6, true);
+  timeWriter(A, filename, "Writer, round-trip, 1 thread:  ",
+             Morpheus::WRITE_TEXT, 0, false);
+  timeWriter(A, filename, "Writer, round-trip, parallel:  ",
+             Morpheus::WRITE_TEXT, 0, true);
+  timeWriter(A, filename, "Writer, binary:                ",
+             Morpheus::WRITE_BINARY, 0, true);
+
+  std::remove(filename.c_str());
+  return EXIT_SUCCESS;
+}
@@ -10,5 +10,39 @@ system('./Morpheus_Vector_addScaleTest.exe');
 $exitval = $exitval | $?;
 system('./Morpheus_Matrix_Tests.exe');
 $exitval = $exitval | $?;
+system('./Morpheus_Memory_allocTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Matrix_strassenTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_OutOfCoreMatrix_multiplyTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Vector_blasTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Backend_checkTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_BandedMatrix_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_DiagonalMatrix_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_SellMatrix_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Spgemm_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Reordering_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Eigensolver_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_RandomizedSvd_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_LinearOperator_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Matrix_copyTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Matrix_updateTest.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Writer_Tests.exe');
+$exitval = $exitval | $?;
+system('./Morpheus_Matrix_statsTest.exe');
+$exitval = $exitval | $?;
 
 exit $exitval;
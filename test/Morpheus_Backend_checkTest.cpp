@@ -0,0 +1,116 @@
+/*
+ * Morpheus_Backend_checkTest.cpp
+ *
+ * Validates every registered backend against the reference backend,
+ * makes sure Matrix and Vector give the same answers no matter which
+ * backend is active, and makes sure check mode catches a broken
+ * backend.
+ */
+
+#include "Morpheus_Backend.h"
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+// A deliberately wrong dot product
+static double brokenDot(const int n, const double* x, const double* y)
+{
+  double sum = 1;
+  for(int i=0; i<n; i++)
+    sum = sum + x[i]*y[i];
+  return sum;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int n = 45;
+
+  // Seed the random number generator
+  srand(time(NULL));
+
+  // Every built-in backend must agree with the reference
+  for(int i=0; i<Morpheus::getNumBackends(); i++)
+  {
+    if(!Morpheus::checkBackend(Morpheus::getBackend(i)))
+    {
+      std::cout << "ERROR: Backend " << Morpheus::getBackend(i).name
+                << " disagrees with the reference\n";
+      testPassed = false;
+    }
+  }
+
+  Morpheus::Matrix A(n,n), B(n,n), C(n,n), Cref(n,n);
+  Morpheus::Vector x(n), y(n), yref(n);
+  for(int r=0; r<n; r++)
+  {
+    x[r] = (double)rand() / RAND_MAX - 0.5;
+    for(int c=0; c<n; c++)
+    {
+      A(r,c) = (double)rand() / RAND_MAX;
+      B(r,c) = (double)rand() / RAND_MAX;
+    }
+  }
+
+  if(!Morpheus::setBackend("reference"))
+  {
+    std::cout << "ERROR: The reference backend is missing\n";
+    testPassed = false;
+  }
+  A.multiply(B, Cref);
+  A.multiply(x, yref);
+  double dotRef = x.dot(yref);
+  double norm1Ref = x.norm1();
+
+  // Run the same operations with every backend in check mode
+  Morpheus::setBackendCheck(true);
+  for(int i=0; i<Morpheus::getNumBackends(); i++)
+  {
+    Morpheus::setBackend(Morpheus::getBackend(i).name);
+    A.multiply(B, C);
+    A.multiply(x, y);
+    if(!C.approxEqual(Cref, 1e-10) || std::abs(x.dot(y) - dotRef) > 1e-10 ||
+       std::abs(x.norm1() - norm1Ref) > 1e-10)
+    {
+      std::cout << "ERROR: Backend " << Morpheus::getBackend(i).name
+                << " changes the results\n";
+      testPassed = false;
+    }
+  }
+  if(Morpheus::getBackendCheckFailures() != 0)
+  {
+    std::cout << "ERROR: Check mode reported a false mismatch\n";
+    testPassed = false;
+  }
+
+  // A broken backend must be caught both ways
+  Morpheus::Backend broken = { "broken", NULL, NULL, brokenDot,
+                               NULL, NULL, NULL, NULL, NULL, NULL };
+  Morpheus::registerBackend(broken);
+  std::cout << "Expecting a dot mismatch:\n";
+  if(Morpheus::checkBackend(Morpheus::getBackend(Morpheus::getNumBackends()-1)))
+  {
+    std::cout << "ERROR: checkBackend missed a broken kernel\n";
+    testPassed = false;
+  }
+  Morpheus::setBackend("broken");
+  x.dot(y);
+  if(Morpheus::getBackendCheckFailures() != 1)
+  {
+    std::cout << "ERROR: Check mode missed a broken kernel\n";
+    testPassed = false;
+  }
+  Morpheus::setBackendCheck(false);
+  Morpheus::setBackend("optimized");
+
+  if(testPassed) {
+    std::cout << "Backend test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Backend test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
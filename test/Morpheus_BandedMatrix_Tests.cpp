@@ -0,0 +1,154 @@
+/*
+ * Morpheus_BandedMatrix_Tests.cpp
+ *
+ * Converts a random banded dense matrix to band storage and checks
+ * the bandwidth detection, products, norms and LU solve against the
+ * dense matrix.  Then solves a large tridiagonal system with the
+ * banded Cholesky factorization.
+ */
+
+#include "Morpheus_BandedMatrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+int main()
+{
+  bool testPassed = true;
+  int n = 50, kl = 2, ku = 3;
+
+  // Seed the random number generator
+  srand(time(NULL));
+
+  // Create a random dense matrix with the given bandwidth
+  Morpheus::Matrix dense(n,n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      if(r-c <= kl && c-r <= ku)
+        dense(r,c) = 2.0*rand()/RAND_MAX - 1;
+      else
+        dense(r,c) = 0;
+    }
+  }
+  // Make sure the outermost diagonals are really nonzero
+  dense(n-1, n-1-kl) = 1;
+  dense(0, ku) = 1;
+
+  Morpheus::BandedMatrix band(dense);
+  if(band.getLowerBandwidth() != kl || band.getUpperBandwidth() != ku)
+  {
+    std::cout << "ERROR: The bandwidth was detected as "
+              << band.getLowerBandwidth() << "," << band.getUpperBandwidth()
+              << " instead of " << kl << "," << ku << "\n";
+    testPassed = false;
+  }
+
+  Morpheus::Matrix copy(n,n);
+  band.copyTo(copy);
+  if(!copy.approxEqual(dense, 0))
+  {
+    std::cout << "ERROR: The band storage does not match the dense matrix\n";
+    testPassed = false;
+  }
+
+  // Products and transposed products
+  Morpheus::Vector x(n), y(n), yDense(n);
+  for(int i=0; i<n; i++)
+    x[i] = 2.0*rand()/RAND_MAX - 1;
+  for(int t=0; t<2; t++)
+  {
+    band.gemv(1, x, 0, y, t == 1);
+    dense.gemv(1, x, 0, yDense, t == 1);
+    for(int i=0; i<n; i++)
+    {
+      if(std::abs(y[i] - yDense[i]) > 1e-12)
+      {
+        std::cout << "ERROR: The banded product is incorrect (transpose = "
+                  << t << ")\n";
+        testPassed = false;
+        break;
+      }
+    }
+  }
+
+  // Norms
+  double maxColSum = 0, maxRowSum = 0;
+  for(int i=0; i<n; i++)
+  {
+    double colSum = 0, rowSum = 0;
+    for(int j=0; j<n; j++)
+    {
+      colSum += std::abs(dense(j,i));
+      rowSum += std::abs(dense(i,j));
+    }
+    if(colSum > maxColSum) maxColSum = colSum;
+    if(rowSum > maxRowSum) maxRowSum = rowSum;
+  }
+  if(std::abs(band.norm1() - maxColSum) > 1e-12 ||
+     std::abs(band.normInf() - maxRowSum) > 1e-12)
+  {
+    std::cout << "ERROR: The banded norms are incorrect\n";
+    testPassed = false;
+  }
+
+  // LU solve: b = A*x, then solve for x in place
+  dense.multiply(x, y);
+  if(!band.factorLU())
+  {
+    std::cout << "ERROR: The banded matrix was reported singular\n";
+    testPassed = false;
+  }
+  band.solve(y, y);
+  for(int i=0; i<n; i++)
+  {
+    if(std::abs(y[i] - x[i]) > 1e-8)
+    {
+      std::cout << "ERROR: The banded LU solve is incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // Large tridiagonal SPD system: the 1D Laplacian
+  int bigN = 100000;
+  Morpheus::BandedMatrix lap(bigN, 1, 1);
+  for(int i=0; i<bigN; i++)
+  {
+    lap(i,i) = 2;
+    if(i > 0) lap(i,i-1) = -1;
+    if(i < bigN-1) lap(i,i+1) = -1;
+  }
+  if(!lap.isSymmetric())
+  {
+    std::cout << "ERROR: The Laplacian should be symmetric\n";
+    testPassed = false;
+  }
+  Morpheus::Vector xBig(bigN), bBig(bigN), solBig(bigN);
+  for(int i=0; i<bigN; i++)
+    xBig[i] = std::sin(0.001*i);
+  lap.multiply(xBig, bBig);
+  if(!lap.factorCholesky())
+  {
+    std::cout << "ERROR: The Laplacian should be positive definite\n";
+    testPassed = false;
+  }
+  lap.solve(bBig, solBig);
+  solBig.axpy(-1, xBig);
+  if(solBig.normInf() > 1e-6)
+  {
+    std::cout << "ERROR: The banded Cholesky solve is incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Banded matrix test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Banded matrix test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Morpheus_DiagonalMatrix_Tests.cpp
+ *
+ * Checks the diagonal matrix product, solve and norms.
+ */
+
+#include "Morpheus_DiagonalMatrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+int main()
+{
+  bool testPassed = true;
+  int n = 6;
+
+  // D = diag(1, -2, 3, -4, 5, -6)
+  Morpheus::Matrix dense(n,n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      dense(r,c) = (r == c) ? ((r % 2 == 0) ? r+1 : -(r+1)) : 0;
+  }
+  Morpheus::DiagonalMatrix diag(dense);
+
+  Morpheus::Vector x(n), y(n), yDense(n);
+  x.setValue(1);
+  diag.gemv(2, x, 0, y);
+  dense.gemv(2, x, 0, yDense);
+  for(int i=0; i<n; i++)
+  {
+    if(y[i] != yDense[i])
+    {
+      std::cout << "ERROR: The diagonal product is incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // Solving with D must undo the product
+  diag.multiply(x, y);
+  diag.solve(y, y);
+  for(int i=0; i<n; i++)
+  {
+    if(std::abs(y[i] - 1) > 1e-14)
+    {
+      std::cout << "ERROR: The diagonal solve is incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  if(diag.norm1() != 6 || diag.normInf() != 6)
+  {
+    std::cout << "ERROR: The diagonal norms are incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Diagonal matrix test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Diagonal matrix test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,190 @@
+/*
+ * Morpheus_Eigensolver_Tests.cpp
+ *
+ * Checks the Lanczos solver on sparse and banded 1D Laplacians, whose
+ * eigenvalues are known, the Arnoldi solver on a nonsymmetric matrix
+ * with a complex conjugate pair of eigenvalues, and Matrix::norm2.
+ */
+
+#include "Morpheus_Eigensolver.h"
+#include "Morpheus_BandedMatrix.h"
+#include "Morpheus_CsrMatrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Returns ||A*x - lambda*x|| for a real eigenpair
+template<class Operator>
+double residual(const Operator& A, double lambda, const Morpheus::Vector& x)
+{
+  Morpheus::Vector Ax(x.getNumElements());
+  A.multiply(x, Ax);
+  Ax.axpy(-lambda, x);
+  return Ax.norm2();
+}
+
+int main()
+{
+  bool testPassed = true;
+  const double pi = 3.14159265358979323846;
+
+  // 1D Laplacian; eigenvalue k is 2 - 2*cos(k*pi/(n+1))
+  int n = 100;
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  Morpheus::BandedMatrix banded(n, 1, 1);
+  for(int i=0; i<n; i++)
+  {
+    rows.push_back(i); cols.push_back(i); vals.push_back(2);
+    banded(i,i) = 2;
+    if(i > 0)
+    {
+      rows.push_back(i); cols.push_back(i-1); vals.push_back(-1);
+      banded(i,i-1) = -1;
+    }
+    if(i < n-1)
+    {
+      rows.push_back(i); cols.push_back(i+1); vals.push_back(-1);
+      banded(i,i+1) = -1;
+    }
+  }
+  Morpheus::CsrMatrix laplacian(n, n, (int)vals.size(),
+                                &rows[0], &cols[0], &vals[0]);
+
+  int nev = 3;
+  Morpheus::Eigensolver lanczos(laplacian, true, nev, 30);
+  int nconv = lanczos.solve(Morpheus::EIG_LARGEST_REAL, 1e-10, 1000);
+  Morpheus::Vector x(n);
+  for(int i=0; i<nev; i++)
+  {
+    double exact = 2 - 2*std::cos((n-i)*pi/(n+1));
+    lanczos.getEigenvector(i, x);
+    double lambda = lanczos.getEigenvalue(i);
+    if(std::abs(lambda - exact) > 1e-8 ||
+       residual(laplacian, lambda, x) > 1e-8 ||
+       std::abs(x.norm2() - 1) > 1e-12)
+    {
+      std::cout << "ERROR: Lanczos eigenpair " << i << " is incorrect: "
+                << lambda << " instead of " << exact << "\n";
+      testPassed = false;
+    }
+  }
+  if(nconv != nev)
+  {
+    std::cout << "ERROR: Lanczos did not converge\n";
+    testPassed = false;
+  }
+
+  // The same operator in banded form, smallest eigenvalue
+  Morpheus::Eigensolver bandedSolver(banded, true, 1, 40);
+  bandedSolver.solve(Morpheus::EIG_SMALLEST_REAL, 1e-10, 1000);
+  double smallest = 2 - 2*std::cos(pi/(n+1));
+  if(std::abs(bandedSolver.getEigenvalue(0) - smallest) > 1e-8)
+  {
+    std::cout << "ERROR: The smallest banded eigenvalue is "
+              << bandedSolver.getEigenvalue(0) << " instead of "
+              << smallest << "\n";
+    testPassed = false;
+  }
+
+  // Block upper triangular: diagonal entries i/n, one 2x2 block with
+  // eigenvalues 1.5 +- 0.5i, and coupling above the blocks
+  rows.clear(); cols.clear(); vals.clear();
+  for(int i=0; i<n; i++)
+  {
+    rows.push_back(i); cols.push_back(i);
+    vals.push_back((i < 2) ? 1.5 : (double)i/n);
+    if(i+2 < n)
+    {
+      rows.push_back(i); cols.push_back(i+2); vals.push_back(0.3);
+    }
+  }
+  rows.push_back(0); cols.push_back(1); vals.push_back(0.5);
+  rows.push_back(1); cols.push_back(0); vals.push_back(-0.5);
+  Morpheus::CsrMatrix nonsym(n, n, (int)vals.size(),
+                             &rows[0], &cols[0], &vals[0]);
+
+  Morpheus::Eigensolver arnoldi(nonsym, false, 3, 30);
+  nconv = arnoldi.solve(Morpheus::EIG_LARGEST_MAGNITUDE, 1e-10, 1000);
+  double expectedRe[] = { 1.5, 1.5, (double)(n-1)/n };
+  double expectedIm[] = { 0.5, 0.5, 0 };
+  Morpheus::Vector re(n), im(n), Are(n), Aim(n);
+  for(int i=0; i<3; i++)
+  {
+    double lr = arnoldi.getEigenvalue(i), li = arnoldi.getEigenvalueImag(i);
+    if(std::abs(lr - expectedRe[i]) > 1e-8 ||
+       std::abs(std::abs(li) - expectedIm[i]) > 1e-8)
+    {
+      std::cout << "ERROR: Arnoldi eigenvalue " << i << " is " << lr
+                << " + " << li << "i\n";
+      testPassed = false;
+    }
+
+    // A*(re + i*im) = (lr + i*li)*(re + i*im)
+    arnoldi.getEigenvector(i, re, im);
+    nonsym.multiply(re, Are);
+    nonsym.multiply(im, Aim);
+    Are.axpy(-lr, re);
+    Are.axpy(li, im);
+    Aim.axpy(-li, re);
+    Aim.axpy(-lr, im);
+    double res = std::sqrt(Are.dot(Are) + Aim.dot(Aim));
+    if(res > 1e-8)
+    {
+      std::cout << "ERROR: Arnoldi eigenvector " << i << " has residual "
+                << res << "\n";
+      testPassed = false;
+    }
+  }
+  if(nconv != 3)
+  {
+    std::cout << "ERROR: Arnoldi did not converge\n";
+    testPassed = false;
+  }
+
+  // A tall matrix with orthogonal columns of lengths 1..ncols, in
+  // scrambled rows; its 2-norm is ncols
+  int nrows = 40, ncols = 25;
+  Morpheus::Matrix tall(nrows, ncols);
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      tall(r,c) = ((r*7) % nrows == c) ? c+1 : 0;
+  }
+  double norm = tall.norm2(1e-12);
+  if(std::abs(norm - ncols) > 1e-8*ncols)
+  {
+    std::cout << "ERROR: The 2-norm is " << norm << " instead of "
+              << ncols << "\n";
+    testPassed = false;
+  }
+
+  // A rank-one matrix u*v^T has 2-norm ||u||*||v||
+  Morpheus::Matrix rankOne(nrows, ncols);
+  double unorm = 0, vnorm = 0;
+  for(int r=0; r<nrows; r++)
+    unorm += (r+1.0)*(r+1.0);
+  for(int c=0; c<ncols; c++)
+    vnorm += 1.0/((c+1.0)*(c+1.0));
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      rankOne(r,c) = (r+1.0)/(c+1.0);
+  }
+  norm = rankOne.norm2();
+  if(std::abs(norm - std::sqrt(unorm*vnorm)) > 1e-8*norm)
+  {
+    std::cout << "ERROR: The rank-one 2-norm is " << norm << " instead of "
+              << std::sqrt(unorm*vnorm) << "\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Eigensolver test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Eigensolver test: FAILED!\n";
+  return EXIT_FAILURE;
+}
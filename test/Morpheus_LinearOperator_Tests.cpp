@@ -0,0 +1,249 @@
+/*
+ * Morpheus_LinearOperator_Tests.cpp
+ *
+ * Checks every matrix class through the LinearOperator interface
+ * against a dense reference, then a matrix-free 2D Laplacian stencil,
+ * the composed operators, and the eigensolver and norm estimator
+ * running on operators that are never stored.
+ */
+
+#include "Morpheus_BandedMatrix.h"
+#include "Morpheus_DiagonalMatrix.h"
+#include "Morpheus_Eigensolver.h"
+#include "Morpheus_OutOfCoreMatrix.h"
+#include "Morpheus_SellMatrix.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// 5-point Laplacian on an nx x ny grid, applied without storing it
+class Laplacian2D : public Morpheus::LinearOperator {
+public:
+  Laplacian2D(int nx, int ny) : nx_(nx), ny_(ny), numApplies_(0) { }
+
+  int getNumRows() const { return nx_*ny_; }
+  int getNumCols() const { return nx_*ny_; }
+
+  void apply(const Morpheus::Vector& X, Morpheus::Vector& Y) const
+  {
+    for(int i=0; i<nx_; i++)
+    {
+      for(int j=0; j<ny_; j++)
+      {
+        int v = i*ny_ + j;
+        double sum = 4*X[v];
+        if(i > 0)     sum -= X[v-ny_];
+        if(i < nx_-1) sum -= X[v+ny_];
+        if(j > 0)     sum -= X[v-1];
+        if(j < ny_-1) sum -= X[v+1];
+        Y[v] = sum;
+      }
+    }
+    numApplies_++;
+  }
+
+  void applyTranspose(const Morpheus::Vector& X, Morpheus::Vector& Y) const
+  {
+    apply(X, Y);
+  }
+
+  int getNumApplies() const { return numApplies_; }
+
+private:
+  int nx_, ny_;
+  mutable int numApplies_;
+};
+
+// Returns max |a - b|
+double maxDiff(const Morpheus::Vector& a, const Morpheus::Vector& b)
+{
+  double diff = 0;
+  for(int i=0; i<a.getNumElements(); i++)
+    diff = std::max(diff, std::abs(a[i] - b[i]));
+  return diff;
+}
+
+// Compares apply, applyTranspose and gemv with the dense matrix D
+bool compare(const char* name, const Morpheus::LinearOperator& A,
+             const Morpheus::Matrix& D)
+{
+  int m = D.getNumRows(), n = D.getNumCols();
+  if(A.getNumRows() != m || A.getNumCols() != n)
+  {
+    std::cout << "ERROR: " << name << " has the wrong dimensions\n";
+    return false;
+  }
+
+  Morpheus::Vector x(n), xt(m), y(m), yt(n), ref(m), reft(n);
+  for(int i=0; i<n; i++)
+    x[i] = std::sin(i + 1.0);
+  for(int i=0; i<m; i++)
+    xt[i] = std::cos(i + 1.0);
+
+  double diff = 0;
+  A.apply(x, y);
+  D.gemv(1, x, 0, ref);
+  diff = std::max(diff, maxDiff(y, ref));
+  A.applyTranspose(xt, yt);
+  D.gemv(1, xt, 0, reft, true);
+  diff = std::max(diff, maxDiff(yt, reft));
+
+  // gemv with both scalars, starting from nonzero outputs
+  for(int i=0; i<m; i++)
+    y[i] = ref[i] = i;
+  for(int i=0; i<n; i++)
+    yt[i] = reft[i] = -i;
+  A.gemv(2, x, -0.5, y);
+  D.gemv(2, x, -0.5, ref);
+  diff = std::max(diff, maxDiff(y, ref));
+  A.gemv(-1.5, xt, 3, yt, true);
+  D.gemv(-1.5, xt, 3, reft, true);
+  diff = std::max(diff, maxDiff(yt, reft));
+
+  if(diff > 1e-12)
+  {
+    std::cout << "ERROR: " << name << " differs from the dense product by "
+              << diff << "\n";
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  bool testPassed = true;
+  const double pi = 3.14159265358979323846;
+
+  // A rectangular sparse matrix with uneven rows, stored every way
+  int m = 37, n = 29;
+  Morpheus::Matrix D(m, n);
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      if((r*7 + c*3) % (r % 5 + 2) != 0)
+        continue;
+      D(r,c) = std::sin(r*n + c + 0.5);
+      rows.push_back(r); cols.push_back(c); vals.push_back(D(r,c));
+    }
+  }
+  Morpheus::CsrMatrix csr(m, n, (int)vals.size(), &rows[0], &cols[0], &vals[0]);
+  Morpheus::SellMatrix sell(csr, 4, 8);
+  Morpheus::SparseMatrix sparseCsr(csr, false, Morpheus::SPARSE_CSR);
+  Morpheus::SparseMatrix sparseSell(csr, false, Morpheus::SPARSE_SELL);
+  testPassed = compare("Matrix", D, D) && testPassed;
+  testPassed = compare("CsrMatrix", csr, D) && testPassed;
+  testPassed = compare("SellMatrix", sell, D) && testPassed;
+  testPassed = compare("SparseMatrix (CSR)", sparseCsr, D) && testPassed;
+  testPassed = compare("SparseMatrix (SELL)", sparseSell, D) && testPassed;
+
+  const char* filename = "Morpheus_LinearOperator_Tests.bin";
+  {
+    Morpheus::OutOfCoreMatrix disk(filename, m, n, 8, 2*8*8*sizeof(double));
+    disk.writeMatrix(D);
+    testPassed = compare("OutOfCoreMatrix", disk, D) && testPassed;
+  }
+  remove(filename);
+
+  // Square banded and diagonal matrices
+  int nb = 30;
+  Morpheus::BandedMatrix banded(nb, 2, 1);
+  Morpheus::DiagonalMatrix diag(nb);
+  Morpheus::Matrix Dbanded(nb, nb), Ddiag(nb, nb);
+  for(int r=0; r<nb; r++)
+  {
+    for(int c=std::max(0, r-2); c<=std::min(nb-1, r+1); c++)
+      Dbanded(r,c) = banded(r,c) = 1.0 / (r + 2*c + 1);
+    Ddiag(r,r) = diag(r) = r - 10.5;
+  }
+  testPassed = compare("BandedMatrix", banded, Dbanded) && testPassed;
+  testPassed = compare("DiagonalMatrix", diag, Ddiag) && testPassed;
+
+  // The matrix-free stencil against its assembled form, which also
+  // exercises the default LinearOperator::gemv
+  int nx = 12, ny = 9, nv = nx*ny;
+  Laplacian2D stencil(nx, ny);
+  Morpheus::Matrix Dstencil(nv, nv);
+  {
+    Morpheus::Vector e(nv), col(nv);
+    for(int c=0; c<nv; c++)
+    {
+      e.setValue(0);
+      e[c] = 1;
+      stencil.apply(e, col);
+      for(int r=0; r<nv; r++)
+        Dstencil(r,c) = col[r];
+    }
+  }
+  testPassed = compare("Laplacian2D", stencil, Dstencil) && testPassed;
+
+  // Composed operators, checked against their dense equivalents
+  Morpheus::Matrix Dsum(nb, nb), Dprod(m, nb), Dscaled(nb, nb),
+                   Dshifted(nb, nb), Dtrans(n, m);
+  for(int r=0; r<nb; r++)
+  {
+    for(int c=0; c<nb; c++)
+    {
+      Dsum(r,c) = Dbanded(r,c) + Ddiag(r,c);
+      Dscaled(r,c) = -2.5*Dbanded(r,c);
+      Dshifted(r,c) = Dbanded(r,c) + ((r == c) ? 0.75 : 0);
+    }
+  }
+  Morpheus::Matrix Dleft(m, nb);
+  for(int r=0; r<m; r++)
+  {
+    for(int c=0; c<nb; c++)
+      Dleft(r,c) = std::cos(r + 2.0*c);
+  }
+  Dleft.multiply(Dbanded, Dprod);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<m; c++)
+      Dtrans(r,c) = D(c,r);
+  }
+
+  Morpheus::SumOperator sum(banded, diag);
+  Morpheus::ProductOperator product(Dleft, banded);
+  Morpheus::ScaledOperator scaled(banded, -2.5);
+  Morpheus::ShiftedOperator shifted(banded, 0.75);
+  Morpheus::TransposeOperator transposed(csr);
+  testPassed = compare("SumOperator", sum, Dsum) && testPassed;
+  testPassed = compare("ProductOperator", product, Dprod) && testPassed;
+  testPassed = compare("ScaledOperator", scaled, Dscaled) && testPassed;
+  testPassed = compare("ShiftedOperator", shifted, Dshifted) && testPassed;
+  testPassed = compare("TransposeOperator", transposed, Dtrans) && testPassed;
+
+  // The eigensolver and the norm estimator only ever see the stencil
+  double largest = 4 + 2*std::cos(pi/(nx+1)) + 2*std::cos(pi/(ny+1));
+  double smallest = 8 - largest;
+  int appliesBefore = stencil.getNumApplies();
+  Morpheus::Eigensolver solver(stencil, true, 1);
+  solver.solve(Morpheus::EIG_SMALLEST_REAL, 1e-10, 1000);
+  if(std::abs(solver.getEigenvalue(0) - smallest) > 1e-8 ||
+     stencil.getNumApplies() - appliesBefore != solver.getNumApplies())
+  {
+    std::cout << "ERROR: The smallest stencil eigenvalue is "
+              << solver.getEigenvalue(0) << " instead of " << smallest << "\n";
+    testPassed = false;
+  }
+
+  double norm = Morpheus::estimateNorm2(stencil, 1e-12);
+  if(std::abs(norm - largest) > 1e-8*largest)
+  {
+    std::cout << "ERROR: The stencil 2-norm is " << norm << " instead of "
+              << largest << "\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "LinearOperator test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "LinearOperator test: FAILED!\n";
+  return EXIT_FAILURE;
+}
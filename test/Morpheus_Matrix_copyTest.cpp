@@ -0,0 +1,208 @@
+/*
+ * Morpheus_Matrix_copyTest.cpp
+ *
+ * Checks that copies of a Matrix or Vector share their entries until
+ * one of them is written, that writing one never changes the others,
+ * that cached properties follow the entries, even when they are
+ * written through a pointer, that a parallel fill detaches a shared
+ * matrix only once, and that many threads can copy, read and modify
+ * one shared matrix at once.
+ */
+
+#include "Morpheus_BandedMatrix.h"
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+int main()
+{
+  bool testPassed = true;
+  int n = 40;
+
+  // A symmetric matrix
+  Morpheus::Matrix A(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      A(r,c) = 1.0 / (r + c + 1);
+  }
+  const Morpheus::Matrix& constA = A;
+
+  // A copy shares the entries and the cached symmetry
+  {
+    Morpheus::Matrix B(A);
+    const Morpheus::Matrix& constB = B;
+    if(A.getUseCount() != 2 || &constB(0,0) != &constA(0,0))
+    {
+      std::cout << "ERROR: The copy does not share the entries\n";
+      testPassed = false;
+    }
+    if(!B.isSymmetric() || !A.isSymmetric() || A.isUpperTriangular())
+    {
+      std::cout << "ERROR: The shared matrix is not symmetric\n";
+      testPassed = false;
+    }
+
+    // Writing the copy detaches it and clears its cached symmetry
+    B(0,1) = 5;
+    if(A.getUseCount() != 1 || B.getUseCount() != 1 ||
+       constA(0,1) != 0.5 || constB(0,1) != 5 || constB(1,0) != 0.5)
+    {
+      std::cout << "ERROR: Writing the copy changed the original\n";
+      testPassed = false;
+    }
+    if(B.isSymmetric() || !A.isSymmetric())
+    {
+      std::cout << "ERROR: The cached symmetry is wrong after a write\n";
+      testPassed = false;
+    }
+
+    // Assignment shares again, even with different dimensions
+    Morpheus::Matrix C(3, 7);
+    C = B;
+    B = B;
+    if(C.getNumRows() != n || C.getNumCols() != n || B.getUseCount() != 2 ||
+       C.isSymmetric())
+    {
+      std::cout << "ERROR: Assignment does not share the entries\n";
+      testPassed = false;
+    }
+  }
+  if(A.getUseCount() != 1)
+  {
+    std::cout << "ERROR: A is still shared after its copies are gone\n";
+    testPassed = false;
+  }
+
+  // Writing through a pointer taken before a property was queried
+  // changes the answer, for the matrix and for its copies
+  {
+    Morpheus::Matrix M(A);
+    double* m = &M(0,0);
+    bool before = M.isSymmetric();
+    m[1] = 5;
+    Morpheus::Matrix copy(M);
+    if(!before || M.isSymmetric() || copy.isSymmetric())
+    {
+      std::cout << "ERROR: The cached symmetry missed a write through a "
+                << "pointer\n";
+      testPassed = false;
+    }
+  }
+
+  // The output of a product is detached, not written in place
+  {
+    Morpheus::Matrix Y(n, n), X(A);
+    Y(0,0) = -1;
+    Morpheus::Matrix Yold(Y);
+    A.multiply(X, Y);
+    double expected = 0;
+    for(int k=0; k<n; k++)
+      expected += constA(0,k)*constA(k,0);
+    const Morpheus::Matrix& constYold = Yold;
+    if(constYold(0,0) != -1 || Yold.getUseCount() != 1 ||
+       std::abs(Y(0,0) - expected) > 1e-12)
+    {
+      std::cout << "ERROR: The product wrote into a shared matrix\n";
+      testPassed = false;
+    }
+  }
+
+  // Vectors behave the same way
+  {
+    Morpheus::Vector v(n);
+    for(int i=0; i<n; i++)
+      v[i] = i;
+    Morpheus::Vector w(v), u(v);
+    w.scale(2);
+    u.setValue(7);
+    const Morpheus::Vector& constV = v;
+    if(v.getUseCount() != 1 || constV[3] != 3 || w[3] != 6 || u[3] != 7)
+    {
+      std::cout << "ERROR: Writing a vector copy changed the original\n";
+      testPassed = false;
+    }
+    u = v;
+    u.axpy(1, v);
+    if(constV[3] != 3 || u[3] != 6)
+    {
+      std::cout << "ERROR: axpy on a shared vector changed the original\n";
+      testPassed = false;
+    }
+  }
+
+  // A parallel fill of a shared matrix detaches it once, not per thread
+  {
+    Morpheus::Matrix T(n, n);
+    for(int r=0; r<n; r++)
+    {
+      for(int c=0; c<n; c++)
+        T(r,c) = (std::abs(r-c) <= 1) ? r + 2.0*c : 0;
+    }
+    const Morpheus::BandedMatrix band(T);
+    Morpheus::Matrix D(A), shared(D);
+    band.copyTo(D);
+    const Morpheus::Matrix& constD = D;
+    const Morpheus::Matrix& constShared = shared;
+    bool copied = D.getUseCount() == 1 && shared.getUseCount() == 2;
+    for(int r=0; r<n; r++)
+    {
+      for(int c=0; c<n; c++)
+        copied = copied && constD(r,c) == band(r,c) &&
+                 constShared(r,c) == constA(r,c);
+    }
+    if(!copied)
+    {
+      std::cout << "ERROR: Filling a shared matrix in parallel failed\n";
+      testPassed = false;
+    }
+  }
+
+  // Every thread reads the shared matrix through its own copy, and
+  // every other thread also modifies its copy; A must never change
+  Morpheus::Vector x(n), y(n);
+  x.setValue(1);
+  A.multiply(x, y);
+  const Morpheus::Vector& constY = y;
+  int numThreads = Morpheus::getNumThreads();
+  std::vector<int> failures(numThreads, 0);
+  #pragma omp parallel for schedule(static)
+  for(int t=0; t<numThreads; t++)
+  {
+    for(int trial=0; trial<20; trial++)
+    {
+      Morpheus::Matrix mine(A);
+      Morpheus::Vector ymine(n);
+      if(t % 2 == 1)
+        mine(trial % n, 0) += t;
+      mine.multiply(x, ymine);
+      double expected = (t % 2 == 1) ? t : 0;
+      if(std::abs(ymine[trial % n] - constY[trial % n] - expected) > 1e-12 ||
+         (t % 2 == 0 && !mine.isSymmetric()))
+        failures[t]++;
+    }
+  }
+  for(int t=0; t<numThreads; t++)
+  {
+    if(failures[t] > 0)
+    {
+      std::cout << "ERROR: Thread " << t << " saw the wrong entries\n";
+      testPassed = false;
+    }
+  }
+  if(A.getUseCount() != 1 || constA(0,0) != 1 || !A.isSymmetric())
+  {
+    std::cout << "ERROR: The threads changed the shared matrix\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Copy-on-write test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Copy-on-write test: FAILED!\n";
+  return EXIT_FAILURE;
+}
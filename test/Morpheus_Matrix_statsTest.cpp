@@ -0,0 +1,152 @@
+/*
+ * Morpheus_Matrix_statsTest.cpp
+ *
+ * Checks computeStats, and the norms and property queries built on
+ * it, against entry-by-entry loops for matrices with negative entries,
+ * symmetric, triangular and banded structure, and rectangular shapes.
+ * The sizes are not multiples of the tile size, so partial tiles and
+ * the mirrored tile pairs are all used.
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+// Compares computeStats with loops over the entries of A
+bool checkStats(const Morpheus::Matrix& A, const std::string& name)
+{
+  int nrows = A.getNumRows(), ncols = A.getNumCols();
+  double norm1 = 0, normInf = 0, squares = 0, maxAbs = 0;
+  long nnz = 0;
+  int lower = 0, upper = 0;
+  bool symmetric = (nrows == ncols);
+  for(int c=0; c<ncols; c++)
+  {
+    double colSum = 0;
+    for(int r=0; r<nrows; r++)
+      colSum += std::abs(A(r,c));
+    norm1 = std::max(norm1, colSum);
+  }
+  for(int r=0; r<nrows; r++)
+  {
+    double rowSum = 0;
+    for(int c=0; c<ncols; c++)
+    {
+      double a = A(r,c);
+      rowSum += std::abs(a);
+      squares += a*a;
+      maxAbs = std::max(maxAbs, std::abs(a));
+      if(a != 0)
+      {
+        nnz++;
+        lower = std::max(lower, r-c);
+        upper = std::max(upper, c-r);
+      }
+      if(symmetric && a != A(c,r))
+        symmetric = false;
+    }
+    normInf = std::max(normInf, rowSum);
+  }
+
+  Morpheus::MatrixStats stats = A.computeStats();
+  bool square = (nrows == ncols);
+  bool passed = std::abs(stats.norm1 - norm1) <= 1e-13*norm1 &&
+                std::abs(stats.normInf - normInf) <= 1e-13*normInf &&
+                std::abs(stats.normFrobenius - std::sqrt(squares)) <=
+                  1e-13*std::sqrt(squares) &&
+                stats.maxAbs == maxAbs && stats.nnz == nnz &&
+                stats.symmetric == symmetric &&
+                stats.upperTriangular == (square && lower == 0) &&
+                stats.lowerTriangular == (square && upper == 0) &&
+                stats.lowerBandwidth == lower && stats.upperBandwidth == upper;
+
+  // The single-property functions agree with the summary
+  passed = passed && A.norm1() == stats.norm1 &&
+           A.normInf() == stats.normInf &&
+           A.normFrobenius() == stats.normFrobenius &&
+           A.isSymmetric() == symmetric &&
+           A.isUpperTriangular() == stats.upperTriangular;
+  if(!passed)
+    std::cout << "ERROR: The statistics of the " << name
+              << " matrix are incorrect\n";
+  return passed;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int n = 150;
+
+  // General, with negative entries and a few zeros
+  Morpheus::Matrix A(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      A(r,c) = ((r*7 + c*3) % 11 == 0) ? 0 : std::sin(r*n + c + 1.0);
+  }
+  testPassed = checkStats(A, "general") && testPassed;
+
+  // Symmetric, then broken in a single entry of an off-diagonal tile
+  // and then of a diagonal tile
+  Morpheus::Matrix S(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      S(r,c) = -1.0 / (r + c + 1);
+  }
+  testPassed = checkStats(S, "symmetric") && testPassed;
+  Morpheus::Matrix S1(S), S2(S);
+  S1(n-1, 3) = 2;
+  S2(70, 71) = 2;
+  testPassed = checkStats(S1, "nearly symmetric") && testPassed;
+  testPassed = checkStats(S2, "nearly symmetric") && testPassed;
+
+  // Upper and lower triangular, neither of them the identity
+  Morpheus::Matrix U(n, n), L(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      U(r,c) = (c >= r) ? r - c - 1.0 : 0;
+      L(c,r) = U(r,c);
+    }
+  }
+  testPassed = checkStats(U, "upper triangular") && testPassed;
+  testPassed = checkStats(L, "lower triangular") && testPassed;
+  if(!U.isUpperTriangular() || L.isUpperTriangular())
+  {
+    std::cout << "ERROR: isUpperTriangular is incorrect\n";
+    testPassed = false;
+  }
+
+  // Banded, with one entry far outside the band
+  Morpheus::Matrix B(n, n);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      B(r,c) = (c >= r-2 && c <= r+3) ? r + c + 1.0 : 0;
+  }
+  testPassed = checkStats(B, "banded") && testPassed;
+  B(130, 10) = -1;
+  testPassed = checkStats(B, "banded") && testPassed;
+
+  // Rectangular, both ways
+  Morpheus::Matrix W(37, n), T(n, 37);
+  for(int r=0; r<37; r++)
+  {
+    for(int c=0; c<n; c++)
+      T(c,r) = W(r,c) = std::cos(r - 2.0*c);
+  }
+  testPassed = checkStats(W, "wide") && testPassed;
+  testPassed = checkStats(T, "tall") && testPassed;
+
+  if(testPassed) {
+    std::cout << "Matrix statistics test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Matrix statistics test: FAILED!\n";
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+/*
+ * Morpheus_Matrix_strassenTest.cpp
+ *
+ * Compares the error of the Strassen-Winograd product against the
+ * error of the conventional product, both measured against a long
+ * double reference.  The error growth factor printed for each size
+ * shows how much accuracy Strassen-Winograd costs for that workload.
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+// Returns max |C(r,c) - ref(r,c)| / (n * max|A| * max|B|)
+double relativeError(Morpheus::Matrix& C, long double* ref, int n)
+{
+  double maxErr = 0;
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      double err = std::abs((double)(C(r,c) - ref[r*n+c]));
+      if(err > maxErr)
+        maxErr = err;
+    }
+  }
+  // Entries of A and B lie in [-1,1]
+  return maxErr / n;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int sizes[4] = { 64, 100, 128, 129 };
+
+  // Seed the random number generator
+  srand(time(NULL));
+
+  for(int s=0; s<4; s++)
+  {
+    int n = sizes[s];
+    Morpheus::Matrix A(n,n), B(n,n), Cclassic(n,n), Cstrassen(n,n);
+    for(int r=0; r<n; r++)
+    {
+      for(int c=0; c<n; c++)
+      {
+        A(r,c) = 2.0*rand()/RAND_MAX - 1;
+        B(r,c) = 2.0*rand()/RAND_MAX - 1;
+      }
+    }
+
+    // Reference product in extended precision
+    long double* ref = new long double[n*n];
+    for(int r=0; r<n; r++)
+    {
+      for(int c=0; c<n; c++)
+      {
+        long double sum = 0;
+        for(int k=0; k<n; k++)
+          sum += (long double)A(r,k) * B(k,c);
+        ref[r*n+c] = sum;
+      }
+    }
+
+    Morpheus::Matrix::setStrassenCrossover(0);
+    A.multiply(B, Cclassic);
+
+    Morpheus::Matrix::setStrassenCrossover(16);
+    A.multiply(B, Cstrassen);
+    Morpheus::Matrix::setStrassenCrossover(0);
+
+    double classicErr = relativeError(Cclassic, ref, n);
+    double strassenErr = relativeError(Cstrassen, ref, n);
+    delete[] ref;
+
+    std::cout << "n = " << n << ": classic error " << classicErr
+              << ", Strassen-Winograd error " << strassenErr
+              << ", growth " << strassenErr / (classicErr + 1e-300) << "\n";
+
+    // Both must be accurate to well within the normwise bound
+    if(classicErr > 1e-13 || strassenErr > 1e-12)
+    {
+      std::cout << "ERROR: The product is not accurate enough for n = "
+                << n << "\n";
+      testPassed = false;
+    }
+  }
+
+  if(testPassed) {
+    std::cout << "Strassen test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Strassen test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
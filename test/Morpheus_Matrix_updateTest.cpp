@@ -0,0 +1,172 @@
+/*
+ * Morpheus_Matrix_updateTest.cpp
+ *
+ * Checks the rank-k updates (ger, syr, syrk) against entry-by-entry
+ * loops, and the Cholesky factorization, its rank-1 update and
+ * downdate, and solve against refactoring from scratch.  The size is
+ * not a multiple of the block size, so every blocked path is used.
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+// Returns max |A - B| / max |B|
+double relativeDiff(const Morpheus::Matrix& A, const Morpheus::Matrix& B)
+{
+  double diff = 0, scale = 0;
+  for(int r=0; r<A.getNumRows(); r++)
+  {
+    for(int c=0; c<A.getNumCols(); c++)
+    {
+      diff = std::max(diff, std::abs(A(r,c) - B(r,c)));
+      scale = std::max(scale, std::abs(B(r,c)));
+    }
+  }
+  return diff / scale;
+}
+
+// Returns R^T * R
+Morpheus::Matrix gram(const Morpheus::Matrix& R)
+{
+  Morpheus::Matrix G(R.getNumCols(), R.getNumCols());
+  G.syrk(1, R, 0, true);
+  return G;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int n = 150, k = 37;
+
+  Morpheus::Matrix X(n, k), Xt(k, n), A(n, n);
+  Morpheus::Vector x(n), y(n);
+  for(int r=0; r<n; r++)
+  {
+    x[r] = std::sin(r + 0.5);
+    y[r] = std::cos(2.0*r);
+    for(int c=0; c<k; c++)
+      Xt(c,r) = X(r,c) = std::sin(r*k + c + 1.0);
+    for(int c=0; c<n; c++)
+      A(r,c) = 1.0 / (r + c + 1);
+  }
+  const Morpheus::Matrix& constA = A;
+
+  // ger and syr against explicit loops; A is shared, so it must not change
+  Morpheus::Matrix G(A), S(A), expectG(n, n), expectS(n, n);
+  G.ger(-0.5, x, y);
+  S.syr(2, x);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+    {
+      expectG(r,c) = constA(r,c) - 0.5*x[r]*y[c];
+      expectS(r,c) = constA(r,c) + 2*x[r]*x[c];
+    }
+  }
+  if(relativeDiff(G, expectG) > 1e-14 || relativeDiff(S, expectS) > 1e-14 ||
+     !S.isSymmetric() || constA(0,0) != 1)
+  {
+    std::cout << "ERROR: ger or syr is incorrect\n";
+    testPassed = false;
+  }
+
+  // syrk in both forms against multiply
+  Morpheus::Matrix C1(A), C2(A), XXt(n, n);
+  X.multiply(Xt, XXt);
+  C1.syrk(1.5, X, -1);
+  C2.syrk(1.5, Xt, -1, true);
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<n; c++)
+      expectG(r,c) = 1.5*XXt(r,c) - constA(r,c);
+  }
+  if(relativeDiff(C1, expectG) > 1e-13 || relativeDiff(C2, expectG) > 1e-13 ||
+     !C1.isSymmetric() || !C2.isSymmetric())
+  {
+    std::cout << "ERROR: syrk is incorrect\n";
+    testPassed = false;
+  }
+
+  // A symmetric positive definite matrix and its factor
+  Morpheus::Matrix P(n, n);
+  P.syrk(1, X, 0);
+  for(int i=0; i<n; i++)
+    P(i,i) += n;
+  Morpheus::Matrix R(P);
+  bool factored = R.factorCholesky();
+  const Morpheus::Matrix& constR = R;
+  for(int r=0; r<n; r++)
+  {
+    for(int c=0; c<r; c++)
+      factored = factored && (constR(r,c) == 0);
+  }
+  if(!factored || relativeDiff(gram(R), P) > 1e-13)
+  {
+    std::cout << "ERROR: The Cholesky factor is incorrect\n";
+    testPassed = false;
+  }
+
+  // Update, then compare with refactoring P + x x^T
+  Morpheus::Matrix R0(R), Pup(P);
+  Pup.syr(1, x);
+  Morpheus::Matrix Rup(Pup);
+  Rup.factorCholesky();
+  R.updateCholesky(x);
+  if(relativeDiff(R, Rup) > 1e-12 || relativeDiff(gram(R), Pup) > 1e-13)
+  {
+    std::cout << "ERROR: The Cholesky update is incorrect\n";
+    testPassed = false;
+  }
+
+  // Downdating the same vector gives back the original factor
+  if(!R.downdateCholesky(x) || relativeDiff(R, R0) > 1e-12)
+  {
+    std::cout << "ERROR: The Cholesky downdate is incorrect\n";
+    testPassed = false;
+  }
+
+  // A downdate that would lose definiteness changes nothing, and does
+  // not even copy the shared factor
+  Morpheus::Vector big(n);
+  big.setValue(0);
+  big[n/2] = std::sqrt(P(n/2,n/2)) * 1.01;
+  Morpheus::Matrix Rfail(R0);
+  if(Rfail.downdateCholesky(big) || Rfail.getUseCount() != 2 ||
+     relativeDiff(Rfail, R0) != 0)
+  {
+    std::cout << "ERROR: An indefinite downdate was not rejected\n";
+    testPassed = false;
+  }
+
+  // Solve P z = b
+  Morpheus::Vector z(n), b(n);
+  P.multiply(x, b);
+  R0.solveCholesky(b, z);
+  z.axpy(-1, x);
+  b = z;
+  R0.solveCholesky(b, b);
+  if(z.normInf() > 1e-12 || b.getUseCount() != 1)
+  {
+    std::cout << "ERROR: The Cholesky solve is incorrect\n";
+    testPassed = false;
+  }
+
+  // An indefinite matrix cannot be factored
+  Morpheus::Matrix N(A);
+  N(n-1,n-1) = -1;
+  if(N.factorCholesky())
+  {
+    std::cout << "ERROR: An indefinite matrix was factored\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Rank-k update test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Rank-k update test: FAILED!\n";
+  return EXIT_FAILURE;
+}
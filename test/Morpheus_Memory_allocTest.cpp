@@ -0,0 +1,98 @@
+/*
+ * Morpheus_Memory_allocTest.cpp
+ *
+ * Checks that every allocation policy gives usable memory and that
+ * the first-touch policies zero it, with ordinary and huge pages.
+ */
+
+#include "Morpheus_Matrix.h"
+#include <iostream>
+#include <stdlib.h>
+
+int main()
+{
+  bool testPassed = true;
+  int nrows = 37, ncols = 23;
+
+  Morpheus::AllocPolicy policies[3] = { Morpheus::ALLOC_UNTOUCHED,
+    Morpheus::ALLOC_FIRST_TOUCH, Morpheus::ALLOC_INTERLEAVED };
+
+  // Every mode falls back to smaller pages if it has to, so any of
+  // them must work on any machine
+  Morpheus::HugePageMode modes[4] = { Morpheus::HUGEPAGES_NONE,
+    Morpheus::HUGEPAGES_TRANSPARENT, Morpheus::HUGEPAGES_2MB,
+    Morpheus::HUGEPAGES_1GB };
+
+  for(int t=0; t<12; t++)
+  {
+    int h = t / 3, p = t % 3;
+
+    // Only the matrix is large enough for huge pages
+    Morpheus::setHugePageMode(modes[h], nrows*ncols*sizeof(double));
+    Morpheus::Vector vec(nrows, policies[p]);
+    Morpheus::Matrix mat(nrows, ncols, policies[p]);
+
+    if(Morpheus::getPageMode(&vec[0]) != Morpheus::HUGEPAGES_NONE ||
+       Morpheus::getPageMode(&mat(0,0)) > modes[h])
+    {
+      std::cout << "ERROR: Mode " << h << " gave the wrong pages\n";
+      testPassed = false;
+    }
+
+    // Touched memory must start out as zero
+    if(policies[p] != Morpheus::ALLOC_UNTOUCHED)
+    {
+      for(int r=0; r<nrows; r++)
+      {
+        if(vec[r] != 0)
+          testPassed = false;
+        for(int c=0; c<ncols; c++)
+        {
+          if(mat(r,c) != 0)
+            testPassed = false;
+        }
+      }
+      if(!testPassed)
+        std::cout << "ERROR: Policy " << p << " with page mode " << h
+                  << " did not zero the memory\n";
+    }
+
+    // Every entry must be writable and distinct
+    for(int r=0; r<nrows; r++)
+    {
+      for(int c=0; c<ncols; c++)
+        mat(r,c) = r*ncols + c;
+    }
+    for(int r=0; r<nrows; r++)
+    {
+      for(int c=0; c<ncols; c++)
+      {
+        if(mat(r,c) != r*ncols + c)
+        {
+          std::cout << "ERROR: Policy " << p << " with page mode " << h
+                    << " entries overlap\n";
+          testPassed = false;
+          r = nrows;
+          break;
+        }
+      }
+    }
+  }
+
+  Morpheus::setHugePageMode(Morpheus::HUGEPAGES_NONE);
+
+  if(Morpheus::getNumThreads() < 1 || Morpheus::getNumNumaNodes() < 1)
+  {
+    std::cout << "ERROR: Thread and node counts must be positive\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Allocation test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Allocation test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,129 @@
+/*
+ * Morpheus_OutOfCoreMatrix_multiplyTest.cpp
+ *
+ * Stores a random matrix on disk in tiles that do not divide its
+ * dimensions, with a memory budget of only two tiles, and checks the
+ * out-of-core products against the in-core ones, and that the file
+ * can only be reopened with the same dimensions and tile size.
+ */
+
+#include "Morpheus_OutOfCoreMatrix.h"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <time.h>
+
+int main()
+{
+  bool testPassed = true;
+  int nrows = 53, ncols = 37, k = 5, tileSize = 8;
+  const char* filename = "Morpheus_OutOfCoreMatrix_multiplyTest.bin";
+
+  // Seed the random number generator
+  srand(time(NULL));
+
+  // Create a random matrix, vector and block of vectors
+  Morpheus::Matrix A(nrows, ncols), X(ncols, k);
+  Morpheus::Vector x(ncols);
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      A(r,c) = (double)rand() / RAND_MAX;
+  }
+  for(int r=0; r<ncols; r++)
+  {
+    x[r] = (double)rand() / RAND_MAX;
+    for(int c=0; c<k; c++)
+      X(r,c) = (double)rand() / RAND_MAX;
+  }
+
+  // In-core products
+  Morpheus::Vector y(nrows);
+  Morpheus::Matrix Y(nrows, k);
+  A.multiply(x, y);
+  A.multiply(X, Y);
+
+  {
+    Morpheus::OutOfCoreMatrix diskA(filename, nrows, ncols, tileSize,
+                                    2*tileSize*tileSize*sizeof(double));
+    diskA.writeMatrix(A);
+
+    if(diskA.getNumTileRows() != 7 || diskA.getNumTileCols() != 5 ||
+       diskA.getNumBuffers() != 2)
+    {
+      std::cout << "ERROR: The tiling is incorrect\n";
+      testPassed = false;
+    }
+
+    // Out-of-core products
+    Morpheus::Vector yDisk(nrows);
+    Morpheus::Matrix YDisk(nrows, k);
+    diskA.multiply(x, yDisk);
+    diskA.multiply(X, YDisk);
+
+    for(int r=0; r<nrows; r++)
+    {
+      if(std::abs(y[r] - yDisk[r]) > 1e-10)
+      {
+        std::cout << "ERROR: The matrix-vector product is incorrect\n";
+        testPassed = false;
+        break;
+      }
+    }
+    if(!Y.approxEqual(YDisk, 1e-10))
+    {
+      std::cout << "ERROR: The matrix-matrix product is incorrect\n";
+      testPassed = false;
+    }
+
+    // Tiles must round trip
+    Morpheus::Matrix tile(tileSize, tileSize);
+    diskA.readTile(6, 4, tile);
+    if(tile(0,0) != A(48,32) || tile(4,4) != A(52,36))
+    {
+      std::cout << "ERROR: The tile was not read back correctly\n";
+      testPassed = false;
+    }
+  }
+
+  // The file can be reopened with the same layout, but not another
+  {
+    Morpheus::OutOfCoreMatrix diskA(filename, nrows, ncols, tileSize,
+                                    2*tileSize*tileSize*sizeof(double));
+    Morpheus::Matrix tile(tileSize, tileSize);
+    diskA.readTile(1, 2, tile);
+    if(tile(3,5) != A(11,21))
+    {
+      std::cout << "ERROR: The reopened matrix is incorrect\n";
+      testPassed = false;
+    }
+  }
+  const int layouts[3][3] = {{nrows, ncols, tileSize+1},
+                             {ncols, nrows, tileSize},
+                             {nrows, ncols+1, tileSize}};
+  for(int i=0; i<3; i++)
+  {
+    try
+    {
+      Morpheus::OutOfCoreMatrix diskA(filename, layouts[i][0],
+                                      layouts[i][1], layouts[i][2], 0);
+      std::cout << "ERROR: A file with another layout was reused\n";
+      testPassed = false;
+    }
+    catch(const std::runtime_error&)
+    {
+    }
+  }
+
+  std::remove(filename);
+
+  if(testPassed) {
+    std::cout << "Out-of-core multiply test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "Out-of-core multiply test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,156 @@
+/*
+ * Morpheus_RandomizedSvd_Tests.cpp
+ *
+ * Builds a matrix with known singular vectors and rapidly decaying
+ * singular values above a flat noise floor, and checks the in-core and
+ * single-pass out-of-core randomized SVDs: the singular values, the
+ * orthonormality of the factors, and the error estimate against the
+ * true error.
+ */
+
+#include "Morpheus_RandomizedSvd.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdlib.h>
+
+// Returns ||A - U*S*V^T|| in the Frobenius norm
+double approximationError(const Morpheus::Matrix& A,
+                          const Morpheus::RandomizedSvd& svd)
+{
+  const Morpheus::Matrix& U = svd.getU();
+  const Morpheus::Matrix& Vt = svd.getVt();
+  double sum = 0;
+  for(int r=0; r<A.getNumRows(); r++)
+  {
+    for(int c=0; c<A.getNumCols(); c++)
+    {
+      double approx = 0;
+      for(int i=0; i<svd.getRank(); i++)
+        approx += U(r,i)*svd.getSingularValue(i)*Vt(i,c);
+      sum += (A(r,c) - approx)*(A(r,c) - approx);
+    }
+  }
+  return std::sqrt(sum);
+}
+
+// Returns max |Q^T*Q - I|, using the rows of Q if rows is true
+double orthogonalityError(const Morpheus::Matrix& Q, bool rows)
+{
+  int n = rows ? Q.getNumRows() : Q.getNumCols();
+  int len = rows ? Q.getNumCols() : Q.getNumRows();
+  double worst = 0;
+  for(int i=0; i<n; i++)
+  {
+    for(int j=0; j<n; j++)
+    {
+      double sum = 0;
+      for(int k=0; k<len; k++)
+        sum += rows ? Q(i,k)*Q(j,k) : Q(k,i)*Q(k,j);
+      worst = std::max(worst, std::abs(sum - (i == j ? 1 : 0)));
+    }
+  }
+  return worst;
+}
+
+// Checks the singular values to valueTol*sigma[0], and the error
+// estimate to errorTol relative to the true error
+bool check(const char* name, const Morpheus::Matrix& A,
+           const Morpheus::RandomizedSvd& svd, const double* sigma,
+           const double valueTol, const double errorTol)
+{
+  bool passed = true;
+  for(int i=0; i<svd.getRank(); i++)
+  {
+    if(std::abs(svd.getSingularValue(i) - sigma[i]) > valueTol*sigma[0])
+    {
+      std::cout << "ERROR: " << name << " singular value " << i << " is "
+                << svd.getSingularValue(i) << " instead of " << sigma[i]
+                << "\n";
+      passed = false;
+    }
+  }
+
+  if(orthogonalityError(svd.getU(), false) > 1e-12 ||
+     orthogonalityError(svd.getVt(), true) > 1e-12)
+  {
+    std::cout << "ERROR: The " << name << " singular vectors are not "
+              << "orthonormal\n";
+    passed = false;
+  }
+
+  double error = approximationError(A, svd);
+  double estimate = svd.getErrorEstimate();
+  std::cout << name << ": error " << error << ", estimate " << estimate
+            << ", " << svd.getNumPasses() << " passes\n";
+  if(std::abs(estimate - error) > errorTol*error)
+  {
+    std::cout << "ERROR: The " << name << " error estimate is wrong\n";
+    passed = false;
+  }
+  return passed;
+}
+
+int main()
+{
+  bool testPassed = true;
+  const double pi = 3.14159265358979323846;
+  int nrows = 150, ncols = 110, rank = 8;
+  const char* filename = "Morpheus_RandomizedSvd_Tests.bin";
+
+  // A = sum_i sigma_i u_i v_i^T, with sine vectors, which are orthonormal
+  double sigma[110];
+  for(int i=0; i<ncols; i++)
+    sigma[i] = (i < 12) ? std::pow(0.5, i) : 1e-4;
+  Morpheus::Matrix A(nrows, ncols);
+  for(int i=0; i<ncols; i++)
+  {
+    for(int r=0; r<nrows; r++)
+    {
+      double u = std::sqrt(2.0/(nrows+1)) * std::sin((i+1)*(r+1)*pi/(nrows+1));
+      for(int c=0; c<ncols; c++)
+      {
+        double v = std::sqrt(2.0/(ncols+1)) * std::sin((i+1)*(c+1)*pi/(ncols+1));
+        A(r,c) += sigma[i]*u*v;
+      }
+    }
+  }
+
+  // In-core, with power iterations
+  Morpheus::RandomizedSvd svd(rank);
+  svd.compute(A);
+  testPassed = check("in-core", A, svd, sigma, 1e-10, 1e-3) && testPassed;
+  if(svd.getNumPasses() != 6)
+  {
+    std::cout << "ERROR: The in-core SVD used " << svd.getNumPasses()
+              << " passes\n";
+    testPassed = false;
+  }
+
+  // Out-of-core, in a single pass over tiles that do not divide the matrix
+  {
+    Morpheus::OutOfCoreMatrix diskA(filename, nrows, ncols, 16,
+                                    4*16*16*sizeof(double));
+    diskA.writeMatrix(A);
+
+    Morpheus::RandomizedSvd streaming(rank);
+    streaming.compute(diskA);
+    testPassed = check("single-pass", A, streaming, sigma, 1e-3, 0.5) &&
+                 testPassed;
+    if(streaming.getNumPasses() != 1)
+    {
+      std::cout << "ERROR: The single-pass SVD used "
+                << streaming.getNumPasses() << " passes\n";
+      testPassed = false;
+    }
+  }
+  remove(filename);
+
+  if(testPassed) {
+    std::cout << "RandomizedSvd test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "RandomizedSvd test: FAILED!\n";
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/*
+ * Morpheus_Reordering_Tests.cpp
+ *
+ * Scrambles the numbering of a 2D grid Laplacian, then checks that
+ * both orderings return valid permutations that shrink the bandwidth
+ * and profile, and that the reordered matrix-vector product matches
+ * the original once the vectors are permuted too.
+ */
+
+#include "Morpheus_Reordering.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Returns true if perm holds each of 0, ..., n-1 exactly once
+bool isPermutation(const std::vector<int>& perm, int n)
+{
+  if((int)perm.size() != n)
+    return false;
+  std::vector<bool> seen(n, false);
+  for(int i=0; i<n; i++)
+  {
+    if(perm[i] < 0 || perm[i] >= n || seen[perm[i]])
+      return false;
+    seen[perm[i]] = true;
+  }
+  return true;
+}
+
+int main()
+{
+  bool testPassed = true;
+
+  // 5-point Laplacian on an nx x nx grid, plus a few isolated vertices
+  // so the graph has more than one component
+  int nx = 40, nisolated = 3;
+  int n = nx*nx + nisolated;
+  std::vector<int> scramble(n);
+  for(int i=0; i<n; i++)
+    scramble[i] = i;
+  srand(3);
+  for(int i=n-1; i>0; i--)
+    std::swap(scramble[i], scramble[rand() % (i+1)]);
+
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  for(int i=0; i<nx; i++)
+  {
+    for(int j=0; j<nx; j++)
+    {
+      int v = scramble[i*nx+j];
+      rows.push_back(v); cols.push_back(v); vals.push_back(4);
+      if(i > 0)    { rows.push_back(v); cols.push_back(scramble[(i-1)*nx+j]); vals.push_back(-1); }
+      if(i < nx-1) { rows.push_back(v); cols.push_back(scramble[(i+1)*nx+j]); vals.push_back(-1); }
+      if(j > 0)    { rows.push_back(v); cols.push_back(scramble[i*nx+j-1]); vals.push_back(-1); }
+      if(j < nx-1) { rows.push_back(v); cols.push_back(scramble[i*nx+j+1]); vals.push_back(-1); }
+    }
+  }
+  for(int k=0; k<nisolated; k++)
+  {
+    int v = scramble[nx*nx+k];
+    rows.push_back(v); cols.push_back(v); vals.push_back(1);
+  }
+  Morpheus::CsrMatrix original(n, n, (int)vals.size(),
+                               &rows[0], &cols[0], &vals[0]);
+
+  Morpheus::Vector x(n), y(n);
+  for(int i=0; i<n; i++)
+    x[i] = std::sin((double)i);
+  original.multiply(x, y);
+
+  Morpheus::OrderingMethod methods[] = { Morpheus::ORDER_RCM,
+                                         Morpheus::ORDER_NESTED_DISSECTION };
+  const char* names[] = { "RCM", "nested dissection" };
+  for(int m=0; m<2; m++)
+  {
+    Morpheus::CsrMatrix A = original;
+    std::vector<int> perm;
+    Morpheus::OrderingReport report = Morpheus::reorder(A, methods[m], perm);
+    std::cout << names[m] << ": bandwidth " << report.bandwidthBefore
+              << " -> " << report.bandwidthAfter << ", profile "
+              << report.profileBefore << " -> " << report.profileAfter << "\n";
+
+    if(!isPermutation(perm, n))
+    {
+      std::cout << "ERROR: " << names[m] << " is not a permutation\n";
+      testPassed = false;
+      continue;
+    }
+
+    if(report.profileAfter >= report.profileBefore / 4 ||
+       report.bandwidthBefore != original.getBandwidth() ||
+       report.bandwidthAfter != A.getBandwidth())
+    {
+      std::cout << "ERROR: " << names[m] << " did not shrink the profile\n";
+      testPassed = false;
+    }
+
+    // RCM on a grid should find a bandwidth close to nx
+    if(m == 0 && report.bandwidthAfter > 2*nx)
+    {
+      std::cout << "ERROR: The RCM bandwidth is too large\n";
+      testPassed = false;
+    }
+
+    // Permute x, multiply, and permute the result back
+    Morpheus::Vector xp(n), yp(n);
+    for(int i=0; i<n; i++)
+      xp[i] = x[i];
+    xp.permute(&perm[0]);
+    A.multiply(xp, yp);
+    yp.permute(&perm[0], true);
+    for(int i=0; i<n; i++)
+    {
+      if(std::abs(yp[i] - y[i]) > 1e-14)
+      {
+        std::cout << "ERROR: The " << names[m] << " product is incorrect\n";
+        testPassed = false;
+        break;
+      }
+    }
+  }
+
+  if(testPassed) {
+    std::cout << "Reordering test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Reordering test: FAILED!\n";
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,211 @@
+/*
+ * Morpheus_SellMatrix_Tests.cpp
+ *
+ * Builds an irregular sparse matrix from coordinate lists and checks
+ * that the CSR and SELL-C-sigma products agree with a dense product,
+ * and that the format selector picks SELL only for short rows.
+ */
+
+#include "Morpheus_SellMatrix.h"
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Largest difference between two vectors
+double maxDiff(const Morpheus::Vector& a, const Morpheus::Vector& b)
+{
+  double diff = 0;
+  for(int i=0; i<a.getNumElements(); i++)
+  {
+    if(std::abs(a[i] - b[i]) > diff)
+      diff = std::abs(a[i] - b[i]);
+  }
+  return diff;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int nrows = 101, ncols = 67;
+
+  // Rows of very different lengths, some empty, given in no particular
+  // order and with a few duplicate entries
+  srand(7);
+  std::vector<int> rowInd, colInd;
+  std::vector<double> vals;
+  Morpheus::Matrix dense(nrows, ncols);
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      dense(r,c) = 0;
+  }
+  for(int r=nrows-1; r>=0; r--)
+  {
+    int len = (r % 7 == 0) ? 0 : rand() % ((r % 5 == 0) ? ncols : 6);
+    for(int k=0; k<len; k++)
+    {
+      int c = rand() % ncols;
+      double v = (double)rand() / RAND_MAX - 0.5;
+      rowInd.push_back(r);
+      colInd.push_back(c);
+      vals.push_back(v);
+      dense(r,c) += v;
+    }
+  }
+  Morpheus::CsrMatrix A(nrows, ncols, (int)vals.size(),
+                        &rowInd[0], &colInd[0], &vals[0]);
+
+  // The rows must be sorted, with duplicates summed
+  const int* rowPtr = A.getRowPtr();
+  for(int r=0; r<nrows; r++)
+  {
+    for(int k=rowPtr[r]+1; k<rowPtr[r+1]; k++)
+    {
+      if(A.getColIndices()[k] <= A.getColIndices()[k-1])
+      {
+        std::cout << "ERROR: CSR row " << r << " is not sorted\n";
+        testPassed = false;
+      }
+    }
+  }
+
+  Morpheus::Vector x(ncols), y(nrows), yDense(nrows);
+  for(int i=0; i<ncols; i++)
+    x[i] = 1.0 / (i+1);
+  dense.multiply(x, yDense);
+
+  A.multiply(x, y);
+  if(maxDiff(y, yDense) > 1e-13)
+  {
+    std::cout << "ERROR: The CSR product is incorrect\n";
+    testPassed = false;
+  }
+
+  // The transposed product
+  Morpheus::Vector xt(nrows), yt(ncols), ytDense(ncols);
+  for(int i=0; i<nrows; i++)
+    xt[i] = i % 3 - 1;
+  for(int c=0; c<ncols; c++)
+  {
+    ytDense[c] = 0;
+    for(int r=0; r<nrows; r++)
+      ytDense[c] += dense(r,c)*xt[r];
+  }
+  A.gemv(1, xt, 0, yt, true);
+  if(maxDiff(yt, ytDense) > 1e-13)
+  {
+    std::cout << "ERROR: The transposed CSR product is incorrect\n";
+    testPassed = false;
+  }
+
+  // Every chunk height, with and without sorting, including a height
+  // that does not divide the number of rows
+  int heights[] = { 0, 2, 3, 4, 8 };
+  for(int h=0; h<5; h++)
+  {
+    for(int sorted=0; sorted<2; sorted++)
+    {
+      int C = heights[h] ? heights[h] : Morpheus::SellMatrix::getDefaultChunkHeight();
+      Morpheus::SellMatrix S(A, heights[h], sorted ? 4*C : 1);
+
+      S.multiply(x, y);
+      if(maxDiff(y, yDense) > 1e-13)
+      {
+        std::cout << "ERROR: The SELL-" << C << "-" << S.getSigma()
+                  << " product is incorrect\n";
+        testPassed = false;
+      }
+
+      // y = 2*A*x - y must leave A*x behind
+      S.gemv(2, x, -1, y);
+      if(maxDiff(y, yDense) > 1e-13)
+      {
+        std::cout << "ERROR: The SELL-" << C << "-" << S.getSigma()
+                  << " gemv is incorrect\n";
+        testPassed = false;
+      }
+
+      if(S.getNumEntries() != A.getNumEntries())
+      {
+        std::cout << "ERROR: SELL lost nonzeros\n";
+        testPassed = false;
+      }
+    }
+  }
+
+  // Sorting must reduce the padding
+  Morpheus::SellMatrix unsorted(A, 4, 1), sorted(A, 4, 32);
+  if(sorted.getFillEfficiency() <= unsorted.getFillEfficiency())
+  {
+    std::cout << "ERROR: Sorting did not reduce the padding\n";
+    testPassed = false;
+  }
+
+  // Short rows favour SELL
+  int n = 1000;
+  std::vector<int> shortRows, shortCols;
+  std::vector<double> shortVals;
+  for(int r=0; r<n; r++)
+  {
+    for(int k=0; k<=r%3; k++)
+    {
+      shortRows.push_back(r);
+      shortCols.push_back((r+k*17) % n);
+      shortVals.push_back(1);
+    }
+  }
+  Morpheus::CsrMatrix shortA(n, n, (int)shortVals.size(),
+                             &shortRows[0], &shortCols[0], &shortVals[0]);
+  Morpheus::SparseMatrix autoShort(shortA);
+  if(autoShort.getFormat() != Morpheus::SPARSE_SELL ||
+     autoShort.getAnalysis().predictedSpeedup <= 1)
+  {
+    std::cout << "ERROR: SELL was not chosen for short rows\n";
+    testPassed = false;
+  }
+
+  // Long, irregular rows favour CSR
+  std::vector<int> longRows, longCols;
+  std::vector<double> longVals;
+  for(int r=0; r<n; r++)
+  {
+    int len = (r % 2 == 0) ? 300 : 30;
+    for(int k=0; k<len; k++)
+    {
+      longRows.push_back(r);
+      longCols.push_back((r+k*3) % n);
+      longVals.push_back(1);
+    }
+  }
+  Morpheus::CsrMatrix longA(n, n, (int)longVals.size(),
+                            &longRows[0], &longCols[0], &longVals[0]);
+  Morpheus::SparseFormatAnalysis longAnalysis =
+      Morpheus::analyzeSparseFormat(longA, 4, 1);
+  if(longAnalysis.format != Morpheus::SPARSE_CSR ||
+     longAnalysis.maxRowLength != 300 || longAnalysis.meanRowLength != 165)
+  {
+    std::cout << "ERROR: CSR was not chosen for long irregular rows\n";
+    testPassed = false;
+  }
+
+  // Either way, the product must be right
+  Morpheus::Vector ones(n), yAuto(n), yCsr(n);
+  ones.setValue(1);
+  autoShort.multiply(ones, yAuto);
+  shortA.multiply(ones, yCsr);
+  if(maxDiff(yAuto, yCsr) != 0)
+  {
+    std::cout << "ERROR: The automatically stored product is incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "SELL matrix test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "SELL matrix test: FAILED!\n";
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,139 @@
+/*
+ * Morpheus_Spgemm_Tests.cpp
+ *
+ * Checks sparse matrix-matrix products against dense ones, with both
+ * accumulators, and checks that a plan can be reused after the values
+ * of its factors change.
+ */
+
+#include "Morpheus_Spgemm.h"
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Builds a random sparse matrix and its dense copy
+Morpheus::CsrMatrix randomSparse(int nrows, int ncols, int maxPerRow,
+                                 Morpheus::Matrix& dense)
+{
+  std::vector<int> rows, cols;
+  std::vector<double> vals;
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      dense(r,c) = 0;
+    int len = rand() % (maxPerRow+1);
+    for(int k=0; k<len; k++)
+    {
+      int c = rand() % ncols;
+      double v = (double)rand() / RAND_MAX - 0.5;
+      rows.push_back(r);
+      cols.push_back(c);
+      vals.push_back(v);
+      dense(r,c) += v;
+    }
+  }
+  return Morpheus::CsrMatrix(nrows, ncols, (int)vals.size(),
+                             rows.empty() ? NULL : &rows[0],
+                             cols.empty() ? NULL : &cols[0],
+                             vals.empty() ? NULL : &vals[0]);
+}
+
+// Returns the largest difference between a sparse and a dense matrix,
+// or a large number if the sparse one is missing a nonzero
+double maxDiff(const Morpheus::CsrMatrix& A, const Morpheus::Matrix& dense)
+{
+  Morpheus::Matrix copy(A.getNumRows(), A.getNumCols());
+  for(int r=0; r<A.getNumRows(); r++)
+  {
+    for(int c=0; c<A.getNumCols(); c++)
+      copy(r,c) = 0;
+    for(int k=A.getRowPtr()[r]; k<A.getRowPtr()[r+1]; k++)
+      copy(r,A.getColIndices()[k]) = A.getValues()[k];
+  }
+
+  double diff = 0;
+  for(int r=0; r<A.getNumRows(); r++)
+  {
+    for(int c=0; c<A.getNumCols(); c++)
+    {
+      if(std::abs(copy(r,c) - dense(r,c)) > diff)
+        diff = std::abs(copy(r,c) - dense(r,c));
+    }
+  }
+  return diff;
+}
+
+int main()
+{
+  bool testPassed = true;
+  int m = 53, k = 41, n = 37;
+
+  srand(11);
+  Morpheus::Matrix denseA(m,k), denseB(k,n), denseC(m,n);
+  Morpheus::CsrMatrix A = randomSparse(m, k, 6, denseA);
+  Morpheus::CsrMatrix B = randomSparse(k, n, 4, denseB);
+  denseA.multiply(denseB, denseC);
+
+  // Both accumulators must give the same answer
+  Morpheus::SpgemmAccumulator kinds[] = { Morpheus::SPGEMM_DENSE,
+                                          Morpheus::SPGEMM_HASH };
+  for(int i=0; i<2; i++)
+  {
+    Morpheus::SpgemmPlan plan(A, B, kinds[i]);
+    Morpheus::CsrMatrix C = plan.createProduct();
+    plan.numeric(A, B, C);
+    if(plan.getAccumulator() != kinds[i] || maxDiff(C, denseC) > 1e-14)
+    {
+      std::cout << "ERROR: The product with accumulator " << kinds[i]
+                << " is incorrect\n";
+      testPassed = false;
+    }
+
+    // Reuse the plan after changing the values but not the pattern
+    Morpheus::CsrMatrix A2 = A;
+    Morpheus::Matrix denseA2(m,k), denseC2(m,n);
+    double* vals = A2.getValues();
+    for(int j=0; j<A2.getNumEntries(); j++)
+      vals[j] = vals[j]*(j % 3) + 1;
+    for(int r=0; r<m; r++)
+    {
+      for(int c=0; c<k; c++)
+        denseA2(r,c) = 0;
+      for(int j=A2.getRowPtr()[r]; j<A2.getRowPtr()[r+1]; j++)
+        denseA2(r,A2.getColIndices()[j]) = vals[j];
+    }
+    denseA2.multiply(denseB, denseC2);
+    plan.numeric(A2, B, C);
+    if(maxDiff(C, denseC2) > 1e-14)
+    {
+      std::cout << "ERROR: Reusing the plan with accumulator " << kinds[i]
+                << " gave the wrong product\n";
+      testPassed = false;
+    }
+  }
+
+  // A Galerkin product R*A*P with square A
+  Morpheus::Matrix denseR(n,m), denseSq(m,m), denseP(m,n);
+  Morpheus::CsrMatrix R = randomSparse(n, m, 5, denseR);
+  Morpheus::CsrMatrix Sq = randomSparse(m, m, 5, denseSq);
+  Morpheus::CsrMatrix P = randomSparse(m, n, 2, denseP);
+  Morpheus::CsrMatrix RAP = Morpheus::multiply(R, Morpheus::multiply(Sq, P));
+  Morpheus::Matrix denseAP(m,n), denseRAP(n,n);
+  denseSq.multiply(denseP, denseAP);
+  denseR.multiply(denseAP, denseRAP);
+  if(maxDiff(RAP, denseRAP) > 1e-13)
+  {
+    std::cout << "ERROR: The Galerkin product is incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "SpGEMM test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "SpGEMM test: FAILED!\n";
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,148 @@
+/*
+ * Morpheus_Vector_blasTest.cpp
+ *
+ * Checks the BLAS-style gemv, axpy, axpby, waxpby and fused
+ * dot/norm functions against the separate scale/add/dot calls.
+ */
+
+#include "Morpheus_Matrix.h"
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <time.h>
+
+// Returns true if | a-b | < tol, false otherwise
+bool approxEqual(double a, double b, double tol);
+
+int main()
+{
+  bool testPassed = true;
+  int nrows = 7, ncols = 4;
+  double alpha = 2.5, beta = -0.5;
+
+  // Seed the random number generator
+  srand(time(NULL));
+
+  Morpheus::Matrix A(nrows, ncols);
+  Morpheus::Vector x(ncols), xt(nrows), y(nrows), yt(ncols);
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+      A(r,c) = (double)rand() / RAND_MAX;
+    xt[r] = (double)rand() / RAND_MAX;
+    y[r] = (double)rand() / RAND_MAX;
+  }
+  for(int c=0; c<ncols; c++)
+  {
+    x[c] = (double)rand() / RAND_MAX;
+    yt[c] = (double)rand() / RAND_MAX;
+  }
+
+  // y = alpha*A*x + beta*y
+  Morpheus::Vector yOld(nrows);
+  yOld.setValue(0);
+  y.add(yOld, yOld);
+  A.gemv(alpha, x, beta, y);
+  for(int r=0; r<nrows; r++)
+  {
+    double expected = beta*yOld[r];
+    for(int c=0; c<ncols; c++)
+      expected += alpha*A(r,c)*x[c];
+    if(!approxEqual(y[r], expected, 1e-12))
+    {
+      std::cout << "ERROR: gemv is incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // yt = alpha*A^T*xt + beta*yt
+  Morpheus::Vector ytOld(ncols);
+  ytOld.setValue(0);
+  yt.add(ytOld, ytOld);
+  A.gemv(alpha, xt, beta, yt, true);
+  for(int c=0; c<ncols; c++)
+  {
+    double expected = beta*ytOld[c];
+    for(int r=0; r<nrows; r++)
+      expected += alpha*A(r,c)*xt[r];
+    if(!approxEqual(yt[c], expected, 1e-12))
+    {
+      std::cout << "ERROR: transposed gemv is incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // multiply must agree with gemv(1, x, 0, y)
+  Morpheus::Vector z(nrows);
+  A.multiply(x, z);
+  A.gemv(1, x, 0, y);
+  for(int r=0; r<nrows; r++)
+  {
+    if(!approxEqual(y[r], z[r], 1e-12))
+    {
+      std::cout << "ERROR: multiply and gemv disagree\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // w = alpha*x + beta*y, then w = alpha*x + beta*w, then w += alpha*x
+  Morpheus::Vector w(nrows);
+  w.waxpby(alpha, xt, beta, y);
+  w.axpby(alpha, xt, beta);
+  w.axpy(alpha, xt);
+  for(int r=0; r<nrows; r++)
+  {
+    double expected = alpha*xt[r] + beta*(alpha*xt[r] + beta*y[r]) + alpha*xt[r];
+    if(!approxEqual(w[r], expected, 1e-12))
+    {
+      std::cout << "ERROR: axpy/axpby/waxpby are incorrect\n";
+      testPassed = false;
+      break;
+    }
+  }
+
+  // Fused dot and norm
+  double dot, norm2;
+  w.dotNorm2(y, dot, norm2);
+  if(!approxEqual(dot, w.dot(y), 1e-12) || !approxEqual(norm2, w.norm2(), 1e-12) ||
+     !approxEqual(norm2*norm2, w.dot(w), 1e-12))
+  {
+    std::cout << "ERROR: dotNorm2 is incorrect\n";
+    testPassed = false;
+  }
+
+  // Fused axpy and dot, with and without aliasing
+  double wy = w.axpyDot(-1, xt, y);
+  if(!approxEqual(wy, w.dot(y), 1e-12))
+  {
+    std::cout << "ERROR: axpyDot is incorrect\n";
+    testPassed = false;
+  }
+  double ww = w.axpyDot(1, xt, w);
+  if(!approxEqual(ww, w.dot(w), 1e-12))
+  {
+    std::cout << "ERROR: axpyDot with aliasing is incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "BLAS test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+  else {
+    std::cout << "BLAS test: FAILED!\n";
+    return EXIT_FAILURE;
+  }
+}
+
+
+// Returns true if | a-b | < tol, false otherwise
+bool approxEqual(double a, double b, double tol)
+{
+  if(std::abs(a-b) < tol)
+    return true;
+  return false;
+}
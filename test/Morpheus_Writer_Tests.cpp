@@ -0,0 +1,168 @@
+/*
+ * Morpheus_Writer_Tests.cpp
+ *
+ * Checks that print() gives exactly what std::cout used to, that the
+ * shortest representation reads back as the same doubles, that the
+ * output does not depend on the block size or the number of threads,
+ * and that the binary format holds the raw entries.
+ */
+
+#include "Morpheus_Writer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+// Returns what f printed to std::cout
+template<class F>
+std::string capture(F f)
+{
+  std::ostringstream out;
+  std::streambuf* old = std::cout.rdbuf(out.rdbuf());
+  f();
+  std::cout.rdbuf(old);
+  return out.str();
+}
+
+int main()
+{
+  bool testPassed = true;
+  int nrows = 23, ncols = 7;
+
+  // Entries of many magnitudes, including the awkward ones
+  Morpheus::Matrix A(nrows, ncols);
+  Morpheus::Vector v(nrows);
+  const double special[] = {0.1, -0.0, 1e-300, 1e20, -123456789.0, 1.0/3,
+                            std::numeric_limits<double>::infinity(),
+                            std::numeric_limits<double>::denorm_min()};
+  for(int r=0; r<nrows; r++)
+  {
+    v[r] = std::exp(0.7*r) - 3;
+    for(int c=0; c<ncols; c++)
+      A(r,c) = std::sin(r*ncols + c + 1.0) * std::pow(10.0, r - 10);
+  }
+  for(int i=0; i<8; i++)
+  {
+    A(i, i % ncols) = special[i];
+    v[nrows-1-i] = special[i];
+  }
+  const Morpheus::Matrix& constA = A;
+  const Morpheus::Vector& constV = v;
+
+  // print() matches streaming each entry to std::cout, at the default
+  // precision and at another one
+  for(int precision=6; precision<=10; precision += 4)
+  {
+    std::streamsize oldPrecision = std::cout.precision(precision);
+    std::string expectA = capture([&]() {
+      std::cout << nrows << "x" << ncols << " Matrix\n";
+      for(int r=0; r<nrows; r++)
+      {
+        for(int c=0; c<ncols; c++)
+          std::cout << constA(r,c) << " ";
+        std::cout << std::endl;
+      }
+    });
+    std::string expectV = capture([&]() {
+      std::cout << "Vector with " << nrows << " entries\n";
+      for(int i=0; i<nrows; i++)
+        std::cout << "data[" << i << "] = " << constV[i] << std::endl;
+    });
+    std::string gotA = capture([&]() { A.print(); });
+    std::string gotV = capture([&]() { v.print(); });
+    std::cout.precision(oldPrecision);
+    if(gotA != expectA || gotV != expectV)
+    {
+      std::cout << "ERROR: print() does not match std::cout at precision "
+                << precision << std::endl;
+      testPassed = false;
+    }
+  }
+
+  // The shortest representation reads back exactly
+  std::ostringstream shortest;
+  Morpheus::Writer writer(shortest);
+  writer.write(A);
+  std::istringstream in(shortest.str());
+  std::string token;
+  in >> token >> token;
+  bool roundTrip = (token == "Matrix");
+  for(int r=0; r<nrows; r++)
+  {
+    for(int c=0; c<ncols; c++)
+    {
+      in >> token;
+      double x = std::strtod(token.c_str(), NULL);
+      roundTrip = roundTrip && x == constA(r,c) &&
+                  std::signbit(x) == std::signbit(constA(r,c));
+    }
+  }
+  if(!roundTrip || !(in >> token).fail())
+  {
+    std::cout << "ERROR: The shortest representation does not round-trip\n";
+    testPassed = false;
+  }
+
+  // Tiny blocks, with and without threads, give the same text
+  for(int parallel=0; parallel<2; parallel++)
+  {
+    std::ostringstream outA, outV;
+    Morpheus::Writer blockedA(outA), blockedV(outV);
+    blockedA.setBufferSize(64);
+    blockedA.setParallel(parallel);
+    blockedA.write(A);
+    blockedV.setBufferSize(64);
+    blockedV.setParallel(parallel);
+    blockedV.setPrecision(6);
+    blockedV.write(v);
+    if(outA.str() != shortest.str() ||
+       outV.str() != capture([&]() { v.print(); }))
+    {
+      std::cout << "ERROR: The output depends on the block size\n";
+      testPassed = false;
+    }
+  }
+
+  // The binary format through a file descriptor
+  char filename[] = "Morpheus_Writer_TestsXXXXXX";
+  int fd = mkstemp(filename);
+  Morpheus::Writer binary(fd, Morpheus::WRITE_BINARY);
+  binary.write(A);
+  binary.write(v);
+  std::size_t expectBytes = 2*16 + (nrows*ncols + nrows)*sizeof(double);
+  std::string bytes(expectBytes + 1, '\0');
+  ssize_t nread = pread(fd, &bytes[0], bytes.size(), 0);
+  close(fd);
+  unlink(filename);
+  int dims[2];
+  std::memcpy(dims, bytes.data() + 8, sizeof(dims));
+  bool binaryOk = nread == (ssize_t)expectBytes &&
+                  bytes.compare(0, 8, "MORPHEUS") == 0 &&
+                  dims[0] == nrows && dims[1] == ncols &&
+                  std::memcmp(bytes.data() + 16, &constA(0,0),
+                              nrows*ncols*sizeof(double)) == 0;
+  std::size_t vectorStart = 16 + nrows*ncols*sizeof(double);
+  std::memcpy(dims, bytes.data() + vectorStart + 8, sizeof(dims));
+  binaryOk = binaryOk && dims[0] == nrows && dims[1] == 1 &&
+             std::memcmp(bytes.data() + vectorStart + 16, &constV[0],
+                         nrows*sizeof(double)) == 0;
+  if(!binaryOk)
+  {
+    std::cout << "ERROR: The binary output is incorrect\n";
+    testPassed = false;
+  }
+
+  if(testPassed) {
+    std::cout << "Writer test: PASSED!\n";
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "Writer test: FAILED!\n";
+  return EXIT_FAILURE;
+}